@@ -19,121 +19,670 @@ Si se recibe algo diferente entre 00 y 99 (sea número o letra) se debe
 ignorar.*/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <unistd.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "driver/uart.h"
 #include "esp_log.h"
+#include "esp_spiffs.h"
+#include "esp_timer.h"
 
 // Configuraciones y constantes
-#define UART_PORT UART_NUM_0  // Usamos el puerto UART0
 #define BUF_SIZE 128           // Tamaño del buffer de recepción
+#define READ_TIMEOUT_MS 100    // Espera máxima por el primer byte de cada bloque
+#define UART_RX_BUF_SIZE 1024  // Buffer del driver: absorbe ráfagas mientras se procesa un bloque
 #define MAX_NUM 99             // Máximo valor permitido
 #define MIN_NUM 0              // Mínimo valor permitido
 
-// Variables globales para llevar estadísticas
-static int min_num = MAX_NUM;
-static int max_num = MIN_NUM;
-static int last_num = 0;
-static int total = 0;
-static int count = 0;
+// Ingesta por bloques: conserva hasta BUF_SIZE - 1 caracteres por línea
+#define INGESTA_LINEA_MAX (BUF_SIZE - 1)
 
 // ----------------------------------------------------
-// Función que actualiza estadísticas con el nuevo número recibido
+// Registro histórico: cada lectura válida se guarda empaquetada (7 bits más
+// el tiempo) en páginas de RAM; la tarea de registro escribe las páginas
+// llenas en la partición SPIFFS "storage" (hace falta en la tabla de
+// particiones; con LittleFS solo cambia el montaje). Cada canal tiene un
+// archivo que rota a ".old" al llegar a REGISTRO_MAX_PAGINAS.
+// Comandos por el UART del canal:
+//   !registro                           estado del registro del canal
+//   !exportar <desde> <hasta> <paso>    resumen por intervalos (en segundos)
+//   !perf                               latencias, CPU y pila de las tareas
+//   !energia                            consumo estimado (con MODO_BAJO_CONSUMO)
+// Los responde la tarea de registro: el lector no espera a la salida.
 // ----------------------------------------------------
-void process_number(int num) {
-    last_num = num;
+#define CANAL_REGISTRO 1
+#define REGISTRO_PAGINA 512
+#define REGISTRO_MAX_PAGINAS 128        // 64 KB por archivo
+#define REGISTRO_BASE "/registro"
+#define EXPORTAR_PASO_MAX_S (UINT32_MAX / 1000)   // El paso del submuestreo va en ms de 32 bits
 
-    if (num < min_num) min_num = num;
-    if (num > max_num) max_num = num;
+// ----------------------------------------------------
+// Modo binario: con MODO_BINARIO 1 los caudalímetros envían tramas COBS con
+// CRC (trama.h) en vez de líneas de texto. Cada trama TRAMA_LECTURAS lleva
+// muchas lecturas de un byte; una trama dañada se descarta entera, se cuenta
+// y la recepción sigue en el próximo separador 0x00. Los comandos llegan en
+// tramas TRAMA_COMANDO y se responden en texto, igual que en modo texto.
+// ----------------------------------------------------
+#define MODO_BINARIO 0
+#define CANAL_BINARIO MODO_BINARIO
+#include "canal.h"
+#include "hal.h"
+#include "instrumentacion.h"
 
-    total += num;
-    count++;
+// Reporte: la tarea de reporte publica una instantánea cada REPORTE_PERIODO_MS
+// o, si REPORTE_CADA_N > 0, también cada N muestras aceptadas (en cualquier canal)
+#define REPORTE_PERIODO_MS 1000
+#define REPORTE_CADA_N 0
 
-    float average = (float)total / count;
+// ----------------------------------------------------
+// Canales: un caudalímetro por UART. Cada lector se fija a un núcleo para
+// repartir la carga entre los dos núcleos del ESP32.
+// UART0 comparte pines con la consola; UART1 y UART2 usan pines libres.
+// ----------------------------------------------------
+#define NUM_CANALES 3          // Canales activos (1 a 3)
 
-    // Imprimir todos los valores relevantes por UART
-    printf("Último: %d. Mínimo: %d. Máximo: %d. Promedio: %.2f.\n",
-           last_num, min_num, max_num, average);
-}
+#if NUM_CANALES < 1 || NUM_CANALES > 3
+#error "NUM_CANALES debe estar entre 1 y 3"
+#endif
 
 // ----------------------------------------------------
-// Función que valida si la cadena ingresada es un número válido
+// Bajo consumo: con MODO_BAJO_CONSUMO 1 el chip duerme (sueño ligero) entre
+// lecturas y lo despierta el RX del UART (energia.h; requiere CONFIG_PM_ENABLE
+// y CONFIG_FREERTOS_USE_TICKLESS_IDLE). Los lectores esperan sin límite en
+// reposo. Los bytes que despiertan al chip se pierden: cada caudalímetro debe
+// mandar antes de cada ráfaga ENERGIA_PREAMBULO_MIN(115200) = 13 "\n", que el
+// receptor ignora como líneas vacías. "!energia" informa el tiempo despierto,
+// la corriente estimada y la latencia del despertar al primer byte.
 // ----------------------------------------------------
-int validate_number(const char *str) {
-    size_t len = strlen(str);
+#define MODO_BAJO_CONSUMO 0
 
-    // Verificar longitud (debe tener 1 o 2 caracteres)
-    if (len == 0 || len > 2) {
-        printf("Error: Debe ser 1-2 dígitos (ingresó %zu caracteres)\n", len);
-        return -1;
-    }
+#if MODO_BAJO_CONSUMO
+#include "energia.h"
+#if NUM_CANALES > 2
+#error "En el ESP32 solo UART0 y UART1 despiertan al chip: use NUM_CANALES <= 2"
+#endif
+#endif
 
-    // Verificar que todos los caracteres sean dígitos
-    for (size_t i = 0; i < len; i++) {
-        if (!isdigit((unsigned char)str[i])) {
-            printf("Error: Solo se permiten números (carácter inválido: '%c')\n", str[i]);
-            return -1;
-        }
-    }
+// ----------------------------------------------------
+// Modo de dos etapas: los lectores (etapa 1: separar líneas y validar) corren
+// en un núcleo y encolan lecturas de 8 bits; una sola tarea en el otro núcleo
+// (etapa 2) las saca por lotes y actualiza las estadísticas.
+// Con PIPELINE_DOS_ETAPAS 0 cada lector procesa sus líneas completas y los
+// lectores se reparten entre núcleos según canal_config.
+// ----------------------------------------------------
+#define PIPELINE_DOS_ETAPAS 1
+#define NUCLEO_ETAPA1 0        // Núcleo de los lectores en modo de dos etapas
+#define NUCLEO_ETAPA2 1        // Núcleo de la tarea de estadísticas
+
+typedef struct {
+    uart_port_t port;
+    int tx_pin;
+    int rx_pin;
+    BaseType_t core;           // Núcleo donde corre el lector
+} canal_config_t;
+
+static const canal_config_t canal_config[] = {
+    {UART_NUM_0, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, 0},
+    {UART_NUM_1, 4, 5, 1},
+    {UART_NUM_2, 17, 16, 1},
+};
+
+// Estado por canal (estático para no cargar la pila de las tareas)
+static canal_t canales[NUM_CANALES];
+
+// Instantáneas que usa la tarea de reporte
+static telemetry_t snapshot[NUM_CANALES];
+static telemetry_t total;
+
+static TaskHandle_t reporter_handle = NULL;
+static TaskHandle_t stats_handle = NULL;
+static TaskHandle_t registro_handle = NULL;
+
+// Archivos del registro (solo los toca la tarea de registro)
+static FILE *registro_archivo[NUM_CANALES];
+static long registro_paginas[NUM_CANALES];
+static uint32_t registro_fallas = 0;     // Páginas que no se pudieron escribir
+
+// Comando recibido por el lector de un canal. 'pendiente' la pone el lector
+// después de copiar el comando y la borra la tarea de registro al responder.
+typedef struct {
+    uart_port_t port;
+    char texto[CANAL_COMANDO_MAX];
+    uint8_t pendiente;
+} pedido_t;
+static pedido_t pedidos[NUM_CANALES];
+
+// ----------------------------------------------------
+// Instrumentación (instrumentacion.h), un histograma por canal y por punto
+// para que cada uno tenga un solo escritor:
+// - linea:   bloque recibido -> líneas separadas y validadas (lector, ciclos)
+// - muestra: bloque recibido -> estadísticas actualizadas (quien procesa, us;
+//            en dos etapas cruza de núcleo)
+// ----------------------------------------------------
+static instr_hist_t hist_linea[NUM_CANALES];
+static instr_hist_t hist_muestra[NUM_CANALES];
+static int64_t marca_rx_us[NUM_CANALES];  // Llegada del último bloque (la escribe el lector)
+
+#if MODO_BAJO_CONSUMO
+static energia_t energia;
+static instr_hist_t hist_despertar[NUM_CANALES];  // Despertar -> primer byte (lector, us)
+#endif
 
-    // Convertir a entero y validar rango
-    int num = atoi(str);
-    if (num < MIN_NUM || num > MAX_NUM) {
-        printf("Error: El número debe estar entre %d y %d\n", MIN_NUM, MAX_NUM);
-        return -1;
+// ----------------------------------------------------
+// Avisa al reporte si en las últimas 'nuevas' muestras se cruzó un múltiplo
+// de REPORTE_CADA_N (no bloquea)
+// ----------------------------------------------------
+static void notify_reporter(uint64_t cuenta, int nuevas) {
+#if REPORTE_CADA_N > 0
+    if (nuevas > 0 && cuenta / REPORTE_CADA_N != (cuenta - nuevas) / REPORTE_CADA_N) {
+        xTaskNotifyGive(reporter_handle);
     }
+#else
+    (void)cuenta;
+    (void)nuevas;
+#endif
+}
 
-    return num;
+// ----------------------------------------------------
+// Avisa a la tarea de registro si un canal cerró una página (no bloquea)
+// ----------------------------------------------------
+static void notify_registro(canal_t *canal) {
+    if (registro_handle != NULL && registro_pendiente(&canal->registro)) {
+        xTaskNotifyGive(registro_handle);
+    }
 }
 
 // ----------------------------------------------------
-// Configura UART con parámetros estándar (115200 baudios, 8N1)
+// Configura un UART con parámetros estándar (115200 baudios, 8N1)
 // ----------------------------------------------------
-void init_uart() {
+void init_uart(const canal_config_t *cfg) {
     uart_config_t uart_config = {
         .baud_rate = 115200,
         .data_bits = UART_DATA_8_BITS,
         .parity = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
         .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+#if MODO_BAJO_CONSUMO
+        .source_clk = UART_SCLK_REF_TICK,   // El baudaje no cambia cuando baja la frecuencia del APB
+#endif
+    };
+
+    uart_param_config(cfg->port, &uart_config);               // Aplica configuración
+    uart_set_pin(cfg->port, cfg->tx_pin, cfg->rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    uart_driver_install(cfg->port, UART_RX_BUF_SIZE, 0, 0, NULL, 0); // Instala el driver de UART
+#if MODO_BAJO_CONSUMO
+    energia_despertar_con_uart(cfg->port);
+#endif
+}
+
+// ----------------------------------------------------
+// Registro histórico: archivos, tarea de escritura y comandos
+// ----------------------------------------------------
+static void registro_ruta(char *ruta, size_t n, int id, const char *extension) {
+    snprintf(ruta, n, REGISTRO_BASE "/canal%d%s", id, extension);
+}
+
+// ----------------------------------------------------
+// Abre el archivo del canal para agregar páginas y hace que el tiempo del
+// registro continúe desde la última lectura guardada antes de reiniciar.
+// Una página a medio escribir (corte de energía) se descarta.
+// ----------------------------------------------------
+static void registro_abrir(int id) {
+    static const char *const extensiones[] = {".log", ".old"};
+    char ruta[32];
+
+    for (int e = 0; e < 2; e++) {
+        registro_ruta(ruta, sizeof(ruta), id, extensiones[e]);
+        FILE *f = fopen(ruta, "rb");
+        if (f == NULL) continue;
+        uint64_t ultimo;
+        bool hay = registro_ultimo_tiempo(f, &ultimo);
+        fclose(f);
+        if (hay) {
+            registro_reanudar(&canales[id].registro, ultimo, hal_ms());
+            break;
+        }
+    }
+
+    registro_ruta(ruta, sizeof(ruta), id, ".log");
+    registro_archivo[id] = fopen(ruta, "ab");
+    if (registro_archivo[id] == NULL) return;
+
+    fseek(registro_archivo[id], 0, SEEK_END);
+    long largo = ftell(registro_archivo[id]);
+    registro_paginas[id] = largo / REGISTRO_PAGINA;
+    if (largo % REGISTRO_PAGINA != 0) {
+        fclose(registro_archivo[id]);
+        truncate(ruta, registro_paginas[id] * REGISTRO_PAGINA);
+        registro_archivo[id] = fopen(ruta, "ab");
+    }
+}
+
+// ----------------------------------------------------
+// El archivo lleno pasa a ".old" (se pierde el ".old" anterior)
+// ----------------------------------------------------
+static void registro_rotar(int id) {
+    char actual[32], viejo[32];
+    registro_ruta(actual, sizeof(actual), id, ".log");
+    registro_ruta(viejo, sizeof(viejo), id, ".old");
+
+    fclose(registro_archivo[id]);
+    remove(viejo);
+    rename(actual, viejo);
+    registro_archivo[id] = fopen(actual, "ab");
+    registro_paginas[id] = 0;
+}
+
+static void registro_montar(void) {
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = REGISTRO_BASE,
+        .partition_label = "storage",
+        .max_files = 2 * NUM_CANALES + 2,    // Un archivo abierto por canal más las exportaciones
+        .format_if_mount_failed = true,
     };
+    if (esp_vfs_spiffs_register(&conf) != ESP_OK) {
+        printf("Registro: no se pudo montar %s, las lecturas no se guardan\n", REGISTRO_BASE);
+        return;
+    }
+    for (int i = 0; i < NUM_CANALES; i++) {
+        registro_abrir(i);
+    }
+}
+
+// ----------------------------------------------------
+// Escribe en la flash las páginas que cerraron los canales, una escritura por
+// página. Con 'rotar' falso (durante una exportación) un archivo lleno no
+// rota: sus páginas esperan en RAM hasta la próxima llamada.
+// ----------------------------------------------------
+static void registro_vaciar(bool rotar) {
+    for (int i = 0; i < NUM_CANALES; i++) {
+        registro_t *r = &canales[i].registro;
+        const uint8_t *pagina;
+        while ((pagina = registro_pagina_lista(r)) != NULL) {
+            if (registro_archivo[i] != NULL && registro_paginas[i] >= REGISTRO_MAX_PAGINAS) {
+                if (!rotar) break;
+                registro_rotar(i);
+            }
+            if (registro_archivo[i] != NULL && registro_guardar(registro_archivo[i], pagina)) {
+                registro_paginas[i]++;
+            } else {
+                registro_fallas++;
+            }
+            registro_pagina_guardada(r);  // La página vuelve a estar libre para el canal
+        }
+    }
+}
 
-    uart_param_config(UART_PORT, &uart_config);               // Aplica configuración
-    uart_driver_install(UART_PORT, BUF_SIZE * 2, 0, 0, NULL, 0); // Instala el driver de UART
+static void enviar_intervalo(uart_port_t port, const registro_intervalo_t *iv) {
+    char linea[64];
+    uint32_t prom = iv->suma * 100 / iv->cuenta;
+    int n = snprintf(linea, sizeof(linea), "%llu,%lu,%lu.%02lu,%u,%u\n",
+                     (unsigned long long)(iv->inicio / 1000), (unsigned long)iv->cuenta,
+                     (unsigned long)(prom / 100), (unsigned long)(prom % 100), iv->min, iv->max);
+    hal_uart_escribir(port, linea, (size_t)n);
 }
 
 // ----------------------------------------------------
-// Tarea principal que lee continuamente desde UART
+// Exporta por el UART del canal las lecturas guardadas entre 'desde_s' y
+// 'hasta_s' (tiempo de registro, en segundos) resumidas por intervalos de
+// 'paso_s': una línea "inicio_s,cuenta,promedio,min,max" por intervalo.
+// Solo incluye páginas ya escritas en la flash. 'paso_s' no pasa de
+// EXPORTAR_PASO_MAX_S para que el paso en ms entre en 32 bits.
+// Corre en la tarea de registro: mientras el UART envía sigue guardando las
+// páginas que cierran los canales.
+// ----------------------------------------------------
+static void exportar(canal_t *canal, uart_port_t port, uint32_t desde_s, uint32_t hasta_s, uint32_t paso_s) {
+    static registro_lector_t lector;   // Una página de buffer: fuera de la pila
+    static const char *const extensiones[] = {".old", ".log"};  // Del más viejo al más nuevo
+    static const char encabezado[] = "inicio_s,cuenta,promedio,min,max\n";
+    uint64_t desde_ms = (uint64_t)desde_s * 1000, hasta_ms = (uint64_t)hasta_s * 1000;
+    registro_submuestreo_t sub;
+    registro_intervalo_t iv;
+    registro_muestra_t m;
+    char ruta[32];
+
+    registro_submuestreo_init(&sub, paso_s * 1000);
+    hal_uart_escribir(port, encabezado, sizeof(encabezado) - 1);
+
+    for (int e = 0; e < 2; e++) {
+        registro_ruta(ruta, sizeof(ruta), canal->id, extensiones[e]);
+        FILE *f = fopen(ruta, "rb");
+        if (f == NULL) continue;
+
+        registro_lector_abrir(&lector, f, desde_ms);
+        while (registro_lector_siguiente(&lector, &m) && m.t <= hasta_ms) {
+            if (registro_submuestreo_agregar(&sub, &m, &iv)) {
+                enviar_intervalo(port, &iv);
+                registro_vaciar(false);
+            }
+        }
+        fclose(f);
+    }
+
+    if (registro_submuestreo_terminar(&sub, &iv)) enviar_intervalo(port, &iv);
+}
+
+// ----------------------------------------------------
+// Responde "!perf": latencias de todos los canales juntos, CPU y pila libre
+// de cada tarea
+// ----------------------------------------------------
+static void enviar_perf(uart_port_t port) {
+    static char texto[1024];    // Fuera de la pila (solo lo usa la tarea de registro)
+    instr_hist_t linea = INSTR_HIST("linea"), muestra = INSTR_HIST("muestra");
+    for (int i = 0; i < NUM_CANALES; i++) {
+        instr_fusionar(&linea, &hist_linea[i]);
+        instr_fusionar(&muestra, &hist_muestra[i]);
+    }
+
+    size_t n = instr_hist_texto(&linea, texto, sizeof(texto));
+    n += instr_hist_texto(&muestra, texto + n, sizeof(texto) - n);
+    n += instr_tareas_texto(texto + n, sizeof(texto) - n);
+    hal_uart_escribir(port, texto, n);
+}
+
+#if MODO_BAJO_CONSUMO
+// ----------------------------------------------------
+// Responde "!energia": tiempo despierto y corriente desde la consulta anterior,
+// y latencia del despertar al primer byte de todos los canales juntos
+// ----------------------------------------------------
+static void enviar_energia(uart_port_t port) {
+    char texto[256];
+    instr_hist_t despertar = INSTR_HIST("despertar");
+    for (int i = 0; i < NUM_CANALES; i++) instr_fusionar(&despertar, &hist_despertar[i]);
+
+    size_t n = energia_texto(&energia, esp_timer_get_time(), texto, sizeof(texto));
+    n += instr_hist_texto(&despertar, texto + n, sizeof(texto) - n);
+    hal_uart_escribir(port, texto, n);
+}
+#endif
+
+// ----------------------------------------------------
+// Atiende un comando recibido por el UART de un canal (en la tarea de registro)
+// ----------------------------------------------------
+static void atender_comando(canal_t *canal, uart_port_t port, const char *comando) {
+    unsigned long desde, hasta, paso;
+    char linea[128];
+    int n;
+
+    if (sscanf(comando, "!exportar %lu %lu %lu", &desde, &hasta, &paso) == 3) {
+        if (paso == 0 || paso > EXPORTAR_PASO_MAX_S || desde > hasta) {
+            n = snprintf(linea, sizeof(linea), "exportar: rango inválido (paso 1-%lu s, desde <= hasta)\n",
+                         (unsigned long)EXPORTAR_PASO_MAX_S);
+            hal_uart_escribir(port, linea, (size_t)n);
+            return;
+        }
+        exportar(canal, port, (uint32_t)desde, (uint32_t)hasta, (uint32_t)paso);
+        return;
+    }
+
+    if (strcmp(comando, "!perf") == 0) {
+        enviar_perf(port);
+        return;
+    }
+
+#if MODO_BAJO_CONSUMO
+    if (strcmp(comando, "!energia") == 0) {
+        enviar_energia(port);
+        return;
+    }
+#endif
+
+    if (strcmp(comando, "!registro") == 0) {
+        const registro_t *r = &canal->registro;
+        n = snprintf(linea, sizeof(linea),
+                     "registro canal %d: t=%llu s muestras=%lu perdidas=%lu paginas=%ld fallas=%lu\n",
+                     canal->id, (unsigned long long)(registro_tiempo(r, hal_ms()) / 1000),
+                     (unsigned long)__atomic_load_n(&r->muestras, __ATOMIC_RELAXED),
+                     (unsigned long)__atomic_load_n(&r->perdidas, __ATOMIC_RELAXED),
+                     registro_paginas[canal->id], (unsigned long)registro_fallas);
+    } else {
+        n = snprintf(linea, sizeof(linea), "comando desconocido: %s\n", comando);
+    }
+    hal_uart_escribir(port, linea, (size_t)n);
+}
+
+// ----------------------------------------------------
+// Tarea de registro: guarda las páginas de los canales y responde los
+// comandos. Es la única que toca los archivos y la única que responde, así
+// que la recepción nunca espera a la flash ni a la salida de una respuesta.
+// ----------------------------------------------------
+void registro_task(void *arg) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        registro_vaciar(true);
+
+        for (int i = 0; i < NUM_CANALES; i++) {
+            pedido_t *p = &pedidos[i];
+            if (!__atomic_load_n(&p->pendiente, __ATOMIC_ACQUIRE)) continue;
+            atender_comando(&canales[i], p->port, p->texto);
+            __atomic_store_n(&p->pendiente, 0, __ATOMIC_RELEASE);
+            registro_vaciar(true);   // Las páginas que esperaban una rotación
+        }
+    }
+}
+
+// ----------------------------------------------------
+// Pasa el comando del canal a la tarea de registro (no bloquea al lector).
+// Si el anterior del mismo canal sigue sin responder, el nuevo se descarta.
+// ----------------------------------------------------
+static void pedir_comando(canal_t *canal, uart_port_t port) {
+    pedido_t *p = &pedidos[canal->id];
+    if (__atomic_load_n(&p->pendiente, __ATOMIC_ACQUIRE)) return;
+    p->port = port;
+    memcpy(p->texto, canal->comando, sizeof(p->texto));
+    __atomic_store_n(&p->pendiente, 1, __ATOMIC_RELEASE);
+    xTaskNotifyGive(registro_handle);
+}
+
+// ----------------------------------------------------
+// Lee un bloque desde UART directamente al anillo de ingesta del canal.
+// Espera el primer byte (hasta 'espera_ms') y luego drena en una sola
+// llamada todo lo que el driver ya tenga almacenado.
+// ----------------------------------------------------
+#if !MODO_BINARIO
+static int read_block(uart_port_t port, ingesta_t *ingesta, uint32_t espera_ms) {
+    uint8_t *destino;
+    size_t espacio = ingesta_espacio(ingesta, &destino);
+
+    size_t len = hal_uart_leer_bloque(port, destino, espacio, espera_ms);
+    if (len == 0) return 0;
+
+    ingesta_confirmar(ingesta, len);
+    return (int)len;
+}
+#endif
+
+// ----------------------------------------------------
+// Tarea lectora de un canal: recibe, valida y actualiza solo su propio estado
 // ----------------------------------------------------
 void uart_read_task(void *arg) {
-    char line[BUF_SIZE];  // Buffer donde se almacenan los caracteres recibidos
-    int index = 0;        // Índice actual dentro del buffer
+    int id = (int)(intptr_t)arg;
+    canal_t *canal = &canales[id];
+    uart_port_t port = canal_config[id].port;
+#if MODO_BINARIO
+    uint8_t bloque[BUF_SIZE];
+#endif
+#if MODO_BAJO_CONSUMO
+    energia_rx_t rx = {0};
+#endif
 
     while (1) {
-        uint8_t byte;  // Variable para leer byte por byte
-        // Leer un byte desde UART (espera hasta 100 ms)
-        int len = uart_read_bytes(UART_PORT, &byte, 1, pdMS_TO_TICKS(100));
-
-        if (len > 0) {
-            // Si el carácter es Enter (\n o \r), procesamos el número recibido
-            if (byte == '\n' || byte == '\r') {
-                if (index > 0) {
-                    line[index] = '\0';  // Finaliza la cadena con null terminator
-                    printf("Procesando: '%s'\n", line);  // Debug
-
-                    int num = validate_number(line);     // Validar el número
-                    if (num != -1) {
-                        process_number(num);            // Si es válido, procesarlo
-                    }
-                    index = 0;  // Reiniciar buffer para la próxima entrada
-                }
-            } else if (index < BUF_SIZE - 1) {
-                // Si no es Enter, almacenar el byte en el buffer
-                line[index++] = byte;
+#if MODO_BAJO_CONSUMO
+        uint32_t espera_ms = energia_rx_espera(&rx);
+#else
+        uint32_t espera_ms = READ_TIMEOUT_MS;
+#endif
+#if MODO_BINARIO
+        // Las tramas se arman en el receptor del canal; el bloque es solo transporte
+        size_t len = hal_uart_leer_bloque(port, bloque, sizeof(bloque), espera_ms);
+#if MODO_BAJO_CONSUMO
+        energia_rx_leido(&energia, &rx, len, &hist_despertar[id], esp_timer_get_time());
+#endif
+        if (len == 0) continue;
+        uint32_t marca = instr_marca();
+        __atomic_store_n(&marca_rx_us[id], esp_timer_get_time(), __ATOMIC_RELAXED);
+
+#if PIPELINE_DOS_ETAPAS
+        int encoladas = canal_encolar_tramas(canal, bloque, len);
+        instr_desde(&hist_linea[id], marca);
+        if (encoladas > 0) {
+            xTaskNotifyGive(stats_handle);
+        }
+#else
+        int aceptadas = canal_procesar_tramas(canal, bloque, len, hal_ms());
+        instr_desde(&hist_linea[id], marca);
+        if (aceptadas > 0) instr_registrar_us(&hist_muestra[id], esp_timer_get_time() - marca_rx_us[id]);
+        notify_reporter(canal->telemetry.stats.cuenta, aceptadas);
+        notify_registro(canal);
+#endif
+#else
+        int len = read_block(port, &canal->ingesta, espera_ms);
+#if MODO_BAJO_CONSUMO
+        energia_rx_leido(&energia, &rx, (size_t)len, &hist_despertar[id], esp_timer_get_time());
+#endif
+        if (len == 0) continue;
+        uint32_t marca = instr_marca();
+        __atomic_store_n(&marca_rx_us[id], esp_timer_get_time(), __ATOMIC_RELAXED);
+
+#if PIPELINE_DOS_ETAPAS
+        // Etapa 1: separar y validar; las lecturas válidas van a la cola
+        int encoladas = canal_encolar_lineas(canal);
+        instr_desde(&hist_linea[id], marca);
+        if (encoladas > 0) {
+            xTaskNotifyGive(stats_handle);  // Despertar a la etapa 2 (no bloquea)
+        }
+#else
+        // Procesar todas las líneas completas (\n o \r) que llegaron en el bloque
+        uint32_t ahora_ms = hal_ms();
+        int aceptadas = canal_procesar_lineas(canal, ahora_ms);
+        instr_desde(&hist_linea[id], marca);
+        if (aceptadas > 0) instr_registrar_us(&hist_muestra[id], esp_timer_get_time() - marca_rx_us[id]);
+        notify_reporter(canal->telemetry.stats.cuenta, aceptadas);
+        notify_registro(canal);
+#endif
+#endif
+
+        if (canal->comando_listo) {
+            canal->comando_listo = false;
+            pedir_comando(canal, port);
+        }
+    }
+}
+
+// ----------------------------------------------------
+// Etapa 2 del modo de dos etapas: saca las lecturas de todos los canales por
+// lotes y actualiza sus estadísticas. Es la única que escribe 'stats'.
+// ----------------------------------------------------
+void stats_task(void *arg) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        uint32_t ahora_ms = hal_ms();
+        for (int i = 0; i < NUM_CANALES; i++) {
+            int procesadas = canal_drenar(&canales[i], ahora_ms);
+            if (procesadas > 0) {
+                int64_t rx_us = __atomic_load_n(&marca_rx_us[i], __ATOMIC_RELAXED);
+                instr_registrar_us(&hist_muestra[i], esp_timer_get_time() - rx_us);
             }
+            notify_reporter(canales[i].telemetry.stats.cuenta, procesadas);
+            notify_registro(&canales[i]);
+        }
+    }
+}
+
+// ----------------------------------------------------
+// Imprime una ventana de tiempo (conteo, promedio, mínimo, máximo y varianza)
+// ----------------------------------------------------
+static void print_window(estadisticas_t *st, const char *nombre, int ventana, uint32_t ahora_ms) {
+    estad_cubeta_t w = estadisticas_ventana(st, ventana, ahora_ms);
+    if (w.cuenta == 0) {
+        printf("  %-6s sin datos\n", nombre);
+        return;
+    }
+
+    uint32_t prom = estad_cubeta_promedio_x100(&w);
+    printf("  %-6s n=%llu promedio=%lu.%02lu min=%u max=%u var=%.2f\n", nombre,
+           (unsigned long long)w.cuenta, (unsigned long)(prom / 100), (unsigned long)(prom % 100),
+           w.min, w.max, estad_cubeta_varianza(&w));
+}
+
+// ----------------------------------------------------
+// Imprime último, mínimo, máximo, promedio y percentiles de unas estadísticas
+// ----------------------------------------------------
+static void print_summary(const char *nombre, const estadisticas_t *st) {
+    if (st->cuenta == 0) {
+        printf("%s: sin lecturas\n", nombre);
+        return;
+    }
+
+    // Promedio en centésimas (entero, sin división flotante)
+    uint32_t promedio = estadisticas_promedio_x100(st);
+
+    static const uint8_t pct[] = {50, 95, 99};
+    uint8_t valores[3];
+    estadisticas_percentiles(st, pct, valores, 3);
+
+    printf("%s: Último: %u. Mínimo: %u. Máximo: %u. Promedio: %lu.%02lu. "
+           "Mediana: %u. P95: %u. P99: %u.\n", nombre,
+           st->ultimo, st->min, st->max,
+           (unsigned long)(promedio / 100), (unsigned long)(promedio % 100),
+           valores[0], valores[1], valores[2]);
+}
+
+// ----------------------------------------------------
+// Tarea de reporte y agregador: copia la instantánea de cada canal (sin
+// bloquear a los lectores), las suma e imprime. Es la única que escribe en
+// consola, así que un TX lento no frena la recepción.
+// ----------------------------------------------------
+void reporter_task(void *arg) {
+    uint64_t reported_count = 0;
+    uint32_t reported_errors = 0;
+
+    while (1) {
+        // Despierta por período o por aviso de una tarea lectora
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(REPORTE_PERIODO_MS));
+
+        memset(&total, 0, sizeof(total));
+        estadisticas_init(&total.stats);
+        for (int i = 0; i < NUM_CANALES; i++) {
+            canal_instantanea(&canales[i], &snapshot[i]);
+            telemetry_fusionar(&total, &snapshot[i]);
+        }
+
+        const estadisticas_t *st = &total.stats;
+        uint32_t errors = total.err_longitud + total.err_no_digito + total.err_rango +
+                          total.descartadas + total.err_trama;
+        if (st->cuenta == reported_count && errors == reported_errors) {
+            continue;  // Nada nuevo que reportar
+        }
+        reported_count = st->cuenta;
+        reported_errors = errors;
+
+        uint32_t ahora_ms = hal_ms();
+
+        for (int i = 0; i < NUM_CANALES; i++) {
+            char nombre[16];
+            snprintf(nombre, sizeof(nombre), "Canal %d", i);
+            print_summary(nombre, &snapshot[i].stats);
         }
+
+        if (st->cuenta > 0) {
+            print_summary("Total", st);
+            printf("Resumen (%llu muestras, varianza total %.2f):\n",
+                   (unsigned long long)st->cuenta, estadisticas_varianza(st));
+            print_window(&total.stats, "1 min", ESTAD_VENTANA_1MIN, ahora_ms);
+            print_window(&total.stats, "10 min", ESTAD_VENTANA_10MIN, ahora_ms);
+            print_window(&total.stats, "1 h", ESTAD_VENTANA_1H, ahora_ms);
+        }
+
+        printf("Errores: longitud=%lu no_digito=%lu rango=%lu descartadas=%lu tramas=%lu\n",
+               (unsigned long)total.err_longitud, (unsigned long)total.err_no_digito,
+               (unsigned long)total.err_rango, (unsigned long)total.descartadas,
+               (unsigned long)total.err_trama);
     }
 }
 
@@ -141,7 +690,15 @@ void uart_read_task(void *arg) {
 // Función principal del programa (punto de entrada)
 // ----------------------------------------------------
 void app_main() {
-    init_uart();  // Configurar UART al iniciar
+#if MODO_BAJO_CONSUMO
+    // Antes de los UART: los lectores toman el bloqueo de sueño desde el primer byte
+    esp_err_t err = energia_iniciar(&energia);
+    if (err != ESP_OK) printf("Bajo consumo no disponible (%d): revise CONFIG_PM_ENABLE\n", err);
+#endif
+    for (int i = 0; i < NUM_CANALES; i++) {
+        init_uart(&canal_config[i]);  // Configurar cada UART al iniciar
+        canal_init(&canales[i], i);
+    }
 
     // Mostrar instrucciones al usuario por consola
     printf("\n=== Sistema de Telemetría ===\n");
@@ -149,8 +706,36 @@ void app_main() {
     printf("1. Ingrese números entre %d y %d\n", MIN_NUM, MAX_NUM);
     printf("2. Presione Enter después de cada número\n");
     printf("3. Ejemplos válidos: 5, 05, 99\n");
-    printf("4. Ejemplos inválidos: 100, abc, -1\n\n");
+    printf("4. Ejemplos inválidos: 100, abc, -1\n");
+    printf("5. El resumen se imprime cada %d ms\n", REPORTE_PERIODO_MS);
+    printf("6. Canales activos: %d (UART0..UART%d)\n", NUM_CANALES, NUM_CANALES - 1);
+    printf("7. Historial: !registro o !exportar <desde_s> <hasta_s> <paso_s>; rendimiento: !perf\n");
+    printf("8. Formato: %s\n", MODO_BINARIO ? "tramas COBS + CRC-16 (binario)" : "líneas de texto");
+    printf("9. Bajo consumo: %s\n\n", MODO_BAJO_CONSUMO
+           ? "sueño ligero; anteponga 13 \\n a cada ráfaga; consumo: !energia" : "desactivado");
+
+    // Registro histórico en la flash (antes de que lleguen lecturas)
+    registro_montar();
+    xTaskCreate(registro_task, "registro", 4096, NULL, 4, &registro_handle);
+    instr_registrar_tarea(registro_handle);
+
+    // Tarea de reporte (menor prioridad que la lectura, en cualquier núcleo)
+    xTaskCreate(reporter_task, "reporter", 4096, NULL, 5, &reporter_handle);
+    instr_registrar_tarea(reporter_handle);
 
-    // Crear la tarea de lectura por UART (bucle principal)
-    xTaskCreate(uart_read_task, "uart_reader", 4096, NULL, 10, NULL);
+#if PIPELINE_DOS_ETAPAS
+    // Etapa 2: estadísticas en el otro núcleo
+    xTaskCreatePinnedToCore(stats_task, "stats", 4096, NULL, 9, &stats_handle, NUCLEO_ETAPA2);
+    instr_registrar_tarea(stats_handle);
+#endif
+
+    // Crear una tarea lectora por UART, fija a su núcleo
+    for (int i = 0; i < NUM_CANALES; i++) {
+        char nombre[16];
+        snprintf(nombre, sizeof(nombre), "uart_reader%d", i);
+        BaseType_t core = PIPELINE_DOS_ETAPAS ? NUCLEO_ETAPA1 : canal_config[i].core;
+        TaskHandle_t lector = NULL;
+        xTaskCreatePinnedToCore(uart_read_task, nombre, 4096, (void *)(intptr_t)i, 10, &lector, core);
+        instr_registrar_tarea(lector);
+    }
 }
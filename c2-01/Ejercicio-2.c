@@ -12,13 +12,125 @@ Objetivo:
   
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "driver/uart.h"
+#include "esp_timer.h"
+#include "cuadrados.h"
+#include "hal.h"
+#include "instrumentacion.h"
 
 #define UART_PORT UART_NUM_0
 #define BUF_SIZE (1024)
 
+// Modo de atención:
+// 1 = por eventos: la tarea duerme en la cola de eventos del driver y despierta
+//     cuando se detecta el separador (detección de patrón) o vence el tiempo de RX.
+// 0 = sondeo: uart_read_bytes con espera de 20 ms en un ciclo continuo.
+#define MODO_EVENTOS 1
+#define EVENT_QUEUE_LEN 20      // Eventos pendientes en la cola del driver
+#define PATTERN_QUEUE_LEN 20    // Posiciones del separador que recuerda el driver
+#define METRICAS_MAX 512        // Espacio para la respuesta de un comando
+
+// Formato de los pedidos:
+// 0 = texto: enteros separados por '\n', espacios, ',' o ';' y respuestas "n²\n".
+// 1 = binario: tramas COBS con CRC-16 (trama.h). Una trama TRAMA_PEDIDOS lleva
+//     muchos enteros de 32 bits y se responde con tramas TRAMA_CUADRADOS de
+//     64 bits; los comandos van en TRAMA_COMANDO y su respuesta en TRAMA_TEXTO.
+//     Una trama dañada se descarta, se cuenta y no se responde.
+#define MODO_BINARIO 0
+#if MODO_BINARIO
+#define SEPARADOR TRAMA_SEPARADOR   // Fin de trama: lo que detecta el driver
+#else
+#define SEPARADOR '\n'
+#endif
+
+// Transmisión sin bloqueo y alta velocidad:
+// - TX_BUF_SIZE: buffer de transmisión del driver; uart_write_bytes copia ahí y
+//   vuelve de inmediato mientras haya espacio (con 0 esperaba al último bit).
+// - CONTROL_FLUJO 1: RTS/CTS por hardware en los pines 22 (RTS) y 19 (CTS).
+//   Si el cliente no lee, CTS detiene el TX; si el ESP32 se atrasa, RTS
+//   detiene al cliente en vez de perder bytes. Requiere cablear RTS y CTS
+//   (una placa de desarrollo común no los tiene): con CTS al aire el TX
+//   puede quedar detenido. Por defecto está apagado.
+// - El baudaje se cambia en ejecución con el comando "!baud=<valor>".
+#define BAUD_INICIAL 9600
+#define TX_BUF_SIZE (BUF_SIZE * 4)
+#define CONTROL_FLUJO 0
+#define RX_FLOW_THRESH 100      // Bytes en la FIFO RX (de 128) que activan RTS
+
+// Bajo consumo: con MODO_BAJO_CONSUMO 1 el chip duerme (sueño ligero) entre
+// pedidos y lo despierta el RX del UART (energia.h; requiere CONFIG_PM_ENABLE
+// y CONFIG_FREERTOS_USE_TICKLESS_IDLE). Los bytes que lo despiertan se
+// pierden: el cliente antepone a cada ráfaga ENERGIA_PREAMBULO_MIN(baudaje)
+// separadores ('\n' en texto, 0x00 en binario), que no generan respuesta. El
+// reloj del UART pasa a REF_TICK (1 MHz) para que el baudaje no cambie al bajar
+// la frecuencia, lo que limita la velocidad a BAUD_MAX_BAJO_CONSUMO.
+// "!energia" informa el tiempo despierto, la corriente estimada y la latencia
+// del despertar al primer byte.
+#define MODO_BAJO_CONSUMO 0
+#define BAUD_MAX_BAJO_CONSUMO 115200
+
+#if MODO_BAJO_CONSUMO
+#include "energia.h"
+#endif
+
+static const uint32_t baudajes_validos[] = {
+  9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1500000, 2000000,
+};
+
+// Estado del analizador (un pedido puede quedar partido entre dos lecturas)
+static cuadrados_t servicio;
+#if MODO_BINARIO
+static trama_rx_t receptor;
+static char texto[METRICAS_MAX];    // Respuesta de un comando antes de ir en una trama
+#endif
+
+// Buffers del bloque recibido y de las respuestas (estáticos para no cargar la pila)
+static uint8_t entrada[BUF_SIZE];
+static char salida[CUADRADOS_SALIDA_MAX(BUF_SIZE) + CUADRADOS_TRAMA_SALIDA_MAX +
+                  TRAMA_VARIAS_MAX(METRICAS_MAX)];
+
+#if MODO_EVENTOS
+// Cola de eventos del driver (modo por eventos)
+static QueueHandle_t uart_queue;
+#endif
+
+// Métricas que se consultan con el comando "?"
+typedef struct {
+  uint32_t envios;         // Escrituras de respuestas
+  int64_t  lat_min_us;     // Latencia mínima pedido -> respuesta
+  int64_t  lat_max_us;     // Latencia máxima
+  int64_t  lat_total_us;   // Suma de latencias (para el promedio)
+  int64_t  espera_us;      // Tiempo de esta tarea bloqueada esperando datos desde 'desde_us'
+  int64_t  desde_us;       // Inicio de la ventana de medición
+  uint32_t desbordes;      // Desbordes de FIFO o buffer del driver
+  uint64_t tx_bytes;       // Bytes de respuesta entregados al driver
+  uint32_t tx_llenos;      // Escrituras que encontraron el buffer TX sin espacio
+  int64_t  tx_bloqueo_max_us; // Mayor tiempo dentro de uart_write_bytes
+} metricas_t;
+
+static metricas_t metricas;
+
+// Instrumentación (instrumentacion.h), la escribe solo la tarea de servicio:
+// - bloque:    cálculo de las respuestas de un bloque recibido (ciclos)
+// - respuesta: datos recibidos -> respuestas entregadas al driver (us)
+// Se consulta con "!perf" junto con CPU y pila de la tarea.
+static instr_hist_t hist_bloque = INSTR_HIST("bloque");
+static instr_hist_t hist_respuesta = INSTR_HIST("respuesta");
+
+#if MODO_BAJO_CONSUMO
+static energia_t energia;
+static energia_rx_t recepcion;     // Mantiene el chip despierto durante una ráfaga
+static instr_hist_t hist_despertar = INSTR_HIST("despertar");   // Despertar -> primer byte (us)
+#endif
+
+// Baudaje actual y cambio pendiente (se aplica después de enviar la confirmación)
+static uint32_t baud_actual = BAUD_INICIAL;
+static uint32_t baud_pendiente = 0;
+
 // Configuración del UART
 static void uart_init(int BAUD_RATE){
   // Definir la estructura de configuración del UART
@@ -27,8 +139,17 @@ static void uart_init(int BAUD_RATE){
     .data_bits  = UART_DATA_8_BITS,         // Número de bits de datos por paquete de transmisión
     .parity     = UART_PARITY_DISABLE,      // Configuración de paridad (desactivado)
     .stop_bits  = UART_STOP_BITS_1,         // Número de bits de parada por paquete de transmisión
+#if CONTROL_FLUJO
+    .flow_ctrl  = UART_HW_FLOWCTRL_CTS_RTS, // Control de flujo del hardware (RTS y CTS)
+    .rx_flow_ctrl_thresh = RX_FLOW_THRESH,  // Umbral de la FIFO RX para activar RTS
+#else
     .flow_ctrl  = UART_HW_FLOWCTRL_DISABLE, // Control de flujo del hardware (desactivado)
+#endif
+#if MODO_BAJO_CONSUMO
+    .source_clk = UART_SCLK_REF_TICK,       // Reloj fijo de 1 MHz: no cambia con la frecuencia del APB
+#else
     .source_clk = UART_SCLK_DEFAULT,        // Configuración de la fuente de reloj (predeterminado)
+#endif
   };
   // Configuración de los parámetros del UART
   ESP_ERROR_CHECK(uart_param_config(UART_PORT, &uart_config));
@@ -41,56 +162,361 @@ static void uart_init(int BAUD_RATE){
   ESP_ERROR_CHECK(uart_set_pin(UART_PORT, 1, 3, 22, 19));
 
   // Instalación del controlador del UART
-  ESP_ERROR_CHECK(uart_driver_install(UART_PORT, BUF_SIZE * 2, 0, 0, NULL, ESP_INTR_FLAG_IRAM));
+#if MODO_EVENTOS
+  // Con cola de eventos y detección del separador ('\n' o el 0x00 de fin de
+  // trama): la tarea solo despierta cuando hay una línea o trama completa (o
+  // cuando los datos dejan de llegar sin separador)
+  ESP_ERROR_CHECK(uart_driver_install(UART_PORT, BUF_SIZE * 2, TX_BUF_SIZE, EVENT_QUEUE_LEN, &uart_queue, ESP_INTR_FLAG_IRAM));
+  ESP_ERROR_CHECK(uart_enable_pattern_det_baud_intr(UART_PORT, SEPARADOR, 1, 9, 0, 0));
+  ESP_ERROR_CHECK(uart_pattern_queue_reset(UART_PORT, PATTERN_QUEUE_LEN));
+#else
+  ESP_ERROR_CHECK(uart_driver_install(UART_PORT, BUF_SIZE * 2, TX_BUF_SIZE, 0, NULL, ESP_INTR_FLAG_IRAM));
+#endif
+#if MODO_BAJO_CONSUMO
+  ESP_ERROR_CHECK(energia_despertar_con_uart(UART_PORT));
+#endif
+}
+
+// Bytes que snprintf dejó en un destino de 'capacidad' (si el texto no cupo,
+// devuelve el largo completo, no lo escrito)
+static size_t largo_escrito(int n, size_t capacidad)
+{
+  if (n < 0 || capacidad == 0) return 0;
+  return (size_t)n < capacidad ? (size_t)n : capacidad - 1;
+}
+
+// Valida y programa un cambio de baudaje pedido con "!baud=<valor>"
+static size_t comando_baud(const char *valor, char *destino, size_t capacidad)
+{
+  uint32_t baud = (uint32_t)strtoul(valor, NULL, 10);
+
+  for (size_t i = 0; i < sizeof(baudajes_validos) / sizeof(baudajes_validos[0]); i++) {
+    if (MODO_BAJO_CONSUMO && baud > BAUD_MAX_BAJO_CONSUMO) break;
+    if (baudajes_validos[i] == baud) {
+      baud_pendiente = baud;  // Se aplica cuando la confirmación termine de salir
+      return largo_escrito(snprintf(destino, capacidad, "ok baud=%lu\n", (unsigned long)baud), capacidad);
+    }
+  }
+  return largo_escrito(snprintf(destino, capacidad, "baud no soportado: %s\n", valor), capacidad);
+}
+
+// Atiende el comando que haya dejado el analizador y escribe su respuesta.
+// "?" devuelve latencia pedido -> respuesta, porcentaje del tiempo que esta
+// tarea pasó bloqueada esperando datos, CPU libre del chip (tareas IDLE; "n/d"
+// sin las estadísticas de FreeRTOS), estado del TX y contadores; "!baud=<valor>" cambia la velocidad.
+// Devuelve los bytes escritos.
+static size_t atender_comando(char *destino, size_t capacidad)
+{
+  if (!servicio.comando_listo) return 0;
+  servicio.comando_listo = false;
+
+  if (strncmp(servicio.comando, "!baud=", 6) == 0) {
+    return comando_baud(servicio.comando + 6, destino, capacidad);
+  }
+  if (strcmp(servicio.comando, "!perf") == 0) {
+    size_t n = instr_hist_texto(&hist_bloque, destino, capacidad);
+    n += instr_hist_texto(&hist_respuesta, destino + n, capacidad - n);
+    return n + instr_tareas_texto(destino + n, capacidad - n);
+  }
+#if MODO_BAJO_CONSUMO
+  if (strcmp(servicio.comando, "!energia") == 0) {
+    size_t n = energia_texto(&energia, esp_timer_get_time(), destino, capacidad);
+    return n + instr_hist_texto(&hist_despertar, destino + n, capacidad - n);
+  }
+#endif
+  if (strcmp(servicio.comando, "?") != 0) {
+    return largo_escrito(snprintf(destino, capacidad, "comando desconocido: %s\n", servicio.comando), capacidad);
+  }
+
+  int64_t ahora = esp_timer_get_time();
+  int64_t ventana = ahora - metricas.desde_us;
+  int64_t promedio = metricas.envios ? metricas.lat_total_us / metricas.envios : 0;
+  int bloqueada_x10 = ventana > 0 ? (int)(metricas.espera_us * 1000 / ventana) : 0;
+  int libre_x10 = instr_cpu_libre_x10();
+  char libre[12] = "n/d";
+  if (libre_x10 >= 0) snprintf(libre, sizeof(libre), "%d.%d%%", libre_x10 / 10, libre_x10 % 10);
+
+  size_t tx_libre = 0;
+  uart_get_tx_buffer_free_size(UART_PORT, &tx_libre);
+
+  int largo = snprintf(destino, capacidad,
+      "lat_us min=%lld prom=%lld max=%lld envios=%lu bloqueada=%d.%d%% cpu_libre=%s "
+      "respondidos=%lu ignorados=%lu desbordes=%lu\n"
+      "baud=%lu tx_bytes=%llu tx_libre=%u tx_llenos=%lu tx_bloqueo_max_us=%lld\n",
+      (long long)(metricas.envios ? metricas.lat_min_us : 0), (long long)promedio,
+      (long long)metricas.lat_max_us, (unsigned long)metricas.envios,
+      bloqueada_x10 / 10, bloqueada_x10 % 10, libre,
+      (unsigned long)servicio.respondidos, (unsigned long)servicio.ignorados,
+      (unsigned long)metricas.desbordes,
+      (unsigned long)baud_actual, (unsigned long long)metricas.tx_bytes, (unsigned)tx_libre,
+      (unsigned long)metricas.tx_llenos, (long long)metricas.tx_bloqueo_max_us);
+#if MODO_BINARIO
+  if (largo > 0 && (size_t)largo < capacidad) {
+    largo += (int)largo_escrito(snprintf(destino + largo, capacidad - largo,
+        "tramas=%lu err_cobs=%lu err_crc=%lu err_largo=%lu err_tipo=%lu\n",
+        (unsigned long)receptor.tramas, (unsigned long)receptor.err_cobs,
+        (unsigned long)receptor.err_crc, (unsigned long)receptor.err_largo,
+        (unsigned long)receptor.err_tipo), capacidad - largo);
+  }
+#endif
+
+  // Los porcentajes se miden de consulta a consulta
+  metricas.desde_us = ahora;
+  metricas.espera_us = 0;
+  return largo_escrito(largo, capacidad);
 }
 
+// Procesa un bloque recibido y deja las respuestas en 'salida' (texto o
+// tramas según MODO_BINARIO). Devuelve los bytes escritos.
+static size_t procesar_bloque(const uint8_t *datos, size_t n)
+{
+  uint32_t marca = instr_marca();
+#if MODO_BINARIO
+  size_t largo = cuadrados_procesar_tramas(&servicio, &receptor, datos, n, (uint8_t *)salida, sizeof(salida));
+#else
+  size_t largo = cuadrados_procesar(&servicio, datos, n, salida, sizeof(salida));
+#endif
+  instr_desde(&hist_bloque, marca);
+  return largo;
+}
+
+// Cierra un pedido que quedó sin separador. En modo binario una trama sin su
+// 0x00 sigue abierta: puede continuar en el próximo bloque.
+static size_t terminar_pedido(char *destino, size_t capacidad)
+{
+#if MODO_BINARIO
+  (void)destino;
+  (void)capacidad;
+  return 0;
+#else
+  return cuadrados_terminar(&servicio, destino, capacidad);
+#endif
+}
+
+// Descarta el pedido en curso tras vaciar la entrada
+static void descartar_pedido(void)
+{
+  cuadrados_descartar(&servicio);
+#if MODO_BINARIO
+  trama_rx_descartar(&receptor);
+#endif
+}
+
+// Agrega la respuesta al comando (si hubo) y envía todo en una sola escritura.
+// 'inicio_us' es cuando la tarea recibió los datos del pedido.
+static void enviar_respuestas(size_t largo, int64_t inicio_us)
+{
+#if MODO_BINARIO
+  size_t n = atender_comando(texto, sizeof(texto));
+  // La respuesta puede pasar de TRAMA_MAX_DATOS: va en varias tramas de texto
+  if (n > 0) largo += trama_codificar_varias(TRAMA_TEXTO, (const uint8_t *)texto, n, (uint8_t *)salida + largo);
+#else
+  largo += atender_comando(salida + largo, sizeof(salida) - largo);
+#endif
+  if (largo == 0) return;
+
+  // Contrapresión: si el buffer TX no tiene espacio, el cliente (o CTS) no
+  // está leyendo al ritmo de los pedidos y esta escritura va a esperar
+  size_t tx_libre = 0;
+  uart_get_tx_buffer_free_size(UART_PORT, &tx_libre);
+  if (tx_libre < largo) metricas.tx_llenos++;
+
+  int64_t antes = esp_timer_get_time();
+  hal_uart_escribir(UART_PORT, salida, largo);
+  int64_t bloqueo = esp_timer_get_time() - antes;
+  if (bloqueo > metricas.tx_bloqueo_max_us) metricas.tx_bloqueo_max_us = bloqueo;
+  metricas.tx_bytes += largo;
+
+  // Cambio de baudaje pedido: esperar a que salga todo lo pendiente, incluida
+  // la confirmación (a 9600 baudios un TX_BUF_SIZE lleno tarda ~4,3 s)
+  if (baud_pendiente != 0) {
+    uart_wait_tx_done(UART_PORT, portMAX_DELAY);
+    uart_set_baudrate(UART_PORT, baud_pendiente);
+    baud_actual = baud_pendiente;
+    baud_pendiente = 0;
+  }
+
+  int64_t latencia = esp_timer_get_time() - inicio_us;
+  if (metricas.envios == 0 || latencia < metricas.lat_min_us) metricas.lat_min_us = latencia;
+  if (latencia > metricas.lat_max_us) metricas.lat_max_us = latencia;
+  metricas.lat_total_us += latencia;
+  metricas.envios++;
+  instr_registrar_us(&hist_respuesta, latencia);
+}
+
+#if MODO_BAJO_CONSUMO
+// Fin de una ráfaga: deja salir las respuestas (el UART no transmite dormido)
+// y vuelve a permitir el sueño
+static void soltar_recepcion(void)
+{
+  if (!recepcion.recibiendo) return;
+  uart_wait_tx_done(UART_PORT, portMAX_DELAY);
+  energia_rx_leido(&energia, &recepcion, 0, &hist_despertar, esp_timer_get_time());
+}
+#endif
+
+// Lee un bloque, responde el cuadrado de cada entero positivo que contenga y
+// envía todas las respuestas juntas con una sola escritura (modo sondeo).
 void replicar_string() 
 {
-  char data[BUF_SIZE + 1] = {0};  // +1 para el carácter nulo
-  int len = uart_read_bytes(UART_PORT, (uint8_t*)data, BUF_SIZE, pdMS_TO_TICKS(20));
+  int64_t espera_inicio = esp_timer_get_time();
+#if MODO_BAJO_CONSUMO
+  // En reposo la espera no tiene límite y el chip duerme hasta el próximo byte
+  int len = hal_uart_leer(UART_PORT, entrada, BUF_SIZE, energia_rx_espera(&recepcion));
+  int64_t inicio = esp_timer_get_time();
+  if (len <= 0) soltar_recepcion();
+  else energia_rx_leido(&energia, &recepcion, (size_t)len, &hist_despertar, inicio);
+#else
+  int len = hal_uart_leer(UART_PORT, entrada, BUF_SIZE, 20);
+  int64_t inicio = esp_timer_get_time();
+#endif
+  metricas.espera_us += inicio - espera_inicio;
+
+  size_t largo = 0;
 
   if (len > 0) 
   {
-      data[len] = '\0';  // Asegurar terminación de string
-      
-      // Primero verificar si el dato se puede convertir a entero y si es mayor a 0
-      // Si es así, entonces buscar el cuadrado usando los primero N números impares
-      // Sino, solo enviar un mensaje de "Entrada inválida"
-      int numero;
-      if (sscanf(data, "%d", &numero) == 1 && numero > 0) 
+      // Recorrer todo el bloque: cada número produce una respuesta "n²\n"
+      // (o cada trama de pedidos, una trama de cuadrados)
+      largo = procesar_bloque(entrada, len);
+  }
+  else
+  {
+      // Sin datos nuevos: si quedó un número sin separador, responderlo ya
+      largo = terminar_pedido(salida, sizeof(salida));
+  }
+
+  // Enviar todas las respuestas del bloque en una sola llamada
+  enviar_respuestas(largo, inicio);
+}
+
+#if MODO_EVENTOS
+// Lee 'total' bytes del driver en bloques de BUF_SIZE y responde cada bloque.
+// Si 'terminar' es verdadero, al final cierra el pedido que quedó sin separador.
+static void atender_bytes(size_t total, bool terminar, int64_t inicio)
+{
+  while (total > 0)
+  {
+    size_t pedir = total < BUF_SIZE ? total : BUF_SIZE;
+    int len = hal_uart_leer(UART_PORT, entrada, pedir, 0);
+    if (len <= 0) break;
+    total -= len;
+
+    size_t largo = procesar_bloque(entrada, len);
+    if (total == 0 && terminar)
+    {
+      largo += terminar_pedido(salida + largo, sizeof(salida) - largo);
+    }
+    enviar_respuestas(largo, inicio);
+  }
+}
+
+// Tarea del modo por eventos: duerme en la cola del driver hasta que hay una
+// línea completa, los datos dejan de llegar, o hay un desborde.
+void uart_event_task(void *arg)
+{
+  uart_event_t evento;
+
+  while (1)
+  {
+    int64_t espera_inicio = esp_timer_get_time();
+#if MODO_BAJO_CONSUMO
+    // En reposo la espera no tiene límite y el chip duerme hasta el próximo byte
+    if (xQueueReceive(uart_queue, &evento, hal_ticks(energia_rx_espera(&recepcion))) != pdTRUE)
+    {
+      metricas.espera_us += esp_timer_get_time() - espera_inicio;
+      soltar_recepcion();
+      continue;
+    }
+    int64_t inicio = esp_timer_get_time();
+    energia_rx_leido(&energia, &recepcion, 1, &hist_despertar, inicio);
+#else
+    if (xQueueReceive(uart_queue, &evento, portMAX_DELAY) != pdTRUE) continue;
+    int64_t inicio = esp_timer_get_time();
+#endif
+    metricas.espera_us += inicio - espera_inicio;
+
+    switch (evento.type)
+    {
+      case UART_PATTERN_DET:
       {
-          
-          // Calcular suma de primeros 'n' impares (n²)
-          int sumatoria = 0;
-          for(int i = 0, impar = 1; i < numero; ++i, impar += 2) 
+        // Se recibió el separador: leer hasta él inclusive y responder
+        int pos = uart_pattern_pop_pos(UART_PORT);
+        if (pos < 0)
+        {
+          // La cola de posiciones se llenó: ya no se sabe dónde termina cada línea
+          uart_flush_input(UART_PORT);
+          uart_pattern_queue_reset(UART_PORT, PATTERN_QUEUE_LEN);
+          descartar_pedido();
+          metricas.desbordes++;
+          break;
+        }
+        atender_bytes(pos + 1, false, inicio);
+        break;
+      }
+
+      case UART_DATA:
+        // Solo interesa el fin de ráfaga sin separador pendiente: es un pedido que
+        // llegó sin terminador y se responde como en el modo sondeo
+        if (evento.timeout_flag && uart_pattern_get_pos(UART_PORT) < 0)
+        {
+          size_t pendientes = hal_uart_pendientes(UART_PORT);
+          atender_bytes(pendientes, true, inicio);
+          if (pendientes == 0)
           {
-              sumatoria += impar;
+            enviar_respuestas(terminar_pedido(salida, sizeof(salida)), inicio);
           }
-          
-          // Convertir resultado a string
-          char resultado[20];
-
-          // Determina la longitud del mensaje a enviar
-          int largo = snprintf(resultado, sizeof(resultado), "%d\n", sumatoria);
-          
-          // Enviar respuesta
-          uart_write_bytes(UART_PORT, resultado, largo);
-        } 
+        }
+        break;
+
+      case UART_FIFO_OVF:
+      case UART_BUFFER_FULL:
+        // Se perdieron datos: descartar lo recibido y volver a empezar
+        uart_flush_input(UART_PORT);
+        uart_pattern_queue_reset(UART_PORT, PATTERN_QUEUE_LEN);
+        xQueueReset(uart_queue);
+        descartar_pedido();
+        metricas.desbordes++;
+        break;
+
+      default:
+        break;
     }
+  }
 }
+#endif
 
 void app_main() {
+#if MODO_BAJO_CONSUMO
+  // Antes del UART: la tarea de servicio toma el bloqueo de sueño desde el primer byte
+  esp_err_t err = energia_iniciar(&energia);
+  if (err != ESP_OK) printf("Bajo consumo no disponible (%d): revise CONFIG_PM_ENABLE\n", err);
+#endif
   // Iniciar el puerto serial.
   // La tasa de baudios se pasa como argumento.
-  uart_init(9600);
+  uart_init(BAUD_INICIAL);
+  cuadrados_init(&servicio);
+#if MODO_BINARIO
+  trama_rx_init(&receptor);
+#endif
+  metricas.desde_us = esp_timer_get_time();
 
   // Mostrar mensaje por serial (OPCIONAL)
-  printf("Iniciando...\n");
+  printf("Iniciando... (envíe \"?\" para ver métricas, \"!perf\" para latencias y pila o "
+         "\"!baud=921600\" para cambiar la velocidad)\n");
 
-  // En loop, de lo que reciba verificar si es un entero positivo.
-  // Si lo es, cualcular el cuadrado
-  // Si no, no hacer nada
+#if MODO_EVENTOS
+  // La tarea despierta solo con líneas completas; app_main puede terminar
+  TaskHandle_t tarea = NULL;
+  xTaskCreate(uart_event_task, "uart_event_task", 4096, NULL, 10, &tarea);
+  instr_registrar_tarea(tarea);
+#else
+  // En loop, de lo que reciba buscar todos los enteros positivos.
+  // Por cada uno, calcular el cuadrado (n * n en 64 bits)
+  // Lo demás se ignora
+  instr_registrar_tarea(xTaskGetCurrentTaskHandle());
   while(1) {
     replicar_string();
   }
+#endif
 }
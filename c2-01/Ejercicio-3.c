@@ -10,21 +10,33 @@
    (c) 3 toques largos.
 3. Luego de hacer esa secuencia, se debe tocar otro pin táctil para validar la secuencia.
 4. Imprimir por serial "APROBADO" o "NO APROBADO" si la secuencia ingresada es correcta o no.
-5. Por grupo definir el tiempo a su criterio para determinar que es "toque largo" y por "toque corto".*/
+5. Por grupo definir el tiempo a su criterio para determinar que es "toque largo" y por "toque corto".
+
+Con los 10 canales táctiles caben hasta 5 estaciones (par de pads de ingreso
+y validación, patrones y tiempos propios) que varias personas pueden usar a
+la vez; una sola tarea las atiende a todas (sesiones.h).*/
 
 // Librerías estándar y específicas del ESP32
 #include <stdio.h>                  // Para funciones estándar de entrada/salida (como printf)
 #include <inttypes.h>               // Para tipos de enteros con tamaño fijo (ej: uint8_t, uint32_t)
+#include <string.h>                 // strcmp para los comandos de la consola
 #include "freertos/FreeRTOS.h"      // Base del sistema operativo en tiempo real FreeRTOS
 #include "freertos/task.h"          // Para manejo de tareas en FreeRTOS
+#include "freertos/queue.h"         // Cola entre la interrupción táctil y la tarea
 #include "driver/touch_pad.h"       // Para configurar y usar el sistema de pads táctiles del ESP32
 #include "esp_log.h"                // Para mostrar mensajes en consola con etiquetas y niveles
+#include "esp_timer.h"              // Marcas de tiempo en microsegundos
+#include "patrones.h"               // Motor de patrones (tabla de transiciones por bits)
+#include "sesiones.h"               // Sesiones de autenticación de cada estación
+#include "linea_base.h"             // Línea base adaptable con umbrales enteros
+#include "hal.h"                    // Lecturas táctiles y reloj (reproducibles en el computador)
+#include "instrumentacion.h"        // Histogramas de latencia, CPU y pila de las tareas
+#include "driver/uart.h"            // Consola: comando "!perf"
 
 // ----------------------
-// Configuración de pines táctiles
+// Pines táctiles: número de GPIO de cada canal (índice = número de pad), para los mensajes
 // ----------------------
-#define TOUCH_PAD_SEQUENCE TOUCH_PAD_NUM8  // Pad táctil GPIO 33, usado para ingresar la secuencia
-#define TOUCH_PAD_VALIDATE TOUCH_PAD_NUM7  // Pad táctil GPIO 27, usado para validar la secuencia ingresada
+static const uint8_t pad_gpio[TOUCH_PAD_MAX] = { 4, 0, 2, 15, 13, 12, 14, 27, 33, 32 };
 
 // ----------------------
 // Definición de tiempos límite en milisegundos
@@ -35,60 +47,344 @@
 #define VALIDATION_TIMEOUT  15000  // Tiempo máximo para validar la secuencia después de ingresarla (15 segundos)
 
 // ----------------------
-// Secuencia correcta esperada (3 largos, 3 cortos, 3 largos → 1=largo, 0=corto)
+// Modo de detección
+// ----------------------
+// 1 = por interrupciones: en reposo el sensor compara cada medición con el
+//     umbral y dispara una interrupción al tocar cualquier pad. La ISR marca
+//     el flanco con esp_timer_get_time() y lo envía por una cola.
+//     - Con una sola estación, tras el toque se arma la interrupción de
+//       suelta de ese pad: los dos flancos llevan marca de la ISR y la
+//       duración tiene la resolución de una medición (~0.5 ms).
+//     - Con varias, mientras algún pad siga tocado la tarea lee los pads cada
+//       TOUCH_SCAN_MS para ver sueltas y toques en otras estaciones (el
+//       disparo del hardware es uno solo para todos los pads: no puede
+//       esperar a la vez que un pad se suelte y que otro se toque). La suelta
+//       tiene entonces una resolución de TOUCH_SCAN_MS.
+//     Sin pads tocados la tarea duerme hasta el próximo toque, tiempo límite
+//     o muestra de seguimiento de la línea base.
+// 0 = sondeo: lee todos los pads cada 50 ms (duraciones en pasos de 50 ms).
+#define MODO_INTERRUPCION 1
+#define TOUCH_QUEUE_LEN 16         // Flancos pendientes entre la ISR y la tarea
+
+// ----------------------
+// Bajo consumo: con MODO_BAJO_CONSUMO 1 el chip duerme (sueño ligero) entre
+// flancos y lo despierta el toque (energia.h; requiere MODO_INTERRUPCION,
+// CONFIG_PM_ENABLE y CONFIG_FREERTOS_USE_TICKLESS_IDLE). El sensor sigue
+// midiendo dormido, más espaciado para gastar menos. La consola también
+// despierta al chip: los primeros bytes se pierden, así que conviene
+// anteponer ENERGIA_PREAMBULO_MIN(115200) = 13 "\n" al comando. "!energia"
+// informa el tiempo despierto, la corriente estimada y la latencia del
+// despertar al flanco y al primer byte de la consola.
+// ----------------------
+#define MODO_BAJO_CONSUMO 0
+
+#if MODO_BAJO_CONSUMO
+#include "energia.h"
+#if !MODO_INTERRUPCION
+#error "MODO_BAJO_CONSUMO requiere MODO_INTERRUPCION: el sondeo despierta al chip cada 50 ms"
+#endif
+#endif
+
+// ----------------------
+// Línea base adaptable (solo enteros): umbrales en fracciones de 1/256 de la base
 // ----------------------
-static const uint8_t expected_sequence[9] = {1, 1, 1, 0, 0, 0, 1, 1, 1};
+#define TOUCH_THRESH_PRESS   LINEA_BASE_TOCAR_256   // Tocado bajo el 50% de la base
+#define TOUCH_THRESH_RELEASE LINEA_BASE_SOLTAR_256  // Suelto sobre el 65% de la base (histéresis)
+#define TOUCH_CAL_SAMPLES    32    // Muestras promediadas al calibrar
+#define TOUCH_CAL_PERIOD_MS  10    // Separación entre muestras de calibración
+#define TOUCH_STUCK_MS       60000 // Un pad tocado por más de 1 minuto se recalibra
+#if MODO_INTERRUPCION
+// Muestra periódica solo para seguir la deriva: es lo único que despierta la
+// tarea en reposo (la deriva por humedad o temperatura tarda minutos)
+#define TOUCH_TRACK_PERIOD_MS 5000
+#define TOUCH_IIR_SHIFT       5    // Constante de tiempo ≈ 2^5 x 5 s ≈ 2.7 min
+#else
+#define TOUCH_TRACK_PERIOD_MS 50   // Cada lectura del sondeo actualiza la base
+#define TOUCH_IIR_SHIFT       LINEA_BASE_DESPLAZAMIENTO  // Constante de tiempo ≈ 2^12 x 50 ms ≈ 3.4 min
+#endif
+
+// Período de medición en modo interrupción (~0.5 ms por muestra en vez de
+// los ~30 ms por defecto): el toque se marca con la resolución de una
+// medición, y la suelta también con una sola estación. Con varias, mientras
+// hay pads tocados se leen cada TOUCH_SCAN_MS (resolución de las sueltas).
+// En bajo consumo se mide cada ~14 ms: sobra para separar toques de segundos.
+#if MODO_BAJO_CONSUMO
+#define TOUCH_SLEEP_CYCLES 0x0800  // Ciclos de RTC_SLOW_CLK (150 kHz) entre mediciones (~14 ms)
+#define TOUCH_SCAN_MS      20
+#else
+#define TOUCH_SLEEP_CYCLES 0x0020  // Ciclos de RTC_SLOW_CLK (150 kHz) entre mediciones (~0.2 ms)
+#define TOUCH_SCAN_MS      10
+#endif
+#define TOUCH_MEAS_CYCLES  0x0800  // Ciclos de RTC_FAST_CLK (8 MHz) por medición (~0.25 ms)
+
+// ----------------------
+// Estaciones de ingreso (sesiones.h): cada una tiene su par de pads, sus
+// patrones (bit i = toque i; 1=largo, 0=corto) y sus tiempos, y varias
+// personas pueden usarlas a la vez. La primera es la del enunciado; para
+// agregar otra basta una línea (hasta 5 con los 10 canales táctiles).
+// La puerta acepta solo el patrón del enunciado. Una estación puede registrar
+// más (hasta 32 patrones de hasta 32 toques), p. ej.:
+//     PATRON("3 cortos, 3 largos, 3 cortos", 9, 0x038),  // CCCLLLCCC
+// ----------------------
+static const patron_t door_patterns[] = {
+    PATRON("3 largos, 3 cortos, 3 largos", 9, 0x1C7),  // LLLCCCLLL
+};
+static const patron_t storage_patterns[] = {
+    PATRON("1 largo, 2 cortos, 1 largo",   4, 0x009),  // LCCL
+};
+
+static const sesion_config_t stations[] = {
+    {.nombre = "Puerta", .pad_ingreso = TOUCH_PAD_NUM8, .pad_validar = TOUCH_PAD_NUM7,   // GPIO 33 / 27
+     .largo_min_ms = LONG_TOUCH_MIN, .entre_toques_ms = MAX_BETWEEN_TOUCHES, .validar_ms = VALIDATION_TIMEOUT,
+     .patrones = door_patterns, .num_patrones = sizeof(door_patterns) / sizeof(door_patterns[0])},
+    {.nombre = "Bodega", .pad_ingreso = TOUCH_PAD_NUM9, .pad_validar = TOUCH_PAD_NUM6,   // GPIO 32 / 14
+     .largo_min_ms = LONG_TOUCH_MIN, .entre_toques_ms = MAX_BETWEEN_TOUCHES, .validar_ms = VALIDATION_TIMEOUT,
+     .patrones = storage_patterns, .num_patrones = sizeof(storage_patterns) / sizeof(storage_patterns[0])},
+};
+#define NUM_STATIONS (int)(sizeof(stations) / sizeof(stations[0]))
+#define TOUCH_RELEASE_ISR (NUM_STATIONS == 1)   // Suelta por interrupción (ver MODO_INTERRUPCION)
+
+// Pads táctiles en uso (los dos de cada estación): todos se calibran y siguen su línea base
+#define NUM_TOUCH_CHANNELS (2 * NUM_STATIONS)
+static touch_pad_t touch_channels[NUM_TOUCH_CHANNELS];
+static uint32_t touch_pads_mask = 0;    // Bit n = pad n en uso
 
 // ----------------------
 // Variables de estado del sistema
 // ----------------------
-static uint8_t entered_sequence[9];     // Arreglo para guardar los toques del usuario (0 o 1)
-static uint8_t sequence_index = 0;      // Índice actual dentro de la secuencia
-static uint32_t last_touch_time = 0;    // Marca de tiempo del último toque válido
-static bool waiting_validation = false; // Bandera: indica si ya se completó la secuencia y se está esperando validación
-static bool current_touch = false;      // Bandera: indica si el dedo está actualmente tocando el pad
-static uint32_t touch_start_time = 0;   // Momento en que inició el toque actual
-static uint16_t baseline_seq = 0;       // Valor de referencia para el pad táctil de entrada
-static uint16_t baseline_val = 0;       // Valor de referencia para el pad táctil de validación
+static sesiones_t sessions;             // Estado de todas las estaciones (solo lo toca la tarea táctil)
+static uint32_t pressed_pads = 0;       // Pads tocados en este momento (bit n = pad n)
+#if MODO_INTERRUPCION
+static touch_pad_t release_pad = TOUCH_PAD_MAX; // Pad cuya suelta espera la ISR (TOUCH_PAD_MAX: ninguno)
+#endif
+static linea_base_t baselines[TOUCH_PAD_MAX]; // Línea base y umbrales de cada pad (índice = número de pad)
 
 static const char *TAG = "TouchAuth";   // Etiqueta para los mensajes del sistema de autenticación táctil
 
+// ----------------------
+// Instrumentación (instrumentacion.h). Se consulta enviando "!perf" por la
+// consola (UART0); la tarea de consola duerme en la lectura, sin sondeo.
+// - flanco:    interrupción -> tarea (us, solo en modo interrupción)
+// - veredicto: toque de validación o toque rechazado -> resultado impreso (us)
+// - muestra:   lectura de todos los pads y su línea base (ciclos)
+// ----------------------
+#define CONSOLE_UART UART_NUM_0
+#define CONSOLE_LINE_MAX 16
+static instr_hist_t hist_edge = INSTR_HIST("flanco");
+static instr_hist_t hist_verdict = INSTR_HIST("veredicto");
+static instr_hist_t hist_sample = INSTR_HIST("muestra");
+static int64_t verdict_ref_us = 0;      // Marca del flanco que se está atendiendo
+
+#if MODO_BAJO_CONSUMO
+static energia_t energia;
+static instr_hist_t hist_wake = INSTR_HIST("despertar");  // Despertar -> flanco atendido (us)
+static instr_hist_t hist_console_wake = INSTR_HIST("despertar_consola");  // Despertar -> primer byte (us)
+static uint32_t wake_seen = 0;          // Último despertar ya medido
+#endif
+
+#if MODO_INTERRUPCION
+// Toque detectado por la interrupción táctil
+typedef struct {
+    uint32_t pads;   // Pads bajo el umbral (bit n = pad n)
+    int64_t t_us;    // Momento del toque (esp_timer_get_time)
+} touch_edge_t;
+
+static QueueHandle_t touch_queue;       // Toques de la ISR hacia la tarea
+#endif
+
 // ----------------------
 // Prototipos de funciones
 // ----------------------
-void reset_sequence();                        // Reinicia todo el estado de la secuencia
-void validate_sequence();                     // Compara la secuencia ingresada con la esperada
-void calibrate_touch_pad(touch_pad_t, uint16_t *); // Calibra un pad táctil, ajustando su umbral de activación
+void calibrate_touch_pads();                  // Calibra todos los pads en uso, ajustando sus umbrales
+void recalibrate_touch_pads();                // Repite la calibración con el sistema en marcha
 void init_touch_system();                     // Inicializa los pads táctiles y el sistema general
+#if MODO_INTERRUPCION
+static void arm_touch_edge(void);             // Espera un toque en cualquier pad por interrupción
+static void arm_touch_release(touch_pad_t);   // Espera por interrupción que se suelte un pad
+#endif
+
+// ----------------------
+// Tiempo actual en milisegundos desde el inicio
+// ----------------------
+static inline uint32_t now_ms(void) {
+#if MODO_INTERRUPCION
+    return (uint32_t)(esp_timer_get_time() / 1000);  // Misma base que las marcas de la ISR
+#else
+    return hal_ms();
+#endif
+}
+
+#if MODO_INTERRUPCION
+// ----------------------
+// Interrupción táctil: guarda qué pads cruzaron el umbral y cuándo, y deja
+// la interrupción apagada: mientras haya pads tocados la tarea los lee ella
+// misma (si no, se repetiría en cada medición mientras el pad siga tocado).
+// ----------------------
+static void touch_isr(void *arg) {
+    touch_edge_t edge = {
+        .pads = touch_pad_get_status(),
+        .t_us = esp_timer_get_time(),
+    };
+    touch_pad_clear_status();
+    touch_pad_intr_disable();
+
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR(touch_queue, &edge, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// ----------------------
+// Espera por interrupción un toque (valor bajo el umbral de toque de su línea
+// base) en cualquiera de los pads en uso. Solo se arma con todos los pads sueltos.
+// ----------------------
+static void arm_touch_edge(void) {
+    for(int i = 0; i < NUM_TOUCH_CHANNELS; i++) {
+        touch_pad_set_thresh(touch_channels[i], baselines[touch_channels[i]].umbral_tocar);
+    }
+    touch_pad_set_group_mask(touch_pads_mask, 0, 0);
+    touch_pad_set_trigger_mode(TOUCH_TRIGGER_BELOW);
+    touch_pad_clear_status();
+    touch_pad_intr_enable();
+}
 
 // ----------------------
-// Calibración de un pad táctil
+// Espera por interrupción que 'pad' se suelte (valor sobre su umbral de
+// suelta). Los demás pads salen del grupo para que su reposo no dispare.
 // ----------------------
-void calibrate_touch_pad(touch_pad_t touch_num, uint16_t *baseline) {
-    uint16_t touch_value;
-    touch_pad_read(touch_num, &touch_value);              // Lee el valor actual sin filtrar del pad táctil
-    *baseline = touch_value;                              // Guarda ese valor como línea base (sin tocar)
-    touch_pad_set_thresh(touch_num, touch_value * 0.5);   // Establece un umbral de detección al 50% del valor base
-    ESP_LOGI(TAG, "Pad %d calibrado - Base: %d, Umbral: %d", 
-             touch_num, touch_value, (uint16_t)(touch_value * 0.5));
+static void arm_touch_release(touch_pad_t pad) {
+    release_pad = pad;
+    touch_pad_set_thresh(pad, baselines[pad].umbral_soltar);
+    touch_pad_clear_group_mask(touch_pads_mask & ~(1 << pad), 0, 0);
+    touch_pad_set_trigger_mode(TOUCH_TRIGGER_ABOVE);
+    touch_pad_clear_status();
+    touch_pad_intr_enable();
+}
+#endif
+
+// ----------------------
+// Calibración de los pads táctiles: promedia TOUCH_CAL_SAMPLES lecturas sin
+// filtrar de cada pad (sin tocar) y fija sus umbrales
+// ----------------------
+void calibrate_touch_pads() {
+    for(int i = 0; i < NUM_TOUCH_CHANNELS; i++) {
+        linea_base_calibrar(&baselines[touch_channels[i]], TOUCH_CAL_SAMPLES);
+    }
+
+    for(int k = 0; k < TOUCH_CAL_SAMPLES; k++) {
+        for(int i = 0; i < NUM_TOUCH_CHANNELS; i++) {
+            uint16_t touch_value;
+            hal_touch_leer(touch_channels[i], &touch_value);   // Lee el valor actual sin filtrar del pad táctil
+            linea_base_muestra(&baselines[touch_channels[i]], touch_value);
+        }
+        hal_esperar_ms(TOUCH_CAL_PERIOD_MS);
+    }
+
+    for(int i = 0; i < NUM_TOUCH_CHANNELS; i++) {
+        const linea_base_t *lb = &baselines[touch_channels[i]];
+        touch_pad_set_thresh(touch_channels[i], lb->umbral_tocar);
+        ESP_LOGI(TAG, "Pad %d calibrado - Base: %d, Umbral: %d (suelta: %d)",
+                 touch_channels[i], linea_base_valor(lb), lb->umbral_tocar, lb->umbral_soltar);
+    }
+}
+
+// ----------------------
+// Repite la calibración con el sistema en marcha (p. ej. cuando un pad queda
+// "tocado" por una línea base vieja). Descarta las secuencias en curso.
+// ----------------------
+void recalibrate_touch_pads() {
+#if MODO_INTERRUPCION
+    touch_pad_intr_disable();
+#endif
+    calibrate_touch_pads();
+    pressed_pads = 0;
+#if MODO_INTERRUPCION
+    release_pad = TOUCH_PAD_MAX;
+    xQueueReset(touch_queue);                     // Los toques pendientes usaban los umbrales viejos
+    arm_touch_edge();
+#endif
+    sesiones_reiniciar_todas(&sessions);
+    ESP_LOGI(TAG, "Esperando secuencia en todas las estaciones...");
+}
+
+// ----------------------
+// Lee todos los pads en uso y actualiza su línea base. Devuelve los pads
+// tocados (bit n = pad n). Si alguno quedó tocado más de TOUCH_STUCK_MS, la
+// línea base pide recalibrar y se recalibran todos.
+// ----------------------
+static uint32_t sample_touch_pads(void) {
+    uint32_t touched = 0;
+    bool stuck = false;
+    uint32_t mark = instr_marca();
+
+    for(int i = 0; i < NUM_TOUCH_CHANNELS; i++) {
+        touch_pad_t pad = touch_channels[i];
+        uint16_t touch_value;
+#if MODO_INTERRUPCION
+        hal_touch_leer(pad, &touch_value);
+#else
+        hal_touch_leer_filtrado(pad, &touch_value);
+#endif
+        if(linea_base_muestra(&baselines[pad], touch_value)) touched |= 1 << pad;
+        if(linea_base_calibrando(&baselines[pad])) stuck = true;
+    }
+    instr_desde(&hist_sample, mark);
+
+    if(stuck) {
+        ESP_LOGW(TAG, "Pad tocado por más de %d segundos: recalibrando", TOUCH_STUCK_MS / 1000);
+        recalibrate_touch_pads();
+        return 0;
+    }
+    return touched;
 }
 
 // ----------------------
 // Inicializa el sistema táctil completo
 // ----------------------
 void init_touch_system() {
+    sesiones_init(&sessions);
+    for(int i = 0; i < NUM_STATIONS; i++) {
+        if(sesiones_agregar(&sessions, &stations[i]) < 0) {
+            ESP_LOGE(TAG, "Estación %s inválida: pads repetidos o patrones inválidos (máximo %d de 1 a %d toques)",
+                     stations[i].nombre, PATRONES_MAX, PATRONES_MAX_LARGO);
+        }
+        touch_channels[2 * i] = stations[i].pad_ingreso;
+        touch_channels[2 * i + 1] = stations[i].pad_validar;
+        touch_pads_mask |= (1 << stations[i].pad_ingreso) | (1 << stations[i].pad_validar);
+    }
+
     touch_pad_init();                             // Inicializa el sistema de pads táctiles del ESP32
     touch_pad_set_fsm_mode(TOUCH_FSM_MODE_TIMER); // Usa el temporizador interno para muestreo automático
     touch_pad_set_voltage(TOUCH_HVOLT_2V7, TOUCH_LVOLT_0V5, TOUCH_HVOLT_ATTEN_1V); // Ajuste de voltajes internos
+#if MODO_INTERRUPCION
+    touch_pad_set_meas_time(TOUCH_SLEEP_CYCLES, TOUCH_MEAS_CYCLES); // Mediciones cada ~0.5 ms
+#endif
 
-    touch_pad_config(TOUCH_PAD_SEQUENCE, 0);      // Configura el pad táctil de ingreso (GPIO33)
-    touch_pad_config(TOUCH_PAD_VALIDATE, 0);      // Configura el pad táctil de validación (GPIO27)
+    for(int i = 0; i < NUM_TOUCH_CHANNELS; i++) {
+        touch_pad_config(touch_channels[i], 0);   // Ingreso y validación de cada estación
+    }
 
+#if !MODO_INTERRUPCION
+    // El filtro corre en un temporizador cada 30 ms; en modo interrupción el
+    // hardware compara cada medición con el umbral y no hace falta
     touch_pad_filter_start(30);                   // Aplica un filtro digital para estabilidad
+#endif
     vTaskDelay(200 / portTICK_PERIOD_MS);         // Espera breve para asegurar que los pads estén listos
 
-    calibrate_touch_pad(TOUCH_PAD_SEQUENCE, &baseline_seq); // Calibra pad de ingreso
-    calibrate_touch_pad(TOUCH_PAD_VALIDATE, &baseline_val); // Calibra pad de validación
+    for(int i = 0; i < NUM_TOUCH_CHANNELS; i++) {
+        linea_base_init(&baselines[touch_channels[i]], TOUCH_THRESH_PRESS, TOUCH_THRESH_RELEASE,
+                        TOUCH_IIR_SHIFT, TOUCH_STUCK_MS / TOUCH_TRACK_PERIOD_MS);
+    }
+    calibrate_touch_pads();                       // Calibra todos los pads en uso
+
+#if MODO_INTERRUPCION
+    touch_queue = xQueueCreate(TOUCH_QUEUE_LEN, sizeof(touch_edge_t));
+    touch_pad_set_trigger_source(TOUCH_TRIGGER_SOURCE_SET1); // Basta un pad del grupo 1 para interrumpir
+    touch_pad_isr_register(touch_isr, NULL);
+    arm_touch_edge();                             // Primer flanco esperado: un toque en cualquier pad
+#endif
+#if MODO_BAJO_CONSUMO
+    energia_despertar_con_touch();                // El flanco despierta al chip del sueño ligero
+#endif
 
     // Mensajes de inicio del sistema
     ESP_LOGI(TAG, "-------------------------------------------");
@@ -99,139 +395,313 @@ void init_touch_system() {
     ESP_LOGI(TAG, "- Toque largo: ≥3 segundos");
     ESP_LOGI(TAG, "- Máximo entre toques: 10 segundos");
     ESP_LOGI(TAG, "- Tiempo para validar: 15 segundos");
-    ESP_LOGI(TAG, "Instrucciones:");
-    ESP_LOGI(TAG, "1. Toque GPIO33 (D33 - Touch8)");
-    ESP_LOGI(TAG, "   Secuencia: 3 largos, 3 cortos, 3 largos");
-    ESP_LOGI(TAG, "2. Luego toque GPIO27 (D27 - Touch7) para validar");
+#if MODO_INTERRUPCION
+    if(TOUCH_RELEASE_ISR) {
+        ESP_LOGI(TAG, "- Detección: interrupción al tocar y al soltar");
+    } else {
+        ESP_LOGI(TAG, "- Detección: interrupción al tocar; lectura cada %d ms con pads tocados", TOUCH_SCAN_MS);
+    }
+    ESP_LOGI(TAG, "- Seguimiento de la línea base: cada %d segundos", TOUCH_TRACK_PERIOD_MS / 1000);
+#else
+    ESP_LOGI(TAG, "- Detección: sondeo cada 50 ms");
+#endif
+    for(int i = 0; i < NUM_STATIONS; i++) {
+        const sesion_config_t *st = &stations[i];
+        ESP_LOGI(TAG, "Estación %s:", st->nombre);
+        ESP_LOGI(TAG, "1. Toque GPIO%d (Touch%d) con alguno de los patrones:",
+                 pad_gpio[st->pad_ingreso], st->pad_ingreso);
+        for(int k = 0; k < st->num_patrones; k++) {
+            char text[PATRONES_MAX_LARGO + 1];
+            patrones_a_texto(st->patrones[k].simbolos, st->patrones[k].largo, text);
+            ESP_LOGI(TAG, "   %s (%s)", st->patrones[k].nombre, text);
+        }
+        ESP_LOGI(TAG, "2. Luego toque GPIO%d (Touch%d) para validar", pad_gpio[st->pad_validar], st->pad_validar);
+    }
     ESP_LOGI(TAG, "====================================\n");
-
-    reset_sequence(); // Inicia en estado limpio
+    ESP_LOGI(TAG, "Esperando secuencia en todas las estaciones...");
 }
 
 // ----------------------
-// Reinicia los valores para comenzar una nueva secuencia
+// Muestra el resultado de una secuencia: los toques ingresados y el
+// veredicto. La sesión ya volvió al estado inicial.
 // ----------------------
-void reset_sequence() {
-    sequence_index = 0;             // Reinicia el índice de toques
-    waiting_validation = false;     // Se sale del modo de validación
-    last_touch_time = 0;            // Borra el último tiempo registrado
-    ESP_LOGI(TAG, "Esperando secuencia en el pin táctil...");
+static void print_verdict(const sesion_config_t *st, const sesion_evento_t *ev) {
+    char text[PATRONES_MAX_LARGO + 1];
+    patrones_a_texto(ev->ingresado, ev->toques, text);
+
+    // Muestra la secuencia ingresada con detalle
+    ESP_LOGI(TAG, "\n=== RESULTADO (%s) ===", st->nombre);
+    for(int i = 0; i < ev->toques; i++) {
+        ESP_LOGI(TAG, "Toque %d: %s", i+1, ((ev->ingresado >> i) & 1) ? "LARGO" : "CORTO");
+    }
+    ESP_LOGI(TAG, "Secuencia: %s", text);
+
+    // Resultado final
+    if(ev->tipo == SESION_APROBADO) {
+        ESP_LOGI(TAG, "APROBADO (patrón: %s)", st->patrones[ev->patron].nombre);
+    } else {
+        ESP_LOGI(TAG, "NO APROBADO");
+    }
+    ESP_LOGI(TAG, "==================\n");
+    instr_registrar_us(&hist_verdict, esp_timer_get_time() - verdict_ref_us);
 }
 
 // ----------------------
-// Verifica si la secuencia ingresada es válida
+// Imprime lo que pasó en una estación
 // ----------------------
-void validate_sequence() {
-    bool approved = true; // Bandera para saber si la secuencia fue correcta
+static void report_event(const sesion_evento_t *ev) {
+    const sesion_config_t *st = &stations[ev->sesion];
+
+    switch(ev->tipo) {
+    case SESION_TOQUE:
+    case SESION_COMPLETA:
+        ESP_LOGI(TAG, "[%s] Toque %d: %s (%.3f segundos)", st->nombre, ev->toques,
+                 ((ev->ingresado >> (ev->toques - 1)) & 1) ? "TOQUE LARGO" : "TOQUE CORTO",
+                 ev->duracion_ms / 1000.0);
+        if(ev->tipo == SESION_COMPLETA) {
+            ESP_LOGI(TAG, "\n [%s] SECUENCIA COMPLETADA", st->nombre);
+            ESP_LOGI(TAG, "Toque GPIO%d (Touch%d) para validar la secuencia (tiene %d segundos)",
+                     pad_gpio[st->pad_validar], st->pad_validar, st->validar_ms / 1000);
+        }
+        return;
+    case SESION_ERROR_VALIDAR:
+        // El usuario volvió a tocar el pad de ingreso en vez del de validación
+        ESP_LOGW(TAG, "[%s] Error: Toque el pin GPIO%d (Touch%d) para validar, no GPIO%d (Touch%d)", st->nombre,
+                 pad_gpio[st->pad_validar], st->pad_validar, pad_gpio[st->pad_ingreso], st->pad_ingreso);
+        return;
+    case SESION_RECHAZADO:
+        // Ningún patrón empieza así: no tiene sentido esperar el resto
+        ESP_LOGI(TAG, "[%s] El toque %d no coincide con ningún patrón registrado", st->nombre, ev->toques);
+        print_verdict(st, ev);
+        break;
+    case SESION_APROBADO:
+    case SESION_NO_APROBADO:
+        print_verdict(st, ev);
+        break;
+    case SESION_VENCIDO_VALIDAR:
+        ESP_LOGW(TAG, "[%s] Tiempo de validación agotado (%d segundos)", st->nombre, st->validar_ms / 1000);
+        break;
+    case SESION_VENCIDO_ENTRE:
+        ESP_LOGW(TAG, "[%s] El tiempo entre toques se ha excedido (%d segundos)", st->nombre,
+                 st->entre_toques_ms / 1000);
+        break;
+    }
+    ESP_LOGI(TAG, "[%s] Esperando secuencia en el pin táctil...", st->nombre);
+}
 
-    // Compara uno por uno los valores de la secuencia ingresada con la esperada
-    for(int i = 0; i < 9; i++) {
-        if(entered_sequence[i] != expected_sequence[i]) {
-            approved = false;
-            break;
+// ----------------------
+// Pasa a las sesiones los pads que cambiaron ('touched' es el estado nuevo
+// de todos). Primero las sueltas: si en la misma lectura se soltó el pad de
+// ingreso y se tocó el de validación, la validación cuenta.
+// ----------------------
+static void dispatch_touch_pads(uint32_t touched, uint32_t current_time) {
+    uint32_t released = pressed_pads & ~touched;
+    uint32_t pressed = touched & ~pressed_pads;
+    pressed_pads = touched;
+
+    for(int i = 0; i < NUM_TOUCH_CHANNELS; i++) {
+        sesion_evento_t ev;
+        touch_pad_t pad = touch_channels[i];
+        if((released & (1 << pad)) && sesiones_flanco(&sessions, pad, false, current_time, &ev)) {
+            report_event(&ev);
+        }
+    }
+    for(int i = 0; i < NUM_TOUCH_CHANNELS; i++) {
+        sesion_evento_t ev;
+        touch_pad_t pad = touch_channels[i];
+        if((pressed & (1 << pad)) && sesiones_flanco(&sessions, pad, true, current_time, &ev)) {
+            report_event(&ev);
         }
     }
+}
 
-    // Muestra la secuencia ingresada con detalle
-    ESP_LOGI(TAG, "\n=== RESULTADO ===");
-    for(int i = 0; i < 9; i++) {
-        ESP_LOGI(TAG, "Toque %d: %s %s", i+1,
-                 entered_sequence[i] ? "LARGO" : "CORTO",
-                 entered_sequence[i] == expected_sequence[i] ? "[OK]" : "[X]");
+// ----------------------
+// Reinicia las estaciones cuyo tiempo entre toques o de validación se venció
+// ----------------------
+static void check_timeouts(uint32_t current_time) {
+    sesion_evento_t expired[SESIONES_MAX];
+    int n = sesiones_vencer(&sessions, current_time, expired);
+    for(int i = 0; i < n; i++) {
+        report_event(&expired[i]);
     }
+}
 
-    // Resultado final
-    if(approved) {
-        ESP_LOGI(TAG, "APROBADO");
+#if MODO_INTERRUPCION
+// ----------------------
+// Ticks hasta el próximo tiempo límite de cualquier estación (portMAX_DELAY
+// si ninguna tiene una secuencia en curso: la tarea no despierta hasta el
+// siguiente toque)
+// ----------------------
+static TickType_t ticks_to_deadline(uint32_t current_time) {
+    uint32_t remaining = sesiones_proximo_limite(&sessions, current_time);
+    if(remaining == UINT32_MAX) return portMAX_DELAY;
+    if(remaining == 0) return 0;
+    return pdMS_TO_TICKS(remaining) + 1;          // +1: despertar ya vencido el límite
+}
+
+// ----------------------
+// Atiende un flanco enviado por la ISR: un toque (todos los pads estaban
+// sueltos) o, con una sola estación, la suelta del pad tocado
+// ----------------------
+static void handle_touch_edge(const touch_edge_t *edge) {
+    int64_t now_us = esp_timer_get_time();
+    instr_registrar_us(&hist_edge, now_us - edge->t_us);
+#if MODO_BAJO_CONSUMO
+    energia_medir_despertar(&energia, &wake_seen, &hist_wake, now_us);
+#endif
+    verdict_ref_us = edge->t_us;
+    uint32_t edge_time = (uint32_t)(edge->t_us / 1000);
+
+    if(release_pad != TOUCH_PAD_MAX) {
+        uint32_t released = 1u << release_pad;
+        release_pad = TOUCH_PAD_MAX;
+        dispatch_touch_pads(pressed_pads & ~released, edge_time);
     } else {
-        ESP_LOGI(TAG, "NO APROBADO");
+        dispatch_touch_pads(pressed_pads | (edge->pads & touch_pads_mask), edge_time);
     }
-    ESP_LOGI(TAG, "==================\n");
 
-    reset_sequence(); // Vuelve a estado inicial tras validación
+    if(pressed_pads == 0) {
+        arm_touch_edge();                         // Sin pads activos: seguir esperando
+    } else if(TOUCH_RELEASE_ISR && (pressed_pads & (pressed_pads - 1)) == 0) {
+        arm_touch_release((touch_pad_t)__builtin_ctz(pressed_pads));  // Un solo pad: su suelta por ISR
+    }
 }
 
 // ----------------------
-// Tarea principal que corre en segundo plano en FreeRTOS
+// Con algún pad tocado: lee todos los pads y compara cada uno con el umbral
+// que le toca (el de suelta si estaba tocado, el de toque si no). Cuando se
+// sueltan todos, vuelve a esperar el próximo toque por interrupción.
 // ----------------------
-void touch_auth_task(void *pvParameter) {
-    uint16_t touch_seq_value, touch_val_value;
+static void scan_touch_pads(void) {
+    uint32_t touched = 0;
+    for(int i = 0; i < NUM_TOUCH_CHANNELS; i++) {
+        touch_pad_t pad = touch_channels[i];
+        const linea_base_t *lb = &baselines[pad];
+        uint16_t touch_value;
+        hal_touch_leer(pad, &touch_value);
+        if(touch_value < ((pressed_pads & (1 << pad)) ? lb->umbral_soltar : lb->umbral_tocar)) {
+            touched |= 1 << pad;
+        }
+    }
+
+    verdict_ref_us = esp_timer_get_time();
+    dispatch_touch_pads(touched, now_ms());
+    if(pressed_pads == 0) arm_touch_edge();
+}
 
+// ----------------------
+// Tarea principal que corre en segundo plano en FreeRTOS (modo interrupción):
+// un solo despachador para todas las estaciones
+// ----------------------
+void touch_auth_task(void *pvParameter) {
     init_touch_system(); // Inicializa todo el sistema táctil
+    uint32_t next_track = now_ms() + TOUCH_TRACK_PERIOD_MS;
 
     while(1) {
-        // Lee valores filtrados actuales de ambos pads
-        touch_pad_read_filtered(TOUCH_PAD_SEQUENCE, &touch_seq_value);
-        touch_pad_read_filtered(TOUCH_PAD_VALIDATE, &touch_val_value);
+        touch_edge_t edge;
+
+        // Duerme hasta el próximo toque, el próximo tiempo límite, la próxima
+        // muestra de seguimiento de la línea base o, con pads tocados, la
+        // próxima lectura
+        uint32_t current_time = now_ms();
+        TickType_t wait = ticks_to_deadline(current_time);
+        TickType_t track_wait = (int32_t)(next_track - current_time) > 0
+                              ? pdMS_TO_TICKS(next_track - current_time) : 0;
+        if(track_wait < wait) wait = track_wait;
+        bool scanning = pressed_pads != 0 && release_pad == TOUCH_PAD_MAX;
+        if(scanning && pdMS_TO_TICKS(TOUCH_SCAN_MS) < wait) wait = pdMS_TO_TICKS(TOUCH_SCAN_MS);
+
+        if(xQueueReceive(touch_queue, &edge, wait) == pdTRUE) {
+            handle_touch_edge(&edge);
+        } else if(scanning) {
+            scan_touch_pads();
+        }
 
-        // Tiempo actual en milisegundos desde el inicio
-        uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-
-        // ----------------------
-        // DETECCIÓN DE TOQUE EN EL PAD DE INGRESO
-        // ----------------------
-        if(touch_seq_value < baseline_seq * 0.5) {
-            // Se ha detectado un nuevo toque
-            if(!current_touch) {
-                current_touch = true;
-                touch_start_time = current_time; // Guarda cuándo comenzó el toque
-            }
-        } else {
-            // Se soltó el toque (finaliza un toque)
-            if(current_touch) {
-                current_touch = false;
-                uint32_t touch_duration = current_time - touch_start_time; // Calcula duración
-
-                if(!waiting_validation && sequence_index < 9) {
-                    // Determina tipo de toque (largo o corto)
-                    uint8_t touch_type = (touch_duration >= LONG_TOUCH_MIN) ? 1 : 0;
-                    entered_sequence[sequence_index++] = touch_type;
-
-                    ESP_LOGI(TAG, "Toque %d/%d: %s (%.1f segundos)",
-                             sequence_index, 9,
-                             touch_type ? "TOQUE LARGO" : "TOQUE CORTO",
-                             touch_duration/1000.0);
-
-                    last_touch_time = current_time;
-
-                    // Si ya se ingresaron los 9 toques
-                    if(sequence_index >= 9) {
-                        waiting_validation = true;
-                        ESP_LOGI(TAG, "\n SECUENCIA COMPLETADA");
-                        ESP_LOGI(TAG, "Toque GPIO27 (D27-Touch7) para validar la secuencia (tiene 15 segundos)");
-                    }
+        current_time = now_ms();
+        if((int32_t)(current_time - next_track) >= 0) {
+            sample_touch_pads();
+            // Con los pads sueltos, el hardware pasa a usar los umbrales actualizados
+            if(pressed_pads == 0) {
+                for(int i = 0; i < NUM_TOUCH_CHANNELS; i++) {
+                    touch_pad_set_thresh(touch_channels[i], baselines[touch_channels[i]].umbral_tocar);
                 }
             }
+            next_track = current_time + TOUCH_TRACK_PERIOD_MS;
         }
+        check_timeouts(current_time);
+    }
+}
+#else
+// ----------------------
+// Tarea principal que corre en segundo plano en FreeRTOS (modo sondeo): una
+// lectura de todos los pads atiende a todas las estaciones
+// ----------------------
+void touch_auth_task(void *pvParameter) {
+    init_touch_system(); // Inicializa todo el sistema táctil
 
-        // ----------------------
-        // PROCESO DE VALIDACIÓN
-        // ----------------------
-        if(waiting_validation) {
-            // Error: el usuario volvió a tocar el pad de ingreso en vez del de validación
-            if(touch_seq_value < baseline_seq * 0.5) {
-                ESP_LOGW(TAG, "Error: Toque el pin GPIO27 (D27-Touch7) para validar, no GPIO33 (D33-Touch8)");
-                vTaskDelay(1000 / portTICK_PERIOD_MS);
-            }
-            // Validación correcta
-            else if(touch_val_value < baseline_val * 0.5) {
-                validate_sequence();
-            }
-            // Si pasó el tiempo de espera de validación
-            else if((current_time - last_touch_time) > VALIDATION_TIMEOUT) {
-                ESP_LOGW(TAG, "Tiempo de validación agotado (15 segundos)");
-                reset_sequence();
-            }
+    while(1) {
+        // Lee valores filtrados de todos los pads y actualiza su línea base
+        verdict_ref_us = esp_timer_get_time();
+        uint32_t touched = sample_touch_pads();
+
+        // Tiempo actual en milisegundos desde el inicio
+        uint32_t current_time = now_ms();
+
+        // Toques, sueltas y validaciones de cada estación
+        dispatch_touch_pads(touched, current_time);
+
+        // Tiempo excedido (validación o entre toques)
+        check_timeouts(current_time);
+
+        hal_esperar_ms(50); // Espera 50 ms antes de revisar de nuevo (reduce carga de CPU)
+    }
+}
+#endif
+
+// ----------------------
+// Consola: atiende "!perf" con los histogramas y la CPU y pila de las tareas
+// ----------------------
+void console_task(void *pvParameter) {
+    static char report[768];
+    char line[CONSOLE_LINE_MAX + 1];
+    int length = 0;
+
+    uart_driver_install(CONSOLE_UART, 256, 0, 0, NULL, 0);
+#if MODO_BAJO_CONSUMO
+    energia_despertar_con_uart(CONSOLE_UART);
+    energia_rx_t rx = {0};                        // Despierto mientras llega un comando
+#endif
+    while(1) {
+        uint8_t byte;
+#if MODO_BAJO_CONSUMO
+        int got = hal_uart_leer(CONSOLE_UART, &byte, 1, energia_rx_espera(&rx));
+        energia_rx_leido(&energia, &rx, got > 0 ? 1 : 0, &hist_console_wake, esp_timer_get_time());
+        if(got <= 0) continue;
+#else
+        if(hal_uart_leer(CONSOLE_UART, &byte, 1, HAL_ESPERA_SIEMPRE) <= 0) continue;
+#endif
+        if(byte != '\n' && byte != '\r') {
+            if(length < CONSOLE_LINE_MAX) line[length++] = (char)byte;
+            continue;
         }
-        // ----------------------
-        // TIEMPO EXCEDIDO ENTRE TOQUES
-        // ----------------------
-        else if(sequence_index > 0 && (current_time - last_touch_time) > MAX_BETWEEN_TOUCHES) {
-            ESP_LOGW(TAG, "El tiempo entre toques se ha excedido (10 segundos)");
-            reset_sequence();
+        line[length] = '\0';
+        length = 0;
+#if MODO_BAJO_CONSUMO
+        if(strcmp(line, "!energia") == 0) {
+            size_t n = energia_texto(&energia, esp_timer_get_time(), report, sizeof(report));
+            n += instr_hist_texto(&hist_wake, report + n, sizeof(report) - n);
+            n += instr_hist_texto(&hist_console_wake, report + n, sizeof(report) - n);
+            hal_uart_escribir(CONSOLE_UART, report, n);
+            continue;
         }
-
-        vTaskDelay(50 / portTICK_PERIOD_MS); // Espera 50 ms antes de revisar de nuevo (reduce carga de CPU)
+#endif
+        if(strcmp(line, "!perf") != 0) continue;
+
+        size_t n = instr_hist_texto(&hist_edge, report, sizeof(report));
+        n += instr_hist_texto(&hist_verdict, report + n, sizeof(report) - n);
+        n += instr_hist_texto(&hist_sample, report + n, sizeof(report) - n);
+        n += instr_tareas_texto(report + n, sizeof(report) - n);
+        hal_uart_escribir(CONSOLE_UART, report, n);
     }
 }
 
@@ -239,6 +709,18 @@ void touch_auth_task(void *pvParameter) {
 // Punto de entrada del programa
 // ----------------------
 void app_main() {
+    TaskHandle_t task = NULL;
+
+#if MODO_BAJO_CONSUMO
+    esp_err_t err = energia_iniciar(&energia);
+    if(err != ESP_OK) ESP_LOGW(TAG, "Bajo consumo no disponible (%d): revise CONFIG_PM_ENABLE", err);
+#endif
+
     // Crea la tarea que manejará la lógica del sistema táctil
-    xTaskCreate(&touch_auth_task, "touch_auth_task", 4096, NULL, 5, NULL);
+    xTaskCreate(&touch_auth_task, "touch_auth_task", 4096, NULL, 5, &task);
+    instr_registrar_tarea(task);
+
+    // Consola de instrumentación (menor prioridad que la autenticación)
+    xTaskCreate(&console_task, "console_task", 3072, NULL, 2, &task);
+    instr_registrar_tarea(task);
 }
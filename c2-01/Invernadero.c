@@ -0,0 +1,205 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Objetivo:
+Controlador de invernadero: adquirir a la vez un caudalímetro de riego por
+puerto serial, tres sensores analógicos (humedad del suelo, temperatura y
+luz) y un botón táctil, cada uno a su propio período, e imprimir por serial
+las estadísticas de cada sensor y si la adquisición cumple sus plazos.
+
+Una sola tarea de adquisición (adquisicion.h) atiende todos los sensores: un
+temporizador de alta resolución (esp_timer) la despierta en el próximo plazo
+y ella ejecuta los sensores que toca. Las lecturas van a la cola de cada
+sensor y la tarea de estadísticas las procesa por lotes, como la etapa 2 del
+Ejercicio 1. El reporte muestra por sensor las estadísticas, los plazos
+perdidos y el retraso de cada turno (jitter).*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "driver/touch_pad.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define UART_RX_BUF_SIZE 1024  // Buffer del driver: guarda lo que llega entre turnos del caudalímetro
+#define REPORTE_PERIODO_MS 5000
+
+#include "canal.h"
+#include "hal.h"
+#include "instrumentacion.h"
+#include "adquisicion.h"
+
+static const char *TAG = "INVERNADERO";
+
+// ----------------------------------------------------
+// Sensores: fuente, período y escala. El caudalímetro manda líneas "00".."99"
+// por UART1 (pines 4 y 5); los analógicos van al ADC1 (GPIO 34, 35 y 32) y se
+// promedian entre turnos; el botón es el pad táctil 3 (GPIO15) y su lectura es
+// cuánto bajó respecto de la línea base (%).
+// ----------------------------------------------------
+#define CAUDAL_UART UART_NUM_1
+#define CAUDAL_TX_PIN 4
+#define CAUDAL_RX_PIN 5
+
+static adq_sensor_t sensores[] = {
+    {.nombre = "caudal",      .tipo = ADQ_UART,   .fuente = CAUDAL_UART,     .periodo_us = 100000},
+    {.nombre = "humedad",     .tipo = ADQ_ADC,    .fuente = 6,               .periodo_us = 1000000,
+     .escala_min = 0, .escala_max = 99},   // %
+    {.nombre = "temperatura", .tipo = ADQ_ADC,    .fuente = 7,               .periodo_us = 2000000,
+     .escala_min = 0, .escala_max = 50},   // °C
+    {.nombre = "luz",         .tipo = ADQ_ADC,    .fuente = 4,               .periodo_us = 500000,
+     .escala_min = 0, .escala_max = 99},   // %
+    {.nombre = "boton",       .tipo = ADQ_TACTIL, .fuente = TOUCH_PAD_NUM3,  .periodo_us = 20000},
+};
+#define NUM_SENSORES (sizeof(sensores) / sizeof(sensores[0]))
+
+// Estado de la adquisición (solo lo toca su tarea; el reporte lee contadores)
+static adq_planificador_t planificador;
+static esp_timer_handle_t temporizador = NULL;
+
+static TaskHandle_t adq_handle = NULL;
+static TaskHandle_t stats_handle = NULL;
+
+static telemetry_t snapshot;
+static char texto[1024];       // Reporte de adq_texto (solo la tarea de estadísticas)
+
+// ----------------------------------------------------
+// Configura el UART del caudalímetro (115200 baudios, 8N1)
+// ----------------------------------------------------
+static void init_uart(void) {
+    uart_config_t uart_config = {
+        .baud_rate = 115200,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+    };
+
+    uart_param_config(CAUDAL_UART, &uart_config);
+    uart_set_pin(CAUDAL_UART, CAUDAL_TX_PIN, CAUDAL_RX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    uart_driver_install(CAUDAL_UART, UART_RX_BUF_SIZE, 0, 0, NULL, 0);
+}
+
+// ----------------------------------------------------
+// Pads táctiles con filtro (hal_touch_leer_filtrado)
+// ----------------------------------------------------
+static void init_touch(void) {
+    touch_pad_init();
+    touch_pad_set_fsm_mode(TOUCH_FSM_MODE_TIMER);
+    touch_pad_set_voltage(TOUCH_HVOLT_2V7, TOUCH_LVOLT_0V5, TOUCH_HVOLT_ATTEN_1V);
+    for (size_t i = 0; i < NUM_SENSORES; i++) {
+        if (sensores[i].tipo == ADQ_TACTIL) touch_pad_config(sensores[i].fuente, 0);
+    }
+    touch_pad_filter_start(10);
+}
+
+// ----------------------------------------------------
+// El temporizador vence en el próximo plazo: despierta a la tarea de
+// adquisición (corre en la tarea de esp_timer, no en una interrupción)
+// ----------------------------------------------------
+static void al_vencer(void *arg) {
+    xTaskNotifyGive(adq_handle);
+}
+
+// ----------------------------------------------------
+// Tarea de adquisición: en cada despertar ejecuta los sensores cuyo plazo
+// llegó y programa el temporizador para el siguiente. Con un temporizador en
+// microsegundos los plazos no quedan atados al tick de FreeRTOS (1 ms).
+// ----------------------------------------------------
+static void adq_task(void *arg) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        int encoladas = 0;
+        int64_t proximo = adq_ejecutar(&planificador, &encoladas);
+        if (encoladas > 0) xTaskNotifyGive(stats_handle);
+
+        int64_t espera = proximo - esp_timer_get_time();
+        esp_timer_start_once(temporizador, espera > 0 ? (uint64_t)espera : 1);
+    }
+}
+
+// ----------------------------------------------------
+// Imprime último, mínimo, máximo y promedio de un sensor
+// ----------------------------------------------------
+static void print_summary(const char *nombre, const estadisticas_t *st) {
+    if (st->cuenta == 0) {
+        printf("%-12s sin lecturas\n", nombre);
+        return;
+    }
+
+    uint32_t promedio = estadisticas_promedio_x100(st);
+    printf("%-12s n=%llu último=%u mínimo=%u máximo=%u promedio=%lu.%02lu\n", nombre,
+           (unsigned long long)st->cuenta, st->ultimo, st->min, st->max,
+           (unsigned long)(promedio / 100), (unsigned long)(promedio % 100));
+}
+
+// ----------------------------------------------------
+// Tarea de estadísticas: saca las lecturas de las colas por lotes cuando la
+// adquisición avisa y cada REPORTE_PERIODO_MS imprime el resumen
+// ----------------------------------------------------
+static void stats_task(void *arg) {
+    uint32_t ultimo_reporte = hal_ms();
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(REPORTE_PERIODO_MS));
+
+        uint32_t ahora_ms = hal_ms();
+        for (size_t i = 0; i < NUM_SENSORES; i++) {
+            canal_drenar(&sensores[i].canal, ahora_ms);
+        }
+        if (ahora_ms - ultimo_reporte < REPORTE_PERIODO_MS) continue;
+        ultimo_reporte = ahora_ms;
+
+        printf("\n--- Invernadero (%lu s) ---\n", (unsigned long)(ahora_ms / 1000));
+        for (size_t i = 0; i < NUM_SENSORES; i++) {
+            canal_instantanea(&sensores[i].canal, &snapshot);
+            print_summary(sensores[i].nombre, &snapshot.stats);
+            if (sensores[i].tipo == ADQ_UART) {
+                printf("%-12s errores: longitud=%lu no_digito=%lu rango=%lu\n", sensores[i].nombre,
+                       (unsigned long)snapshot.err_longitud, (unsigned long)snapshot.err_no_digito,
+                       (unsigned long)snapshot.err_rango);
+            }
+        }
+        adq_texto(&planificador, texto, sizeof(texto));
+        fputs(texto, stdout);
+    }
+}
+
+// ----------------------------------------------------
+// Función principal del programa (punto de entrada)
+// ----------------------------------------------------
+void app_main() {
+    init_uart();
+    init_touch();
+
+    adq_init(&planificador);
+    int64_t inicio = esp_timer_get_time() + 10000;
+    for (size_t i = 0; i < NUM_SENSORES; i++) {
+        adq_agregar(&planificador, &sensores[i], inicio);
+    }
+    esp_err_t err = adq_adc_iniciar(&planificador);
+    if (err != ESP_OK) ESP_LOGE(TAG, "ADC continuo no disponible (%d)", err);
+
+    printf("\n=== Invernadero ===\n");
+    for (size_t i = 0; i < NUM_SENSORES; i++) {
+        printf("%-12s cada %lu ms\n", sensores[i].nombre, (unsigned long)(sensores[i].periodo_us / 1000));
+    }
+    printf("Resumen cada %d ms\n\n", REPORTE_PERIODO_MS);
+
+    xTaskCreate(stats_task, "stats", 4096, NULL, 5, &stats_handle);
+    instr_registrar_tarea(stats_handle);
+
+    // La adquisición va sobre todo lo demás para que el retraso mida solo la fuente
+    xTaskCreate(adq_task, "adq", 4096, NULL, configMAX_PRIORITIES - 2, &adq_handle);
+    instr_registrar_tarea(adq_handle);
+
+    esp_timer_create_args_t args = {.callback = al_vencer, .name = "adq"};
+    esp_timer_create(&args, &temporizador);
+    esp_timer_start_once(temporizador, 10000);
+}
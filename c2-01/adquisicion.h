@@ -0,0 +1,375 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Planificador de adquisición para varios sensores heterogéneos (invernadero):
+caudalímetros por UART, canales del ADC (humedad, temperatura, luz) y pads
+táctiles, cada uno a su propio período, desde una sola tarea que despierta
+un temporizador en el próximo plazo.
+
+- Cada sensor es un canal de canal.h: sus lecturas (0-99 en las unidades del
+  sensor) van a la cola SPSC del canal y quien procesa las saca con
+  canal_drenar hacia las estadísticas, igual que los caudalímetros del
+  Ejercicio 1. El UART además usa la ingesta y la validación del canal.
+- ADC: un solo flujo continuo por DMA (adc_continuous) recorre todos los
+  canales a ADQ_ADC_FRECUENCIA_HZ. El planificador drena el DMA cada
+  ADQ_ADC_DRENAR_US y acumula suma y cuenta por canal; cada sensor del ADC
+  toma en su turno el promedio de lo acumulado (sobremuestreo: menos ruido) y
+  lo escala a sus unidades.
+- Táctil: lectura filtrada del pad, con la línea base de linea_base.h; la
+  lectura es cuánto bajó el valor respecto de la base, en %.
+- Plazos absolutos (sin deriva): el plazo siguiente es el anterior más el
+  período. Por sensor se cuentan las ejecuciones, los plazos perdidos
+  (períodos enteros que se saltaron por llegar tarde) y el retraso de cada
+  inicio respecto de su plazo en un histograma (instrumentacion.h).
+
+Todo el estado del planificador lo toca solo su tarea; los contadores tienen
+un solo escritor y se leen para el reporte (adq_texto).
+
+No depende de ESP-IDF salvo el ADC por DMA; en el computador el reloj y las
+fuentes son los de hal.h y las muestras del ADC las pone quien lo usa
+(bench/).*/
+
+#ifndef ADQUISICION_H
+#define ADQUISICION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "canal.h"
+#include "hal.h"
+#include "instrumentacion.h"
+#include "linea_base.h"
+
+#define ADQ_MAX_SENSORES 8
+#define ADQ_ADC_CANALES 8          // ADC1 del ESP32: canales 0-7 (GPIO 36, 37, 38, 39, 32, 33, 34, 35)
+#define ADQ_ADC_BITS 12
+#define ADQ_ADC_FONDO ((1 << ADQ_ADC_BITS) - 1)
+
+#ifndef ADQ_ADC_FRECUENCIA_HZ
+#define ADQ_ADC_FRECUENCIA_HZ 20000   // Conversiones por segundo entre todos los canales (mínimo del ESP32)
+#endif
+#ifndef ADQ_ADC_DRENAR_US
+#define ADQ_ADC_DRENAR_US 50000       // El buffer del driver guarda ~100 ms a 20 kHz
+#endif
+#define ADQ_ADC_BUFFER 4096           // Bytes del buffer del driver (2 bytes por conversión)
+#define ADQ_ADC_TRAMA 256             // Bytes por trama de DMA
+
+typedef enum {
+    ADQ_UART,                  // Caudalímetro: líneas de texto validadas por canal.h
+    ADQ_ADC,                   // Canal del ADC1, promediado entre turnos
+    ADQ_TACTIL,                // Pad táctil: % que bajó respecto de la línea base
+} adq_tipo_t;
+
+typedef struct {
+    const char *nombre;
+    adq_tipo_t tipo;
+    int fuente;                // Puerto UART, canal del ADC1 o número de pad
+    uint32_t periodo_us;
+    int16_t escala_min;        // ADC: unidades en 0 y en el fondo de escala
+    int16_t escala_max;
+
+    canal_t canal;             // Cola de lecturas, estadísticas y errores
+    linea_base_t base;         // Solo táctil
+
+    // Planificación: solo la tarea de adquisición
+    int64_t proximo_us;        // Plazo del próximo turno
+    uint32_t ejecuciones;
+    uint32_t vencidos;         // Plazos perdidos (turnos que no se ejecutaron)
+    uint32_t vacios;           // Turnos sin lectura (ADC sin muestras, pad calibrando)
+    instr_hist_t retraso;      // Inicio del turno - plazo (us)
+} adq_sensor_t;
+
+// ----------------------------------------------------
+// Acumuladores del ADC por canal, entre turnos de cada sensor
+// ----------------------------------------------------
+typedef struct {
+    uint32_t suma[ADQ_ADC_CANALES];
+    uint32_t cuenta[ADQ_ADC_CANALES];
+    uint32_t muestras;         // Conversiones recibidas
+    uint32_t desbordes;        // El DMA llenó el buffer del driver (lo escribe el aviso del driver)
+#ifdef ESP_PLATFORM
+    void *manejador;           // adc_continuous_handle_t
+#endif
+} adq_adc_t;
+
+typedef struct {
+    adq_sensor_t *sensores[ADQ_MAX_SENSORES];
+    int n;
+    adq_adc_t adc;
+    bool con_adc;
+    int64_t adc_proximo_us;
+    uint32_t rondas;           // Veces que despertó la tarea
+    instr_hist_t ronda;        // Duración de cada ronda (ciclos)
+} adq_planificador_t;
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+static inline int64_t adq_ahora_us(void) {
+    return esp_timer_get_time();
+}
+#else
+static inline int64_t adq_ahora_us(void) {
+    return (int64_t)hal_us();
+}
+#endif
+
+static inline void adq_init(adq_planificador_t *p) {
+    memset(p, 0, sizeof(*p));
+    p->ronda = (instr_hist_t)INSTR_HIST("ronda");
+}
+
+// ----------------------------------------------------
+// Agrega un sensor (memoria del que llama) con su primer plazo en 'inicio_us'.
+// Devuelve false si ya no caben más.
+// ----------------------------------------------------
+static inline bool adq_agregar(adq_planificador_t *p, adq_sensor_t *s, int64_t inicio_us) {
+    if (p->n >= ADQ_MAX_SENSORES || s->periodo_us == 0) return false;
+
+    canal_init(&s->canal, p->n);
+    s->proximo_us = inicio_us;
+    s->ejecuciones = s->vencidos = s->vacios = 0;
+    s->retraso = (instr_hist_t)INSTR_HIST(s->nombre);
+    if (s->tipo == ADQ_TACTIL) {
+        linea_base_init(&s->base, LINEA_BASE_TOCAR_256, LINEA_BASE_SOLTAR_256, LINEA_BASE_DESPLAZAMIENTO, 0);
+        linea_base_calibrar(&s->base, 16);
+    }
+    if (s->tipo == ADQ_ADC) {
+        p->con_adc = true;
+        p->adc_proximo_us = inicio_us;
+    }
+    p->sensores[p->n++] = s;
+    return true;
+}
+
+// ----------------------------------------------------
+// ADC: suma una conversión del canal 'canal' (la llama el drenado del DMA o,
+// en el computador, quien simula las muestras)
+// ----------------------------------------------------
+static inline void adq_adc_acumular(adq_adc_t *a, unsigned canal, uint16_t crudo) {
+    if (canal >= ADQ_ADC_CANALES) return;
+    a->suma[canal] += crudo;
+    a->cuenta[canal]++;
+    a->muestras++;
+}
+
+// Valor crudo del ADC a las unidades del sensor, acotado a MIN_NUM..MAX_NUM
+static inline uint8_t adq_escalar(const adq_sensor_t *s, uint32_t crudo) {
+    int32_t rango = s->escala_max - s->escala_min;
+    int32_t v = s->escala_min + ((int32_t)crudo * rango + ADQ_ADC_FONDO / 2) / ADQ_ADC_FONDO;
+    if (v < MIN_NUM) v = MIN_NUM;
+    if (v > MAX_NUM) v = MAX_NUM;
+    return (uint8_t)v;
+}
+
+#ifdef ESP_PLATFORM
+
+#include "esp_attr.h"
+#include "esp_adc/adc_continuous.h"
+
+// Aviso del driver (ISR): el DMA no encontró espacio y perdió conversiones
+static IRAM_ATTR bool adq_adc_desborde(adc_continuous_handle_t h, const adc_continuous_evt_data_t *d, void *arg) {
+    adq_adc_t *a = (adq_adc_t *)arg;
+    __atomic_store_n(&a->desbordes, a->desbordes + 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+// ----------------------------------------------------
+// Configura el ADC1 en modo continuo (DMA) con los canales de los sensores
+// ADQ_ADC ya agregados y lo arranca
+// ----------------------------------------------------
+static inline esp_err_t adq_adc_iniciar(adq_planificador_t *p) {
+    adc_digi_pattern_config_t patron[ADQ_ADC_CANALES];
+    uint32_t n = 0;
+    for (int i = 0; i < p->n; i++) {
+        const adq_sensor_t *s = p->sensores[i];
+        if (s->tipo != ADQ_ADC || n >= ADQ_ADC_CANALES) continue;
+        patron[n++] = (adc_digi_pattern_config_t){
+            .atten = ADC_ATTEN_DB_12,          // Hasta ~3.1 V
+            .channel = (uint8_t)s->fuente,
+            .unit = ADC_UNIT_1,
+            .bit_width = ADQ_ADC_BITS,
+        };
+    }
+    if (n == 0) return ESP_OK;
+
+    adc_continuous_handle_cfg_t buffer = {
+        .max_store_buf_size = ADQ_ADC_BUFFER,
+        .conv_frame_size = ADQ_ADC_TRAMA,
+    };
+    adc_continuous_handle_t h;
+    esp_err_t err = adc_continuous_new_handle(&buffer, &h);
+    if (err != ESP_OK) return err;
+
+    adc_continuous_config_t config = {
+        .pattern_num = n,
+        .adc_pattern = patron,
+        .sample_freq_hz = ADQ_ADC_FRECUENCIA_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+    };
+    if ((err = adc_continuous_config(h, &config)) != ESP_OK) return err;
+
+    adc_continuous_evt_cbs_t avisos = {.on_pool_ovf = adq_adc_desborde};
+    if ((err = adc_continuous_register_event_callbacks(h, &avisos, &p->adc)) != ESP_OK) return err;
+
+    p->adc.manejador = h;
+    return adc_continuous_start(h);
+}
+
+// ----------------------------------------------------
+// Saca del driver todas las conversiones listas (sin esperar) y las acumula
+// ----------------------------------------------------
+static inline void adq_adc_drenar(adq_adc_t *a) {
+    static uint8_t trama[ADQ_ADC_TRAMA];   // Fuera de la pila de la tarea
+    uint32_t leidos = 0;
+
+    if (a->manejador == NULL) return;
+    while (adc_continuous_read(a->manejador, trama, sizeof(trama), &leidos, 0) == ESP_OK) {
+        for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= leidos; i += SOC_ADC_DIGI_RESULT_BYTES) {
+            const adc_digi_output_data_t *r = (const adc_digi_output_data_t *)&trama[i];
+            adq_adc_acumular(a, r->type1.channel, r->type1.data);
+        }
+    }
+}
+
+#else // Computador: las muestras las agrega quien simula el ADC
+
+static inline void adq_adc_drenar(adq_adc_t *a) {
+    (void)a;
+}
+
+#endif // ESP_PLATFORM
+
+// ----------------------------------------------------
+// Un turno de un sensor: lee la fuente y encola sus lecturas. Devuelve
+// cuántas encoló.
+// ----------------------------------------------------
+static inline int adq_muestrear(adq_planificador_t *p, adq_sensor_t *s) {
+    switch (s->tipo) {
+    case ADQ_UART: {
+        // Lo que el driver ya tenga, sin esperar
+        int encoladas = 0;
+        size_t pendientes;
+        while ((pendientes = hal_uart_pendientes(s->fuente)) > 0) {
+            uint8_t *destino;
+            size_t espacio = ingesta_espacio(&s->canal.ingesta, &destino);
+            if (pendientes > espacio) pendientes = espacio;
+            int n = hal_uart_leer(s->fuente, destino, pendientes, 0);
+            if (n <= 0) break;
+            ingesta_confirmar(&s->canal.ingesta, (size_t)n);
+            encoladas += canal_encolar_lineas(&s->canal);
+        }
+        return encoladas;
+    }
+
+    case ADQ_ADC: {
+        uint32_t cuenta = p->adc.cuenta[s->fuente];
+        if (cuenta == 0) return 0;
+        uint32_t promedio = (p->adc.suma[s->fuente] + cuenta / 2) / cuenta;
+        p->adc.suma[s->fuente] = 0;
+        p->adc.cuenta[s->fuente] = 0;
+        return spsc_push(&s->canal.cola, adq_escalar(s, promedio)) ? 1 : 0;
+    }
+
+    case ADQ_TACTIL: {
+        uint16_t valor;
+        hal_touch_leer_filtrado(s->fuente, &valor);
+        bool calibrando = linea_base_calibrando(&s->base);
+        linea_base_muestra(&s->base, valor);
+        uint16_t base = linea_base_valor(&s->base);
+        if (calibrando || base == 0) return 0;
+        uint32_t baja = valor < base ? (uint32_t)(base - valor) * 100 / base : 0;
+        if (baja > MAX_NUM) baja = MAX_NUM;
+        return spsc_push(&s->canal.cola, (uint8_t)baja) ? 1 : 0;
+    }
+    }
+    return 0;
+}
+
+// ----------------------------------------------------
+// Una ronda: drena el DMA si toca y ejecuta los sensores cuyo plazo ya
+// llegó. Un sensor que llega tarde un período o más pierde esos turnos (se
+// cuentan) y sigue en la grilla de plazos original. Devuelve el próximo
+// plazo de cualquier sensor, para programar el temporizador. 'encoladas'
+// (opcional) suma las lecturas encoladas.
+// ----------------------------------------------------
+static inline int64_t adq_ejecutar(adq_planificador_t *p, int *encoladas) {
+    uint32_t marca = instr_marca();
+    int64_t ahora = adq_ahora_us();
+    int total = 0;
+    p->rondas++;
+
+    if (p->con_adc && ahora >= p->adc_proximo_us) {
+        adq_adc_drenar(&p->adc);
+        p->adc_proximo_us += ADQ_ADC_DRENAR_US *
+                             ((ahora - p->adc_proximo_us) / ADQ_ADC_DRENAR_US + 1);
+    }
+
+    for (int i = 0; i < p->n; i++) {
+        adq_sensor_t *s = p->sensores[i];
+        if (ahora < s->proximo_us) continue;
+
+        int64_t retraso = adq_ahora_us() - s->proximo_us;
+        uint32_t perdidos = (uint32_t)(retraso / s->periodo_us);
+        if (perdidos > 0) {
+            __atomic_store_n(&s->vencidos, s->vencidos + perdidos, __ATOMIC_RELAXED);
+            s->proximo_us += (int64_t)perdidos * s->periodo_us;
+            retraso -= (int64_t)perdidos * s->periodo_us;
+        }
+        instr_registrar_us(&s->retraso, retraso);
+
+        int n = adq_muestrear(p, s);
+        if (n == 0) __atomic_store_n(&s->vacios, s->vacios + 1, __ATOMIC_RELAXED);
+        total += n;
+        __atomic_store_n(&s->ejecuciones, s->ejecuciones + 1, __ATOMIC_RELAXED);
+        s->proximo_us += s->periodo_us;
+    }
+
+    int64_t proximo = p->con_adc ? p->adc_proximo_us : INT64_MAX;
+    for (int i = 0; i < p->n; i++) {
+        if (p->sensores[i]->proximo_us < proximo) proximo = p->sensores[i]->proximo_us;
+    }
+
+    instr_desde(&p->ronda, marca);
+    if (encoladas != NULL) *encoladas = total;
+    return proximo;
+}
+
+// ----------------------------------------------------
+// Una línea por sensor: "adq nombre periodo=.. ms ejec=.. vencidos=..
+// vacios=.. retraso p50/p99/max=.. us cola_max=.. descartadas=..".
+// Devuelve los bytes escritos (sin pasar de 'capacidad').
+// ----------------------------------------------------
+static inline size_t adq_texto(const adq_planificador_t *p, char *destino, size_t capacidad) {
+    size_t escritos = 0;
+    for (int i = 0; i < p->n && escritos + 1 < capacidad; i++) {
+        const adq_sensor_t *s = p->sensores[i];
+        unsigned long p50 = INSTR_US_X10(instr_percentil(&s->retraso, 50));
+        unsigned long p99 = INSTR_US_X10(instr_percentil(&s->retraso, 99));
+        unsigned long max = INSTR_US_X10(__atomic_load_n(&s->retraso.max, __ATOMIC_RELAXED));
+        int m = snprintf(destino + escritos, capacidad - escritos,
+                         "adq %s periodo=%lu ms ejec=%lu vencidos=%lu vacios=%lu "
+                         "retraso p50=%lu.%lu p99=%lu.%lu max=%lu.%lu us cola_max=%lu descartadas=%lu\n",
+                         s->nombre, (unsigned long)(s->periodo_us / 1000),
+                         (unsigned long)__atomic_load_n(&s->ejecuciones, __ATOMIC_RELAXED),
+                         (unsigned long)__atomic_load_n(&s->vencidos, __ATOMIC_RELAXED),
+                         (unsigned long)__atomic_load_n(&s->vacios, __ATOMIC_RELAXED),
+                         p50 / 10, p50 % 10, p99 / 10, p99 % 10, max / 10, max % 10,
+                         (unsigned long)__atomic_load_n(&s->canal.cola.max_ocupacion, __ATOMIC_RELAXED),
+                         (unsigned long)__atomic_load_n(&s->canal.cola.descartados, __ATOMIC_RELAXED));
+        if (m < 0) break;
+        escritos += (size_t)m < capacidad - escritos ? (size_t)m : capacidad - escritos - 1;
+    }
+    if (escritos + 1 < capacidad) {
+        int m = snprintf(destino + escritos, capacidad - escritos, "adc muestras=%lu desbordes=%lu\n",
+                         (unsigned long)p->adc.muestras,
+                         (unsigned long)__atomic_load_n(&p->adc.desbordes, __ATOMIC_RELAXED));
+        if (m > 0) escritos += (size_t)m < capacidad - escritos ? (size_t)m : capacidad - escritos - 1;
+    }
+    return escritos;
+}
+
+#endif // ADQUISICION_H
@@ -0,0 +1,161 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Benchmark del planificador de adquisición (adquisicion.h) con el reloj
+virtual de hal.h: los sensores del invernadero (caudalímetro por UART a 9600
+baudios, tres canales del ADC y un pad táctil) durante DURACION_US.
+
+Mide:
+  plazos     Cada ronda empieza en su plazo más un retraso aleatorio menor a
+             RETRASO_MAX_US. Cada sensor debe ejecutarse exactamente
+             DURACION_US / período veces, sin plazos perdidos; el caudalímetro
+             debe entregar todas las líneas (cuenta y suma), los canales del
+             ADC el valor escalado de lo que se les inyectó y el pad cuánto
+             bajó en el toque. Reporta el retraso p50/p99 por sensor y los ns
+             por ronda del planificador (tiempo real del computador).
+  picos      Igual, pero PICOS rondas se atrasan PICO_US (la tarea no corrió
+             a tiempo): cada sensor debe contar exactamente PICOS * (PICO_US /
+             período) plazos perdidos y ejecutarse en el resto. El turno del
+             caudalímetro tras un pico trae más líneas de las que caben en la
+             cola: las que sobran se descartan y se cuentan.
+
+Cada resultado es una línea JSON (reportar() en bench_comun.h). Devuelve 1 si
+alguna verificación falla.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_adquisicion bench_adquisicion.c
+  ./bench_adquisicion*/
+
+#include "bench_comun.h"
+#include "hal.h"
+#include "canal.h"
+#include "adquisicion.h"
+
+#define DURACION_US 60000000ull        // 60 s de adquisición
+#define RETRASO_MAX_US 200             // Retraso normal de una ronda
+#define PICO_US 1050000                // Atraso de una ronda con pico
+#define PICO_CADA_US 10000000ull       // Un pico cada 10 s (en un plazo común a todos)
+#define PICOS 5
+
+#define BAUDIOS 9600
+#define LINEAS 15000                   // 3 bytes por línea: ~47 s a 9600 baudios
+#define PAD_BOTON 3
+#define PAD_REPOSO 1000
+#define PAD_TOCADO 600                 // 40 % menos que la base
+
+static adq_sensor_t sensores[] = {
+    {.nombre = "caudal",      .tipo = ADQ_UART,   .fuente = 0,         .periodo_us = 100000},
+    {.nombre = "humedad",     .tipo = ADQ_ADC,    .fuente = 6,         .periodo_us = 1000000,
+     .escala_min = 0, .escala_max = 99},
+    {.nombre = "temperatura", .tipo = ADQ_ADC,    .fuente = 7,         .periodo_us = 2000000,
+     .escala_min = 0, .escala_max = 50},
+    {.nombre = "luz",         .tipo = ADQ_ADC,    .fuente = 4,         .periodo_us = 500000,
+     .escala_min = 0, .escala_max = 99},
+    {.nombre = "boton",       .tipo = ADQ_TACTIL, .fuente = PAD_BOTON, .periodo_us = 20000},
+};
+#define NUM_SENSORES (sizeof(sensores) / sizeof(sensores[0]))
+
+// Valor crudo constante que el "ADC" entrega en cada canal
+static const uint16_t adc_crudo[ADQ_ADC_CANALES] = {0, 0, 0, 0, 3000, 0, 2048, 1365};
+static const uint8_t canales_adc[] = {6, 7, 4};
+
+// Un toque de 300 ms en el segundo 5
+static const hal_punto_touch_t toques[] = {
+    {5000000, PAD_BOTON, PAD_TOCADO},
+    {5300000, PAD_BOTON, PAD_REPOSO},
+};
+
+// Conversiones que el DMA habría entregado entre 'desde' y 'hasta', en orden de patrón
+static void inyectar_adc(adq_adc_t *a, uint64_t desde, uint64_t hasta, uint64_t *fase) {
+    uint64_t n = (hasta - desde) * ADQ_ADC_FRECUENCIA_HZ / 1000000;
+    for (uint64_t i = 0; i < n; i++, (*fase)++) {
+        uint8_t canal = canales_adc[*fase % sizeof(canales_adc)];
+        adq_adc_acumular(a, canal, adc_crudo[canal]);
+    }
+}
+
+static void correr(bool con_picos, const char *caso) {
+    static adq_planificador_t p;
+    char *flujo = malloc(LINEAS * 3 + 1);
+    uint64_t suma = 0;
+    uint32_t semilla = 11;
+
+    for (int k = 0; k < LINEAS; k++) {
+        unsigned valor = aleatorio(&semilla) % 100;
+        sprintf(flujo + 3 * k, "%02u\n", valor);
+        suma += valor;
+    }
+
+    hal_linux_reiniciar();
+    hal_linux_guion_uart(0, (const uint8_t *)flujo, LINEAS * 3, BAUDIOS);
+    hal_linux_guion_touch(toques, sizeof(toques) / sizeof(toques[0]), PAD_REPOSO);
+
+    adq_init(&p);
+    for (size_t i = 0; i < NUM_SENSORES; i++) adq_agregar(&p, &sensores[i], 0);
+
+    // Bucle de la tarea: dormir hasta el próximo plazo (más el retraso) y ejecutar
+    uint64_t anterior = 0, fase = 0, ns = 0;
+    int64_t proximo = 0;
+    while ((uint64_t)proximo < DURACION_US) {
+        uint64_t inicio = (uint64_t)proximo + aleatorio(&semilla) % RETRASO_MAX_US;
+        if (con_picos && proximo > 0 && (uint64_t)proximo % PICO_CADA_US == 0 &&
+            (uint64_t)proximo / PICO_CADA_US <= PICOS) {
+            inicio += PICO_US;
+        }
+        hal_linux.reloj_us = inicio;
+        inyectar_adc(&p.adc, anterior, inicio, &fase);
+        anterior = inicio;
+
+        uint64_t t0 = tiempo_ns();
+        proximo = adq_ejecutar(&p, NULL);
+        ns += tiempo_ns() - t0;
+
+        for (size_t i = 0; i < NUM_SENSORES; i++) canal_drenar(&sensores[i].canal, hal_ms());
+    }
+
+    reportar(caso, "planificador", "ns_por_ronda", (double)ns / p.rondas, "ns");
+    reportar(caso, "planificador", "rondas", (double)p.rondas, "rondas");
+
+    for (size_t i = 0; i < NUM_SENSORES; i++) {
+        const adq_sensor_t *s = &sensores[i];
+        const estadisticas_t *st = &s->canal.telemetry.stats;
+        uint32_t plazos = (uint32_t)(DURACION_US / s->periodo_us);
+        uint32_t perdidos = con_picos ? PICOS * (PICO_US / s->periodo_us) : 0;
+
+        reportar(caso, s->nombre, "ejecuciones", s->ejecuciones, "turnos");
+        reportar(caso, s->nombre, "vencidos", s->vencidos, "turnos");
+        reportar(caso, s->nombre, "retraso_p50", instr_percentil(&s->retraso, 50) / (double)INSTR_MHZ, "us");
+        reportar(caso, s->nombre, "retraso_p99", instr_percentil(&s->retraso, 99) / (double)INSTR_MHZ, "us");
+        verificar(s->vencidos == perdidos, "plazos: perdidos exactos");
+        verificar(s->ejecuciones + s->vencidos == plazos, "plazos: un turno por plazo");
+
+        switch (s->tipo) {
+        case ADQ_UART:
+            // Tras un pico llegan de una vez más líneas de las que caben en la cola: las que
+            // no caben se descartan y se cuentan
+            reportar(caso, s->nombre, "descartadas", s->canal.cola.descartados, "lecturas");
+            verificar(st->cuenta + s->canal.cola.descartados == LINEAS, "uart: cada línea aceptada o contada");
+            if (!con_picos) verificar(st->cuenta == LINEAS && st->suma == suma, "uart: todas las líneas, suma exacta");
+            break;
+        case ADQ_ADC: {
+            uint8_t esperado = (uint8_t)(adc_crudo[s->fuente] * (double)s->escala_max / ADQ_ADC_FONDO + 0.5);
+            verificar(st->cuenta == s->ejecuciones - s->vacios && s->vacios <= 1, "adc: una lectura por turno");
+            verificar(st->min == esperado && st->max == esperado, "adc: valor escalado");
+            break;
+        }
+        case ADQ_TACTIL:
+            verificar(st->cuenta == s->ejecuciones - 16, "tactil: una lectura por turno tras calibrar");
+            verificar(st->max == 100 * (PAD_REPOSO - PAD_TOCADO) / PAD_REPOSO, "tactil: caída en el toque");
+            break;
+        }
+    }
+    free(flujo);
+}
+
+int main(void) {
+    correr(false, "plazos");
+    correr(true, "picos");
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Benchmark de escalamiento por canales (canal.h) en el computador.
+Cada canal corre en su propio hilo (como los lectores fijos a núcleo del
+ESP32) y procesa un flujo sintético por bloques: ingesta, validación y
+estadísticas. Un hilo agregador copia y suma las instantáneas todo el tiempo,
+igual que la tarea de reporte, para comprobar que no frena a los lectores.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_canales bench_canales.c -lpthread
+  ./bench_canales*/
+
+#include "bench_comun.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include "canal.h"
+
+#define MAX_CANALES 3
+#define LINEAS_POR_CANAL 2000000
+#define BLOQUE_MAX 256         // Tamaño máximo de cada lectura simulada
+
+typedef struct {
+    canal_t canal;
+    const uint8_t *datos;
+    size_t largo;
+} trabajo_t;
+
+static trabajo_t trabajos[MAX_CANALES];
+static volatile bool terminado;
+static uint64_t agregaciones;
+
+// ----------------------------------------------------
+// Lector de un canal: copia bloques de tamaño variable al anillo y procesa
+// ----------------------------------------------------
+static void *lector(void *arg) {
+    trabajo_t *t = arg;
+    uint32_t semilla = 1234 + (uint32_t)t->canal.id;
+    size_t pos = 0;
+    uint32_t ahora_ms = 0;
+
+    while (pos < t->largo) {
+        uint8_t *destino;
+        size_t espacio = ingesta_espacio(&t->canal.ingesta, &destino);
+        size_t n = 1 + aleatorio(&semilla) % BLOQUE_MAX;
+        if (n > espacio) n = espacio;
+        if (n > t->largo - pos) n = t->largo - pos;
+
+        memcpy(destino, t->datos + pos, n);
+        pos += n;
+        ingesta_confirmar(&t->canal.ingesta, n);
+        canal_procesar_lineas(&t->canal, ahora_ms++);
+    }
+    return NULL;
+}
+
+// ----------------------------------------------------
+// Agregador: suma las instantáneas de todos los canales sin parar
+// ----------------------------------------------------
+static void *agregador(void *arg) {
+    int canales = *(int *)arg;
+    static telemetry_t copia, total;
+
+    while (!terminado) {
+        memset(&total, 0, sizeof(total));
+        estadisticas_init(&total.stats);
+        for (int i = 0; i < canales; i++) {
+            canal_instantanea(&trabajos[i].canal, &copia);
+            telemetry_fusionar(&total, &copia);
+        }
+        agregaciones++;
+    }
+    return NULL;
+}
+
+int main(void) {
+    size_t largo;
+    uint8_t *datos[MAX_CANALES];
+    for (int i = 0; i < MAX_CANALES; i++) {
+        datos[i] = generar_flujo_caudal(LINEAS_POR_CANAL, 100 + i, &largo);
+    }
+
+    double base = 0;
+    printf("Lineas por canal: %d\n", LINEAS_POR_CANAL);
+
+    for (int canales = 1; canales <= MAX_CANALES; canales++) {
+        pthread_t hilos[MAX_CANALES], hilo_agregador;
+        for (int i = 0; i < canales; i++) {
+            canal_init(&trabajos[i].canal, i);
+            trabajos[i].datos = datos[i];
+            trabajos[i].largo = largo;
+        }
+
+        terminado = false;
+        agregaciones = 0;
+        pthread_create(&hilo_agregador, NULL, agregador, &canales);
+
+        uint64_t inicio = tiempo_ns();
+        for (int i = 0; i < canales; i++) pthread_create(&hilos[i], NULL, lector, &trabajos[i]);
+        for (int i = 0; i < canales; i++) pthread_join(hilos[i], NULL);
+        double seg = (tiempo_ns() - inicio) / 1e9;
+
+        terminado = true;
+        pthread_join(hilo_agregador, NULL);
+
+        uint64_t lineas = 0, validas = 0;
+        for (int i = 0; i < canales; i++) {
+            lineas += trabajos[i].canal.ingesta.lineas;
+            validas += trabajos[i].canal.telemetry.stats.cuenta;
+        }
+
+        double tasa = lineas / seg;
+        if (canales == 1) base = tasa;
+        printf("canales=%d  %12.0f lineas/s  escala=%.2fx  validas=%llu  agregaciones=%llu\n",
+               canales, tasa, tasa / base, (unsigned long long)validas,
+               (unsigned long long)agregaciones);
+    }
+
+    for (int i = 0; i < MAX_CANALES; i++) free(datos[i]);
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Utilidades comunes para los benchmarks que corren en el computador:
+medición de tiempo, generación de flujos sintéticos, verificaciones y
+reporte de resultados.*/
+
+#ifndef BENCH_COMUN_H
+#define BENCH_COMUN_H
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+static int fallas = 0;          // Verificaciones fallidas: main devuelve 1 si hay alguna
+
+// ----------------------------------------------------
+// Cuenta y avisa por stderr si 'condicion' no se cumple
+// ----------------------------------------------------
+static inline void verificar(bool condicion, const char *que) {
+    if (!condicion) {
+        fprintf(stderr, "FALLÓ: %s\n", que);
+        fallas++;
+    }
+}
+
+// ----------------------------------------------------
+// Tiempo monotónico en nanosegundos
+// ----------------------------------------------------
+static inline uint64_t tiempo_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// ----------------------------------------------------
+// Generador pseudoaleatorio (xorshift32) para flujos reproducibles
+// ----------------------------------------------------
+static inline uint32_t aleatorio(uint32_t *estado) {
+    uint32_t x = *estado;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *estado = x;
+}
+
+// ----------------------------------------------------
+// Carga un archivo completo en memoria. Devuelve NULL si no se pudo leer.
+// ----------------------------------------------------
+static inline uint8_t *cargar_archivo(const char *ruta, size_t *largo) {
+    FILE *f = fopen(ruta, "rb");
+    if (f == NULL) return NULL;
+
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (n <= 0) {
+        fclose(f);
+        return NULL;
+    }
+
+    uint8_t *datos = malloc((size_t)n);
+    if (datos != NULL && fread(datos, 1, (size_t)n, f) != (size_t)n) {
+        free(datos);
+        datos = NULL;
+    }
+    fclose(f);
+    *largo = (size_t)n;
+    return datos;
+}
+
+// ----------------------------------------------------
+// Genera un flujo como el del caudalímetro: números 00-99 terminados en
+// "\r\n" o "\n", con una fracción de líneas inválidas (letras, 3 dígitos).
+// ----------------------------------------------------
+static inline uint8_t *generar_flujo_caudal(size_t lineas, uint32_t semilla, size_t *largo) {
+    uint8_t *datos = malloc(lineas * 6);
+    size_t n = 0;
+
+    for (size_t i = 0; i < lineas; i++) {
+        uint32_t r = aleatorio(&semilla);
+        if (r % 20 == 0) {
+            datos[n++] = 'a' + (r >> 8) % 26;          // Letra
+        } else if (r % 20 == 1) {
+            n += (size_t)sprintf((char *)&datos[n], "%u", 100 + (r >> 8) % 900); // Fuera de rango
+        } else {
+            n += (size_t)sprintf((char *)&datos[n], "%02u", (r >> 8) % 100);
+        }
+        if (r & 0x10000) datos[n++] = '\r';
+        datos[n++] = '\n';
+    }
+
+    *largo = n;
+    return datos;
+}
+
+// ----------------------------------------------------
+// Imprime un resultado como una línea JSON, para guardar y comparar corridas:
+// {"bench":..., "caso":..., "metrica":..., "valor":..., "unidad":...}
+// ----------------------------------------------------
+static inline void reportar(const char *bench, const char *caso, const char *metrica,
+                            double valor, const char *unidad) {
+    printf("{\"bench\":\"%s\",\"caso\":\"%s\",\"metrica\":\"%s\",\"valor\":%.6g,\"unidad\":\"%s\"}\n",
+           bench, caso, metrica, valor, unidad);
+}
+
+#endif // BENCH_COMUN_H
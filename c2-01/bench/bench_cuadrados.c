@@ -0,0 +1,133 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Benchmark del servicio de cuadrados (cuadrados.h) en el computador.
+Compara pedidos por segundo entre:
+  1. La versión original: sscanf del primer entero de cada bloque y suma de
+     los primeros n impares (solo se prueban n <= 46340, que caben en int).
+  2. El servicio por lotes: todos los enteros del bloque, n * n en 64 bits y
+     una sola salida por bloque.
+También comprueba que partir el flujo en bloques de cualquier tamaño no
+cambia las respuestas.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_cuadrados bench_cuadrados.c
+  ./bench_cuadrados*/
+
+#include "bench_comun.h"
+#include "cuadrados.h"
+
+#define PEDIDOS 200000
+#define BLOQUE 1024
+
+// ----------------------------------------------------
+// Genera 'pedidos' números separados por '\n' o ' ', con valores hasta 'max'
+// ----------------------------------------------------
+static char *generar_pedidos(size_t pedidos, uint32_t max, uint32_t semilla, size_t *largo) {
+    char *datos = malloc(pedidos * 12);
+    size_t n = 0;
+    for (size_t i = 0; i < pedidos; i++) {
+        uint32_t v = 1 + aleatorio(&semilla) % max;
+        n += (size_t)sprintf(datos + n, "%u", v);
+        datos[n++] = (aleatorio(&semilla) & 3) ? '\n' : ' ';
+    }
+    *largo = n;
+    return datos;
+}
+
+// ----------------------------------------------------
+// Versión original: un pedido por bloque, ciclo de impares
+// ----------------------------------------------------
+static size_t original(const char *bloque, char *salida) {
+    int numero;
+    if (sscanf(bloque, "%d", &numero) == 1 && numero > 0) {
+        int sumatoria = 0;
+        for (int i = 0, impar = 1; i < numero; ++i, impar += 2) {
+            sumatoria += impar;
+        }
+        return (size_t)snprintf(salida, 20, "%d\n", sumatoria);
+    }
+    return 0;
+}
+
+static void medir_original(const char *datos, size_t largo) {
+    char salida[32];
+    volatile size_t total = 0;
+    size_t pedidos = 0;
+
+    uint64_t inicio = tiempo_ns();
+    // Caso más favorable para la versión original: cada bloque trae un solo pedido
+    const char *p = datos;
+    while (p < datos + largo) {
+        total += original(p, salida);
+        pedidos++;
+        while (p < datos + largo && *p != '\n' && *p != ' ') p++;
+        p++;
+    }
+    double seg = (tiempo_ns() - inicio) / 1e9;
+    printf("original  (n<=46340)   %12.0f pedidos/s\n", pedidos / seg);
+}
+
+// ----------------------------------------------------
+// Servicio por lotes: si 'salida' no es NULL deja ahí las respuestas
+// concatenadas (debe tener CUADRADOS_SALIDA_MAX(largo) bytes)
+// ----------------------------------------------------
+static size_t por_lotes(const char *datos, size_t largo, size_t bloque, char *salida,
+                        cuadrados_t *c) {
+    static char tmp[CUADRADOS_SALIDA_MAX(BLOQUE)];
+    size_t escritos = 0;
+
+    cuadrados_init(c);
+    for (size_t pos = 0; pos < largo; pos += bloque) {
+        size_t n = largo - pos < bloque ? largo - pos : bloque;
+        char *destino = salida ? salida + escritos : tmp;
+        escritos += cuadrados_procesar(c, (const uint8_t *)datos + pos, n, destino,
+                                       CUADRADOS_SALIDA_MAX(n));
+    }
+    return escritos + cuadrados_terminar(c, salida ? salida + escritos : tmp,
+                                         CUADRADOS_MAX_RESPUESTA);
+}
+
+static void medir_lotes(const char *nombre, const char *datos, size_t largo) {
+    cuadrados_t c;
+    uint64_t inicio = tiempo_ns();
+    size_t bytes = 0;
+    for (int r = 0; r < 10; r++) bytes += por_lotes(datos, largo, BLOQUE, NULL, &c);
+    double seg = (tiempo_ns() - inicio) / 1e9;
+    printf("lotes     %-12s %12.0f pedidos/s  (%.1f MB/s de respuesta)\n", nombre,
+           c.respondidos * 10.0 / seg, bytes / seg / 1e6);
+}
+
+int main(void) {
+    size_t largo_chico, largo_grande;
+    char *chicos = generar_pedidos(PEDIDOS, 46340, 1, &largo_chico);
+    char *grandes = generar_pedidos(PEDIDOS, UINT32_MAX - 1, 2, &largo_grande);
+
+    medir_original(chicos, largo_chico);
+    medir_lotes("(n<=46340)", chicos, largo_chico);
+    medir_lotes("(32 bits)", grandes, largo_grande);
+
+    // Mismas respuestas sin importar cómo se parta el flujo
+    cuadrados_t c;
+    char *referencia = malloc(CUADRADOS_SALIDA_MAX(largo_grande));
+    char *partida = malloc(CUADRADOS_SALIDA_MAX(largo_grande));
+    size_t n_ref = por_lotes(grandes, largo_grande, largo_grande, referencia, &c);
+    static const size_t bloques[] = {1, 7, 64, 1024};
+    int errores = 0;
+    for (size_t i = 0; i < sizeof(bloques) / sizeof(bloques[0]); i++) {
+        size_t n = por_lotes(grandes, largo_grande, bloques[i], partida, &c);
+        if (n != n_ref || memcmp(referencia, partida, n) != 0 || c.respondidos != PEDIDOS) {
+            printf("DIFERENCIA con bloques de %zu bytes\n", bloques[i]);
+            errores++;
+        }
+    }
+    printf("Verificación de bloques partidos: %s\n", errores ? "FALLÓ" : "ok");
+
+    free(chicos);
+    free(grandes);
+    free(referencia);
+    free(partida);
+    return errores ? 1 : 0;
+}
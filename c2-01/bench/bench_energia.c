@@ -0,0 +1,155 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Benchmark del modo de bajo consumo (energia.h) con el sueño simulado de hal.h.
+
+Mide:
+  uart     Ejercicio 1: un caudalímetro manda una lectura por segundo. Se
+           compara siempre despierto, sueño ligero sin preámbulo y sueño con
+           ENERGIA_PREAMBULO_MIN bytes "\n" antes de cada lectura: tiempo
+           despierto, corriente estimada, bytes perdidos y latencia del
+           despertar al primer byte leído. Con preámbulo no se pierde ninguna
+           lectura (cuenta y suma iguales a las enviadas); sin él, a 9600
+           baudios "47" llega como "7": una lectura válida pero alterada.
+  tactil   Ejercicio 3: despertares y corriente con sondeo cada 50 ms contra
+           el modo por interrupciones (solo la recalibración cada 5 s; los
+           toques despiertan aparte).
+
+La corriente es una estimación con ENERGIA_MA_*; el despertar tarda
+ENERGIA_DESPERTAR_US.
+
+Cada resultado es una línea JSON (reportar() en bench_comun.h). Devuelve 1 si
+alguna verificación falla.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_energia bench_energia.c
+  ./bench_energia*/
+
+#include "bench_comun.h"
+#include "hal.h"
+#include "canal.h"
+#include "energia.h"
+
+#define LECTURAS 600
+#define PERIODO_US 1000000     // Una lectura por segundo
+#define DURACION_TACTIL_MS 600000
+
+// Despierto y corriente del modelo de energia.h en el reloj virtual
+static void reportar_energia(const char *bench, const char *caso, energia_t *e) {
+    energia_linux_actualizar(e);
+    uint64_t ventana = hal_us() - (uint64_t)e->anterior_us;
+    uint64_t activo = ventana - e->dormido_us;
+    double ma = ((double)activo * ENERGIA_MA_ACTIVO_X10 + (double)e->dormido_us * ENERGIA_MA_SUENO_X10) /
+                (10.0 * (double)ventana);
+
+    reportar(bench, caso, "despierto", 100.0 * (double)activo / (double)ventana, "%");
+    reportar(bench, caso, "despertares_por_s", e->despertares * 1e6 / (double)ventana, "1/s");
+    reportar(bench, caso, "corriente", ma, "mA");
+}
+
+// ====================================================
+// Ejercicio 1: lecturas espaciadas por UART
+// ====================================================
+static void correr_uart(uint32_t baudios, bool sueno, size_t preambulo, const char *caso) {
+    static canal_t canal;
+    static instr_hist_t despertar;
+    char rafagas[LECTURAS][24];
+    size_t largos[LECTURAS];
+    uint64_t suma = 0;
+    uint32_t semilla = 5;
+
+    for (int k = 0; k < LECTURAS; k++) {
+        unsigned valor = aleatorio(&semilla) % 100;
+        memset(rafagas[k], '\n', preambulo);
+        largos[k] = preambulo + (size_t)sprintf(rafagas[k] + preambulo, "%02u\n", valor);
+        suma += valor;
+    }
+
+    hal_linux_reiniciar();
+    if (sueno) hal_linux_sueno(ENERGIA_DESPERTAR_US);
+    canal_init(&canal, 0);
+    despertar = (instr_hist_t)INSTR_HIST("despertar");
+    energia_t e;
+    energia_init(&e, 0);
+    energia_rx_t rx = {0};
+
+    // El lector del Ejercicio 1 en bajo consumo: espera sin límite en reposo
+    for (int k = 0; k < LECTURAS; k++) {
+        hal_linux_guion_uart(0, (const uint8_t *)rafagas[k], largos[k], baudios);
+        hal_linux.uart[0].inicio_us = (uint64_t)(k + 1) * PERIODO_US;   // La ráfaga llega a su hora
+
+        while (!hal_linux_uart_terminado(0) || rx.recibiendo) {
+            uint8_t *destino;
+            size_t espacio = ingesta_espacio(&canal.ingesta, &destino);
+            size_t n = hal_uart_leer_bloque(0, destino, espacio, energia_rx_espera(&rx));
+            if (n == 0 && hal_linux_uart_terminado(0)) {
+                hal_linux.reloj_us += ENERGIA_SILENCIO_MS * 1000;  // Silencio con el bloqueo tomado
+            }
+            energia_linux_actualizar(&e);
+            energia_rx_leido(&e, &rx, n, &despertar, (int64_t)hal_us());
+            if (n == 0) continue;
+            ingesta_confirmar(&canal.ingesta, n);
+            canal_procesar_lineas(&canal, hal_ms());
+        }
+    }
+    hal_linux.reloj_us = (uint64_t)(LECTURAS + 1) * PERIODO_US;
+
+    char nombre[48];
+    snprintf(nombre, sizeof(nombre), "%s_%lu", caso, (unsigned long)baudios);
+    reportar_energia("uart", nombre, &e);
+    reportar("uart", nombre, "bytes_perdidos", (double)hal_linux.bytes_perdidos, "B");
+    reportar("uart", nombre, "lecturas_aceptadas", (double)canal.telemetry.stats.cuenta, "lecturas");
+    reportar("uart", nombre, "lecturas_erradas",
+             (double)(canal.telemetry.err_longitud + canal.telemetry.err_no_digito + canal.telemetry.err_rango),
+             "lecturas");
+    reportar("uart", nombre, "suma_faltante", (double)suma - (double)canal.telemetry.stats.suma, "unidades");
+    if (despertar.cuenta > 0) {
+        reportar("uart", nombre, "despertar_a_byte_p50", instr_percentil(&despertar, 50) / (double)INSTR_MHZ, "us");
+        reportar("uart", nombre, "despertar_a_byte_p99", instr_percentil(&despertar, 99) / (double)INSTR_MHZ, "us");
+    }
+
+    bool intactas = canal.telemetry.stats.cuenta == LECTURAS && canal.telemetry.stats.suma == suma;
+    if (!sueno || preambulo >= ENERGIA_PREAMBULO_MIN(baudios)) {
+        verificar(intactas, "uart: ninguna lectura perdida ni alterada");
+    } else {
+        verificar(!intactas, "uart: sin preámbulo el despertar se come bytes");
+    }
+    if (sueno) verificar(e.dormido_us > (uint64_t)LECTURAS * PERIODO_US / 2,
+                         "uart: el chip duerme la mayor parte del tiempo");
+}
+
+static void bench_uart(void) {
+    static const uint32_t baudajes[] = {9600, 115200};
+    for (size_t b = 0; b < sizeof(baudajes) / sizeof(baudajes[0]); b++) {
+        size_t minimo = (size_t)ENERGIA_PREAMBULO_MIN(baudajes[b]);
+        correr_uart(baudajes[b], false, 0, "despierto");
+        correr_uart(baudajes[b], true, 0, "sueno_sin_preambulo");
+        correr_uart(baudajes[b], true, minimo, "sueno_con_preambulo");
+    }
+}
+
+// ====================================================
+// Ejercicio 3: sondeo contra interrupciones
+// ====================================================
+static void correr_tactil(uint32_t periodo_ms, const char *caso) {
+    hal_linux_reiniciar();
+    hal_linux_sueno(ENERGIA_DESPERTAR_US);
+    energia_t e;
+    energia_init(&e, 0);
+
+    while (hal_ms() < DURACION_TACTIL_MS) hal_esperar_ms(periodo_ms);
+    reportar_energia("tactil", caso, &e);
+}
+
+static void bench_tactil(void) {
+    correr_tactil(50, "sondeo_50ms");
+    correr_tactil(5000, "interrupciones");
+}
+
+int main(void) {
+    bench_uart();
+    bench_tactil();
+    return fallas ? 1 : 0;
+}
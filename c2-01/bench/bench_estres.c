@@ -0,0 +1,399 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Prueba de estrés de los analizadores de texto con flujos ruidosos:
+  lineas     Ejercicio 1: ingesta por líneas (ingesta_uart.h) y validate_number
+             (canal.h), con las estadísticas del canal.
+  cuadrados  Ejercicio 2: el analizador de pedidos de cuadrados.h.
+
+Cada caso genera un flujo reproducible y lo repite en bloques de tamaño
+aleatorio (como los entrega el driver del UART):
+  limpio      solo lecturas o pedidos válidos
+  crlf        terminadores mezclados: \n, \r, \r\n, \n\r y líneas vacías
+  parciales   números a medias, signos, espacios, ceros, fuera de rango,
+              comandos
+  largas      líneas de hasta 400 bytes, más largas que BUF_SIZE (se truncan)
+  basura      ráfagas de bytes al azar (incluido el 0) entre líneas válidas
+  mezcla      todo lo anterior revuelto
+
+Mide:
+  - Líneas por segundo sostenidas (bloques aleatorios de 1 a BLOQUE_MAX).
+  - Latencia por línea: se entrega una línea por bloque y se mide cada
+    llamada; p50, p99 y el peor caso en ns (reloj del computador; el peor
+    caso incluye las pausas del sistema operativo).
+Verifica contra un modelo de referencia escrito aparte, directo y sin
+estado entre bloques: cuentas de aceptadas y de cada error, líneas y
+truncadas, el histograma completo y mínimo, máximo y último (lineas); las
+respuestas byte a byte y las cuentas de respondidos e ignorados
+(cuadrados). Un analizador más rápido se puede adoptar si esta prueba sigue
+pasando.
+
+Cada resultado es una línea JSON (reportar() en bench_comun.h). Devuelve 1 si
+alguna verificación falla.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_estres bench_estres.c
+  ./bench_estres*/
+
+#include "bench_comun.h"
+#include <stdbool.h>
+#include "canal.h"
+#include "cuadrados.h"
+#include "instrumentacion.h"
+
+#define LINEAS 200000          // Líneas por caso
+#define BYTES_POR_LINEA 128    // Memoria reservada por línea (promedio, con holgura)
+#define BLOQUE_MAX 256
+#define LARGA_MAX 400
+
+// ====================================================
+// Generación de flujos
+// ====================================================
+typedef enum { LIMPIO, CRLF, PARCIALES, LARGAS, BASURA, MEZCLA, NUM_CASOS } caso_t;
+
+static const char *nombres_caso[NUM_CASOS] = {"limpio", "crlf", "parciales", "largas", "basura", "mezcla"};
+
+static const char *parciales_lineas[] = {
+    "", "4", "-", "4a", "a4", " 4", "4 ", "+5", "07", "100", "999", "x", "-1", "0", "00",
+    "!perf", "!registro", "!", "5\t", "\t5", "٣",
+};
+static const char *parciales_cuadrados[] = {
+    "+", "++5", "5+", "0", "00", "00000000005", "0000000005", "4294967295", "4294967296",
+    "18446744073709551616", "-3", "?", "!x", "?metricas", "12a", "a12", "+0", "+42", "1?",
+};
+
+// Escribe un terminador de línea; en 'crlf' y 'mezcla' los mezcla
+static size_t terminador(char *d, caso_t caso, uint32_t *semilla) {
+    if (caso != CRLF && caso != MEZCLA) {
+        d[0] = '\n';
+        return 1;
+    }
+    static const char *terminadores[] = {"\n", "\r", "\r\n", "\n\r", "\n\n", "\r\r\n", "\n\n\n\r"};
+    const char *t = terminadores[aleatorio(semilla) % 7];
+    size_t n = strlen(t);
+    memcpy(d, t, n);
+    return n;
+}
+
+// ----------------------------------------------------
+// Contenido de una línea (sin terminador). 'cuadrados' elige los pedidos del
+// Ejercicio 2 (números grandes, varios por línea) en vez de lecturas 0-99.
+// ----------------------------------------------------
+static size_t contenido(char *d, caso_t caso, bool cuadrados, uint32_t *semilla) {
+    uint32_t r = aleatorio(semilla);
+    if (caso == MEZCLA) caso = (caso_t)(r % MEZCLA);
+    r >>= 4;
+
+    switch (caso) {
+    case PARCIALES:
+        if (r % 2) {
+            const char *p = cuadrados ? parciales_cuadrados[(r >> 1) % (sizeof(parciales_cuadrados) / sizeof(char *))]
+                                      : parciales_lineas[(r >> 1) % (sizeof(parciales_lineas) / sizeof(char *))];
+            size_t n = strlen(p);
+            memcpy(d, p, n);
+            return n;
+        }
+        break;
+
+    case LARGAS:
+        if (r % 4 == 0) {
+            size_t n = 100 + (r >> 2) % (LARGA_MAX - 100);
+            bool digitos = aleatorio(semilla) & 1;
+            for (size_t i = 0; i < n; i++) {
+                d[i] = digitos ? (char)('0' + aleatorio(semilla) % 10) : (char)('a' + aleatorio(semilla) % 26);
+            }
+            if (cuadrados && !digitos) d[n / 2] = ' ';
+            return n;
+        }
+        break;
+
+    case BASURA:
+        if (r % 3 == 0) {
+            size_t n = 1 + (r >> 2) % 64;
+            for (size_t i = 0; i < n; i++) d[i] = (char)(aleatorio(semilla) & 0xFF);
+            return n;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    // Lectura o pedido válido (el caso limpio y el resto de los demás)
+    if (!cuadrados) return (size_t)sprintf(d, (r & 1) ? "%02u" : "%u", (r >> 1) % 100);
+
+    size_t n = 0;
+    int pedidos = 1 + r % 3;
+    static const char separadores[] = " ,;\t";
+    for (int i = 0; i < pedidos; i++) {
+        if (i > 0) d[n++] = separadores[aleatorio(semilla) % 4];
+        n += (size_t)sprintf(d + n, "%u", 1 + aleatorio(semilla) % 100000);
+    }
+    return n;
+}
+
+static uint8_t *generar(caso_t caso, bool cuadrados, size_t *largo) {
+    size_t capacidad = (size_t)LINEAS * BYTES_POR_LINEA;
+    char *datos = malloc(capacidad);
+    uint32_t semilla = 17 + (uint32_t)caso;
+    size_t n = 0;
+
+    for (size_t i = 0; i < LINEAS && n + LARGA_MAX + 16 < capacidad; i++) {
+        n += contenido(datos + n, caso, cuadrados, &semilla);
+        n += terminador(datos + n, caso, &semilla);
+    }
+    *largo = n;
+    return (uint8_t *)datos;
+}
+
+// ====================================================
+// Modelos de referencia: recorren el flujo completo de una vez
+// ====================================================
+typedef struct {
+    uint64_t lineas, truncadas, comandos;
+    uint64_t aceptadas, suma;
+    uint64_t err_longitud, err_no_digito;
+    uint64_t histograma[ESTAD_CASILLAS];
+    uint8_t min, max, ultimo;
+} modelo_lineas_t;
+
+// Una línea termina en '\n' o '\r'; las vacías no cuentan; se conservan
+// INGESTA_LINEA_MAX bytes. '!' al inicio es un comando; si no, debe tener 1
+// o 2 bytes y todos dígitos. La última línea sin terminador queda pendiente.
+static void modelo_lineas(const uint8_t *d, size_t n, modelo_lineas_t *m) {
+    memset(m, 0, sizeof(*m));
+    m->min = ESTAD_VALOR_MAX;
+
+    size_t i = 0;
+    while (i < n) {
+        size_t j = i;
+        while (j < n && d[j] != '\n' && d[j] != '\r') j++;
+        if (j == n) break;
+
+        size_t largo = j - i;
+        const uint8_t *l = d + i;
+        i = j + 1;
+        if (largo == 0) continue;
+
+        m->lineas++;
+        if (largo > INGESTA_LINEA_MAX) {
+            m->truncadas++;
+            largo = INGESTA_LINEA_MAX;
+        }
+        if (l[0] == '!') {
+            m->comandos++;
+        } else if (largo > 2) {
+            m->err_longitud++;
+        } else if (!(l[0] >= '0' && l[0] <= '9') || (largo == 2 && !(l[1] >= '0' && l[1] <= '9'))) {
+            m->err_no_digito++;
+        } else {
+            uint8_t v = (uint8_t)(largo == 1 ? l[0] - '0' : (l[0] - '0') * 10 + (l[1] - '0'));
+            m->aceptadas++;
+            m->suma += v;
+            m->histograma[v]++;
+            if (v < m->min) m->min = v;
+            if (v > m->max) m->max = v;
+            m->ultimo = v;
+        }
+    }
+}
+
+typedef struct {
+    uint64_t respondidos, ignorados, comandos;
+    char *salida;
+    size_t salida_largo;
+} modelo_cuadrados_t;
+
+// Los pedidos se separan con " \n\r\t,;". Un pedido que empieza con '?' o
+// '!' es un comando; si no, '+' opcional y de 1 a 10 dígitos con valor entre
+// 1 y 4294967295 (se responde su cuadrado); cualquier otro se ignora. Al
+// final del flujo se cierra el pedido abierto.
+static void modelo_cuadrados(const uint8_t *d, size_t n, modelo_cuadrados_t *m) {
+    memset(m, 0, sizeof(*m));
+    m->salida = malloc(CUADRADOS_SALIDA_MAX(n));
+
+    size_t i = 0;
+    while (i < n) {
+        while (i < n && strchr(" \n\r\t,;", d[i]) != NULL && d[i] != '\0') i++;
+        if (i == n) break;
+        size_t j = i;
+        while (j < n && (d[j] == '\0' || strchr(" \n\r\t,;", d[j]) == NULL)) j++;
+
+        const uint8_t *p = d + i;
+        size_t largo = j - i;
+        i = j;
+
+        if (p[0] == '?' || p[0] == '!') {
+            m->comandos++;
+            continue;
+        }
+        if (p[0] == '+') {
+            p++;
+            largo--;
+        }
+        bool valido = largo >= 1 && largo <= CUADRADOS_MAX_DIGITOS;
+        uint64_t v = 0;
+        for (size_t k = 0; valido && k < largo; k++) {
+            valido = p[k] >= '0' && p[k] <= '9';
+            v = v * 10 + (uint64_t)(p[k] - '0');
+        }
+        if (!valido || v == 0 || v > UINT32_MAX) {
+            m->ignorados++;
+            continue;
+        }
+        m->respondidos++;
+        m->salida_largo += (size_t)sprintf(m->salida + m->salida_largo, "%llu\n", (unsigned long long)(v * v));
+    }
+}
+
+// ====================================================
+// Ejercicio 1: ingesta por líneas y validate_number
+// ====================================================
+
+// Entrega 'datos' al canal en bloques: de tamaño aleatorio o, con 'por_linea',
+// cortados después de cada terminador (una llamada medida por línea en 'h')
+static void repetir_lineas(canal_t *canal, const uint8_t *datos, size_t largo, bool por_linea,
+                           instr_hist_t *h) {
+    uint32_t semilla = 3;
+    canal_init(canal, 0);
+
+    for (size_t pos = 0; pos < largo;) {
+        uint8_t *destino;
+        size_t n = ingesta_espacio(&canal->ingesta, &destino);
+        size_t quiero = 1 + aleatorio(&semilla) % BLOQUE_MAX;
+        if (por_linea) {
+            const uint8_t *fin = memchr(datos + pos, '\n', largo - pos);
+            const uint8_t *fin_r = memchr(datos + pos, '\r', largo - pos);
+            if (fin == NULL || (fin_r != NULL && fin_r < fin)) fin = fin_r;
+            quiero = fin ? (size_t)(fin - (datos + pos)) + 1 : largo - pos;
+        }
+        if (n > quiero) n = quiero;
+        if (n > largo - pos) n = largo - pos;
+        memcpy(destino, datos + pos, n);
+        pos += n;
+
+        uint32_t marca = h ? instr_marca() : 0;
+        ingesta_confirmar(&canal->ingesta, n);
+        canal_procesar_lineas(canal, 0);
+        if (h) instr_desde(h, marca);
+    }
+}
+
+static void verificar_lineas(const char *caso, const canal_t *canal, const modelo_lineas_t *m) {
+    const telemetry_t *t = &canal->telemetry;
+    const estadisticas_t *st = &t->stats;
+    char que[64];
+
+    snprintf(que, sizeof(que), "lineas %s: cuentas iguales al modelo", caso);
+    verificar(st->cuenta == m->aceptadas && t->err_longitud == m->err_longitud &&
+              t->err_no_digito == m->err_no_digito && t->err_rango == 0 &&
+              canal->ingesta.lineas == m->lineas && canal->ingesta.truncadas == m->truncadas, que);
+    snprintf(que, sizeof(que), "lineas %s: estadísticas iguales al modelo", caso);
+    verificar(st->suma == m->suma && memcmp(st->histograma, m->histograma, sizeof(m->histograma)) == 0 &&
+              (m->aceptadas == 0 || (st->min == m->min && st->max == m->max && st->ultimo == m->ultimo)), que);
+}
+
+static void bench_lineas(caso_t caso) {
+    static canal_t canal;
+    static instr_hist_t h;
+    const char *nombre = nombres_caso[caso];
+    size_t largo;
+    uint8_t *datos = generar(caso, false, &largo);
+    modelo_lineas_t m;
+    modelo_lineas(datos, largo, &m);
+
+    repetir_lineas(&canal, datos, largo, false, NULL);   // Calentar caché
+    uint64_t inicio = tiempo_ns();
+    repetir_lineas(&canal, datos, largo, false, NULL);
+    double seg = (tiempo_ns() - inicio) / 1e9;
+    verificar_lineas(nombre, &canal, &m);
+
+    h = (instr_hist_t)INSTR_HIST("linea");
+    repetir_lineas(&canal, datos, largo, true, &h);
+    verificar_lineas(nombre, &canal, &m);
+
+    reportar("lineas", nombre, "lineas_por_s", m.lineas / seg, "lineas/s");
+    reportar("lineas", nombre, "mb_por_s", largo / seg / 1e6, "MB/s");
+    reportar("lineas", nombre, "aceptadas", (double)m.aceptadas, "lineas");
+    reportar("lineas", nombre, "rechazadas", (double)(m.err_longitud + m.err_no_digito), "lineas");
+    reportar("lineas", nombre, "truncadas", (double)m.truncadas, "lineas");
+    reportar("lineas", nombre, "latencia_p50", instr_percentil(&h, 50), "ns");
+    reportar("lineas", nombre, "latencia_p99", instr_percentil(&h, 99), "ns");
+    reportar("lineas", nombre, "latencia_max", h.max, "ns");
+    free(datos);
+}
+
+// ====================================================
+// Ejercicio 2: analizador de pedidos de cuadrados
+// ====================================================
+static size_t repetir_cuadrados(cuadrados_t *c, const uint8_t *datos, size_t largo, bool por_linea,
+                                char *salida, instr_hist_t *h) {
+    uint32_t semilla = 3;
+    size_t escritos = 0;
+    cuadrados_init(c);
+
+    for (size_t pos = 0; pos < largo;) {
+        size_t n = 1 + aleatorio(&semilla) % BLOQUE_MAX;
+        if (por_linea) {
+            const uint8_t *fin = memchr(datos + pos, '\n', largo - pos);
+            n = fin ? (size_t)(fin - (datos + pos)) + 1 : largo - pos;
+        }
+        if (n > largo - pos) n = largo - pos;
+
+        uint32_t marca = h ? instr_marca() : 0;
+        escritos += cuadrados_procesar(c, datos + pos, n, salida + escritos, CUADRADOS_SALIDA_MAX(n));
+        if (h) instr_desde(h, marca);
+        pos += n;
+    }
+    return escritos + cuadrados_terminar(c, salida + escritos, CUADRADOS_MAX_RESPUESTA);
+}
+
+static void verificar_cuadrados(const char *caso, const cuadrados_t *c, const char *salida, size_t n,
+                                const modelo_cuadrados_t *m) {
+    char que[64];
+    snprintf(que, sizeof(que), "cuadrados %s: cuentas iguales al modelo", caso);
+    verificar(c->respondidos == m->respondidos && c->ignorados == m->ignorados && c->sin_espacio == 0, que);
+    snprintf(que, sizeof(que), "cuadrados %s: respuestas iguales al modelo", caso);
+    verificar(n == m->salida_largo && memcmp(salida, m->salida, n) == 0, que);
+}
+
+static void bench_cuadrados(caso_t caso) {
+    static cuadrados_t c;
+    static instr_hist_t h;
+    const char *nombre = nombres_caso[caso];
+    size_t largo;
+    uint8_t *datos = generar(caso, true, &largo);
+    modelo_cuadrados_t m;
+    modelo_cuadrados(datos, largo, &m);
+    char *salida = malloc(CUADRADOS_SALIDA_MAX(largo));
+
+    repetir_cuadrados(&c, datos, largo, false, salida, NULL);
+    uint64_t inicio = tiempo_ns();
+    size_t n = repetir_cuadrados(&c, datos, largo, false, salida, NULL);
+    double seg = (tiempo_ns() - inicio) / 1e9;
+    verificar_cuadrados(nombre, &c, salida, n, &m);
+
+    h = (instr_hist_t)INSTR_HIST("linea");
+    n = repetir_cuadrados(&c, datos, largo, true, salida, &h);
+    verificar_cuadrados(nombre, &c, salida, n, &m);
+
+    uint64_t pedidos = m.respondidos + m.ignorados + m.comandos;
+    reportar("cuadrados", nombre, "pedidos_por_s", pedidos / seg, "pedidos/s");
+    reportar("cuadrados", nombre, "mb_por_s", largo / seg / 1e6, "MB/s");
+    reportar("cuadrados", nombre, "respondidos", (double)m.respondidos, "pedidos");
+    reportar("cuadrados", nombre, "ignorados", (double)m.ignorados, "pedidos");
+    reportar("cuadrados", nombre, "latencia_p50", instr_percentil(&h, 50), "ns");
+    reportar("cuadrados", nombre, "latencia_p99", instr_percentil(&h, 99), "ns");
+    reportar("cuadrados", nombre, "latencia_max", h.max, "ns");
+    free(salida);
+    free(m.salida);
+    free(datos);
+}
+
+int main(void) {
+    for (caso_t caso = 0; caso < NUM_CASOS; caso++) bench_lineas(caso);
+    for (caso_t caso = 0; caso < NUM_CASOS; caso++) bench_cuadrados(caso);
+    return fallas ? 1 : 0;
+}
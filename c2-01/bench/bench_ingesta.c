@@ -0,0 +1,173 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Benchmark de ingesta UART en el computador.
+Reproduce un flujo grabado (o uno sintético) a través de:
+  1. El lector original: una llamada al driver por byte.
+  2. La ingesta por bloques (ingesta_uart.h): una llamada por bloque.
+El driver se simula con una copia protegida por un mutex, para reflejar el
+costo de la cola y el candado que paga cada uart_read_bytes en el ESP32.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_ingesta bench_ingesta.c -lpthread
+  ./bench_ingesta [flujo_grabado.txt]*/
+
+#include "bench_comun.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include "ingesta_uart.h"
+
+#define BUF_SIZE 128
+#define REPETICIONES 20
+
+// ----------------------------------------------------
+// Driver simulado: entrega hasta 'n' bytes del flujo grabado
+// ----------------------------------------------------
+typedef struct {
+    const uint8_t *datos;
+    size_t largo;
+    size_t pos;
+    size_t rafaga;  // Bytes que "llegaron" al buffer del driver desde la última lectura
+    pthread_mutex_t candado;
+} driver_t;
+
+static size_t driver_disponibles(driver_t *d) {
+    pthread_mutex_lock(&d->candado);
+    size_t resto = d->largo - d->pos;
+    size_t n = resto < d->rafaga ? resto : d->rafaga;
+    pthread_mutex_unlock(&d->candado);
+    return n;
+}
+
+static int driver_leer(driver_t *d, uint8_t *destino, size_t n) {
+    pthread_mutex_lock(&d->candado);
+    size_t resto = d->largo - d->pos;
+    if (n > resto) n = resto;
+    memcpy(destino, d->datos + d->pos, n);
+    d->pos += n;
+    pthread_mutex_unlock(&d->candado);
+    return (int)n;
+}
+
+// Suma de verificación de las líneas entregadas, para comparar ambos lectores
+typedef struct {
+    uint64_t lineas;
+    uint64_t suma;
+} resumen_t;
+
+static void acumular(resumen_t *r, const char *linea) {
+    r->lineas++;
+    for (const char *p = linea; *p; p++) r->suma = r->suma * 31 + (uint8_t)*p;
+}
+
+// ----------------------------------------------------
+// Lector original: un byte por llamada
+// ----------------------------------------------------
+static resumen_t leer_por_byte(driver_t *d) {
+    resumen_t r = {0};
+    char line[BUF_SIZE];
+    int index = 0;
+    uint8_t byte;
+
+    while (driver_leer(d, &byte, 1) > 0) {
+        if (byte == '\n' || byte == '\r') {
+            if (index > 0) {
+                line[index] = '\0';
+                acumular(&r, line);
+                index = 0;
+            }
+        } else if (index < BUF_SIZE - 1) {
+            line[index++] = byte;
+        }
+    }
+    return r;
+}
+
+// ----------------------------------------------------
+// Ingesta por bloques: primer byte + drenado de lo disponible
+// ----------------------------------------------------
+static ingesta_t ingesta;
+
+static resumen_t leer_por_bloque(driver_t *d) {
+    resumen_t r = {0};
+    ingesta_init(&ingesta);
+
+    while (1) {
+        uint8_t *destino;
+        size_t espacio = ingesta_espacio(&ingesta, &destino);
+
+        int len = driver_leer(d, destino, 1);
+        if (len <= 0) break;
+
+        size_t pendientes = driver_disponibles(d);
+        if (pendientes > espacio - 1) pendientes = espacio - 1;
+        if (pendientes > 0) len += driver_leer(d, destino + 1, pendientes);
+        ingesta_confirmar(&ingesta, (size_t)len);
+
+        const char *linea;
+        size_t largo;
+        while ((linea = ingesta_siguiente_linea(&ingesta, &largo)) != NULL) {
+            acumular(&r, linea);
+        }
+    }
+    return r;
+}
+
+// ----------------------------------------------------
+// Mide un lector con un tamaño de ráfaga dado y muestra MB/s y líneas/s
+// ----------------------------------------------------
+static resumen_t medir(const char *nombre, resumen_t (*lector)(driver_t *),
+                       const uint8_t *datos, size_t largo, size_t rafaga) {
+    driver_t d = {.datos = datos, .largo = largo, .rafaga = rafaga};
+    pthread_mutex_init(&d.candado, NULL);
+
+    resumen_t r = {0};
+    uint64_t inicio = tiempo_ns();
+    for (int i = 0; i < REPETICIONES; i++) {
+        d.pos = 0;
+        r = lector(&d);
+    }
+    double seg = (tiempo_ns() - inicio) / 1e9;
+    pthread_mutex_destroy(&d.candado);
+
+    printf("%-10s rafaga=%4zu  %8.2f MB/s  %10.0f lineas/s\n", nombre, rafaga,
+           (double)largo * REPETICIONES / seg / 1e6,
+           (double)r.lineas * REPETICIONES / seg);
+    return r;
+}
+
+int main(int argc, char **argv) {
+    size_t largo;
+    uint8_t *datos;
+
+    if (argc > 1) {
+        datos = cargar_archivo(argv[1], &largo);
+        if (datos == NULL) {
+            fprintf(stderr, "No se pudo leer '%s'\n", argv[1]);
+            return 1;
+        }
+        printf("Flujo grabado: %s (%zu bytes)\n", argv[1], largo);
+    } else {
+        datos = generar_flujo_caudal(200000, 12345, &largo);
+        printf("Flujo sintético: %zu bytes\n", largo);
+    }
+
+    static const size_t rafagas[] = {1, 16, 64, 256, 1024};
+    int errores = 0;
+
+    for (size_t i = 0; i < sizeof(rafagas) / sizeof(rafagas[0]); i++) {
+        resumen_t a = medir("por_byte", leer_por_byte, datos, largo, rafagas[i]);
+        resumen_t b = medir("bloques", leer_por_bloque, datos, largo, rafagas[i]);
+        if (a.lineas != b.lineas || a.suma != b.suma) {
+            printf("  DIFERENCIA: %llu vs %llu lineas\n",
+                   (unsigned long long)a.lineas, (unsigned long long)b.lineas);
+            errores++;
+        }
+    }
+
+    printf("Lineas truncadas: %u, linealizadas: %u\n", ingesta.truncadas, ingesta.copiadas);
+    free(datos);
+    return errores ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Benchmark de la instrumentación (instrumentacion.h) en el computador.
+
+Mide:
+  costo      ns por registro (instr_registrar) y por par marca + registro
+             (instr_marca + instr_desde).
+  ingesta    Ejercicio 1: ns por byte de la ingesta por bloques sin
+             instrumentar y con una marca por bloque, como en el firmware.
+  precision  Percentiles del histograma contra los exactos (valores
+             ordenados): el error debe quedar bajo el 25%.
+
+En el computador una marca es un nanosegundo (clock_gettime), más cara que
+leer el contador de ciclos del ESP32; el costo medido es una cota superior.
+
+Cada resultado es una línea JSON (reportar() en bench_comun.h). Devuelve 1 si
+alguna verificación falla.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_instrumentacion bench_instrumentacion.c
+  ./bench_instrumentacion*/
+
+#include "bench_comun.h"
+#include "canal.h"
+#include "instrumentacion.h"
+
+#define REGISTROS 10000000
+#define LINEAS 2000000
+#define BLOQUE 128
+#define MUESTRAS 1000000
+
+static void bench_costo(void) {
+    static instr_hist_t h = INSTR_HIST("costo");
+    uint32_t semilla = 1;
+
+    uint64_t inicio = tiempo_ns();
+    for (uint32_t i = 0; i < REGISTROS; i++) instr_registrar(&h, aleatorio(&semilla) & 0xFFFFF);
+    reportar("costo", "instr_registrar", "ns_por_registro", (tiempo_ns() - inicio) / (double)REGISTROS, "ns");
+    verificar(h.cuenta == REGISTROS, "costo: todos los registros contados");
+
+    instr_reiniciar(&h);
+    inicio = tiempo_ns();
+    for (uint32_t i = 0; i < REGISTROS; i++) {
+        uint32_t marca = instr_marca();
+        instr_desde(&h, marca);
+    }
+    reportar("costo", "marca_y_desde", "ns_por_par", (tiempo_ns() - inicio) / (double)REGISTROS, "ns");
+}
+
+// Ingesta por bloques de BLOQUE bytes; con 'hist' se marca cada bloque
+static uint64_t ingesta(const uint8_t *flujo, size_t largo, instr_hist_t *hist) {
+    static canal_t canal;
+    canal_init(&canal, 0);
+
+    uint64_t inicio = tiempo_ns();
+    for (size_t pos = 0; pos < largo;) {
+        uint8_t *destino;
+        size_t n = ingesta_espacio(&canal.ingesta, &destino);
+        if (n > BLOQUE) n = BLOQUE;
+        if (n > largo - pos) n = largo - pos;
+        memcpy(destino, flujo + pos, n);
+        pos += n;
+
+        uint32_t marca = hist ? instr_marca() : 0;
+        ingesta_confirmar(&canal.ingesta, n);
+        canal_procesar_lineas(&canal, 0);
+        if (hist) instr_desde(hist, marca);
+    }
+    return tiempo_ns() - inicio;
+}
+
+static void bench_ingesta(void) {
+    size_t largo;
+    uint8_t *flujo = generar_flujo_caudal(LINEAS, 3, &largo);
+    static instr_hist_t h = INSTR_HIST("linea");
+
+    ingesta(flujo, largo, NULL);   // Calentar caché
+    uint64_t sin = ingesta(flujo, largo, NULL);
+    uint64_t con = ingesta(flujo, largo, &h);
+
+    reportar("ingesta", "sin_instrumentar", "ns_por_byte", (double)sin / largo, "ns");
+    reportar("ingesta", "con_marcas", "ns_por_byte", (double)con / largo, "ns");
+    reportar("ingesta", "con_marcas", "sobrecosto", 100.0 * ((double)con - (double)sin) / sin, "%");
+    reportar("ingesta", "con_marcas", "bloque_p99", instr_percentil(&h, 99) / (double)INSTR_MHZ, "us");
+    free(flujo);
+}
+
+static int comparar(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void bench_precision(void) {
+    static instr_hist_t h = INSTR_HIST("precision");
+    uint32_t *valores = malloc(MUESTRAS * sizeof(uint32_t));
+    uint32_t semilla = 9;
+
+    // Latencias con cola larga: la mayoría cerca de 2000 ciclos, algunas 100 veces más
+    for (size_t i = 0; i < MUESTRAS; i++) {
+        uint32_t r = aleatorio(&semilla);
+        valores[i] = (r % 100 == 0) ? 100000 + r % 200000 : 1500 + r % 1000;
+        instr_registrar(&h, valores[i]);
+    }
+    qsort(valores, MUESTRAS, sizeof(uint32_t), comparar);
+
+    static const uint32_t percentiles[] = {50, 90, 99, 100};
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++) {
+        uint32_t p = percentiles[i];
+        uint32_t exacto = valores[((uint64_t)MUESTRAS * p + 99) / 100 - 1];
+        uint32_t aprox = instr_percentil(&h, p);
+        double error = 100.0 * ((double)aprox - exacto) / exacto;
+        char caso[16];
+        snprintf(caso, sizeof(caso), "p%u", p);
+        reportar("precision", caso, "error", error, "%");
+        verificar(aprox >= exacto && error < 25.0, "precision: percentil dentro del 25%");
+    }
+    free(valores);
+}
+
+int main(void) {
+    bench_costo();
+    bench_ingesta();
+    bench_precision();
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Benchmark del motor de patrones (patrones.h) en el computador.
+Alimenta flujos sintéticos de toques con 1, 2, 4, ... 32 patrones
+registrados y compara:
+  1. Comparación al final: se guardan los toques en un arreglo y al validar
+     se comparan contra cada patrón (como el validate_sequence original).
+  2. Motor incremental: un AND con la tabla por toque y rechazo temprano.
+La mitad de las sesiones ingresa un patrón registrado y la otra mitad toques
+al azar. También verifica que ambos elijan el mismo patrón en cada sesión.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_patrones bench_patrones.c
+  ./bench_patrones*/
+
+#include "bench_comun.h"
+#include "patrones.h"
+
+#define SESIONES 200000
+#define REPETICIONES 10
+
+static patron_t patrones[PATRONES_MAX];
+static uint8_t *toques;        // Toques de todas las sesiones, seguidos
+static uint32_t *inicio;       // Primer toque de cada sesión (SESIONES + 1 entradas)
+static int *esperado;          // Patrón elegido por la comparación al final
+
+// ----------------------------------------------------
+// Patrones al azar de 4 a 32 toques
+// ----------------------------------------------------
+static void generar_patrones(uint32_t semilla) {
+    for (int p = 0; p < PATRONES_MAX; p++) {
+        patrones[p].nombre = "azar";
+        patrones[p].largo = (uint8_t)(4 + aleatorio(&semilla) % (PATRONES_MAX_LARGO - 3));
+        patrones[p].simbolos = aleatorio(&semilla);
+    }
+}
+
+// ----------------------------------------------------
+// Sesiones: la mitad copia uno de los 'n' patrones, la otra son toques al azar
+// ----------------------------------------------------
+static size_t generar_sesiones(int n, uint32_t semilla) {
+    size_t total = 0;
+    for (int s = 0; s < SESIONES; s++) {
+        inicio[s] = (uint32_t)total;
+        uint32_t r = aleatorio(&semilla);
+        if (r & 1) {
+            const patron_t *p = &patrones[(r >> 1) % n];
+            for (int i = 0; i < p->largo; i++) toques[total++] = (p->simbolos >> i) & 1;
+        } else {
+            int largo = 1 + (r >> 1) % PATRONES_MAX_LARGO;
+            for (int i = 0; i < largo; i++) toques[total++] = aleatorio(&semilla) & 1;
+        }
+    }
+    inicio[SESIONES] = (uint32_t)total;
+    return total;
+}
+
+// ----------------------------------------------------
+// Comparación al final contra cada patrón
+// ----------------------------------------------------
+static int comparar_al_final(int n, const uint8_t *ingresados, int largo) {
+    for (int p = 0; p < n; p++) {
+        if (patrones[p].largo != largo) continue;
+        int i = 0;
+        while (i < largo && ingresados[i] == ((patrones[p].simbolos >> i) & 1)) i++;
+        if (i == largo) return p;
+    }
+    return -1;
+}
+
+// ----------------------------------------------------
+// Motor incremental: deja de mirar la sesión al primer toque sin candidatos
+// ----------------------------------------------------
+static int motor(const patrones_tabla_t *tabla, const uint8_t *ingresados, int largo) {
+    patrones_motor_t m;
+    patrones_reiniciar(&m, tabla);
+    for (int i = 0; i < largo; i++) {
+        if (patrones_avanzar(&m, tabla, ingresados[i]) == PATRONES_RECHAZADO) return -1;
+    }
+    return patrones_primero(patrones_coincidencias(&m, tabla));
+}
+
+int main(void) {
+    toques = malloc((size_t)SESIONES * PATRONES_MAX_LARGO);
+    inicio = malloc((SESIONES + 1) * sizeof(*inicio));
+    esperado = malloc(SESIONES * sizeof(*esperado));
+    generar_patrones(1);
+
+    printf("patrones  final(ns/toque)  motor(ns/toque)  rechazo_temprano  aprobadas\n");
+    int errores = 0;
+    for (int n = 1; n <= PATRONES_MAX; n *= 2) {
+        size_t total = generar_sesiones(n, 2);
+        patrones_tabla_t tabla;
+        patrones_compilar(&tabla, patrones, n);
+
+        // 1. Comparación al final
+        volatile int suma = 0;
+        uint64_t t0 = tiempo_ns();
+        for (int r = 0; r < REPETICIONES; r++) {
+            for (int s = 0; s < SESIONES; s++) {
+                int largo = (int)(inicio[s + 1] - inicio[s]);
+                int p = comparar_al_final(n, &toques[inicio[s]], largo);
+                if (r == 0) esperado[s] = p;
+                suma += p;
+            }
+        }
+        double ns_final = (double)(tiempo_ns() - t0) / ((double)total * REPETICIONES);
+
+        // 2. Motor incremental
+        int aprobadas = 0, tempranos = 0;
+        t0 = tiempo_ns();
+        for (int r = 0; r < REPETICIONES; r++) {
+            for (int s = 0; s < SESIONES; s++) {
+                int largo = (int)(inicio[s + 1] - inicio[s]);
+                int p = motor(&tabla, &toques[inicio[s]], largo);
+                suma += p;
+                if (r == 0) {
+                    if (p != esperado[s]) errores++;
+                    if (p >= 0) aprobadas++;
+                }
+            }
+        }
+        double ns_motor = (double)(tiempo_ns() - t0) / ((double)total * REPETICIONES);
+
+        // Toques que el motor no necesitó mirar (la sesión ya estaba rechazada)
+        size_t mirados = 0;
+        for (int s = 0; s < SESIONES; s++) {
+            patrones_motor_t m;
+            patrones_reiniciar(&m, &tabla);
+            for (uint32_t i = inicio[s]; i < inicio[s + 1]; i++) {
+                mirados++;
+                if (patrones_avanzar(&m, &tabla, toques[i]) == PATRONES_RECHAZADO) break;
+            }
+        }
+        tempranos = (int)(100 - 100 * mirados / total);
+
+        printf("%8d  %15.2f  %15.2f  %15d%%  %9d\n", n, ns_final, ns_motor, tempranos, aprobadas);
+    }
+
+    printf("Verificación contra la comparación al final: %s\n", errores ? "FALLÓ" : "ok");
+    free(toques);
+    free(inicio);
+    free(esperado);
+    return errores ? 1 : 0;
+}
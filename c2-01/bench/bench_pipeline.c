@@ -0,0 +1,144 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Benchmark de latencia del modo de dos etapas (spsc.h + canal.h).
+Un hilo hace de etapa 1: recibe bloques del flujo, separa, valida y encola.
+Otro hilo hace de etapa 2: saca por lotes y actualiza las estadísticas.
+Para cada lectura se mide el tiempo desde que llegó el bloque con su último
+byte hasta que quedó sumada en las estadísticas.
+
+Se corre dos veces: a ritmo fijo (como un caudalímetro real) y a máxima
+velocidad, donde se ve cuántas lecturas se descartan si la etapa 2 no alcanza.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_pipeline bench_pipeline.c -lpthread
+  ./bench_pipeline*/
+
+#include "bench_comun.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include "canal.h"
+
+#define LINEAS 1000000
+#define BLOQUE 32              // Bytes por bloque recibido
+
+static canal_t canal;
+static const uint8_t *flujo;
+static size_t flujo_largo;
+static uint64_t *llegada;      // Llegada de la k-ésima lectura encolada
+static uint64_t *latencia;     // Latencia de la k-ésima lectura procesada
+static uint64_t periodo_ns;    // 0 = máxima velocidad
+static volatile bool fin_productor;
+
+// ----------------------------------------------------
+// Etapa 1: bloques del flujo -> ingesta -> validación -> cola
+// ----------------------------------------------------
+static void *etapa1(void *arg) {
+    (void)arg;
+    size_t pos = 0;
+    uint32_t encoladas = 0;
+    uint64_t siguiente = tiempo_ns();
+
+    while (pos < flujo_largo) {
+        if (periodo_ns) {
+            while (tiempo_ns() < siguiente) sched_yield();
+            siguiente += periodo_ns;
+        }
+
+        uint8_t *destino;
+        size_t n = ingesta_espacio(&canal.ingesta, &destino);
+        if (n > BLOQUE) n = BLOQUE;
+        if (n > flujo_largo - pos) n = flujo_largo - pos;
+        memcpy(destino, flujo + pos, n);
+        pos += n;
+
+        uint64_t t = tiempo_ns();
+        ingesta_confirmar(&canal.ingesta, n);
+
+        const char *line;
+        size_t line_len;
+        while ((line = ingesta_siguiente_linea(&canal.ingesta, &line_len)) != NULL) {
+            int num = validate_number(&canal, line, line_len);
+            if (num != -1) {
+                llegada[encoladas] = t;  // Se escribe antes de publicar en la cola
+                if (spsc_push(&canal.cola, (uint8_t)num)) encoladas++;
+            }
+        }
+    }
+    fin_productor = true;
+    return NULL;
+}
+
+// ----------------------------------------------------
+// Etapa 2: cola -> estadísticas, por lotes
+// ----------------------------------------------------
+static void *etapa2(void *arg) {
+    (void)arg;
+    uint8_t lote[CANAL_LOTE];
+    uint32_t procesadas = 0;
+
+    while (1) {
+        size_t n = spsc_pop_lote(&canal.cola, lote, CANAL_LOTE);
+        if (n == 0) {
+            if (fin_productor && spsc_ocupacion(&canal.cola) == 0) break;
+            sched_yield();
+            continue;
+        }
+
+        seqlock_escribir_inicio(&canal.lock);
+        for (size_t i = 0; i < n; i++) {
+            estadisticas_agregar(&canal.telemetry.stats, lote[i], 0);
+        }
+        seqlock_escribir_fin(&canal.lock);
+
+        uint64_t t = tiempo_ns();
+        for (size_t i = 0; i < n; i++, procesadas++) {
+            latencia[procesadas] = t - llegada[procesadas];
+        }
+    }
+    return NULL;
+}
+
+static int comparar(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void correr(const char *nombre, uint64_t periodo) {
+    canal_init(&canal, 0);
+    periodo_ns = periodo;
+    fin_productor = false;
+
+    pthread_t h1, h2;
+    uint64_t inicio = tiempo_ns();
+    pthread_create(&h2, NULL, etapa2, NULL);
+    pthread_create(&h1, NULL, etapa1, NULL);
+    pthread_join(h1, NULL);
+    pthread_join(h2, NULL);
+    double seg = (tiempo_ns() - inicio) / 1e9;
+
+    size_t n = canal.telemetry.stats.cuenta;
+    qsort(latencia, n, sizeof(latencia[0]), comparar);
+    printf("%-9s lecturas=%zu descartadas=%u max_cola=%u  %.0f lecturas/s  "
+           "latencia p50=%.1f us p99=%.1f us max=%.1f us\n",
+           nombre, n, canal.cola.descartados, canal.cola.max_ocupacion, n / seg,
+           n ? latencia[n / 2] / 1e3 : 0, n ? latencia[n * 99 / 100] / 1e3 : 0,
+           n ? latencia[n - 1] / 1e3 : 0);
+}
+
+int main(void) {
+    flujo = generar_flujo_caudal(LINEAS, 777, &flujo_largo);
+    llegada = malloc(LINEAS * sizeof(uint64_t));
+    latencia = malloc(LINEAS * sizeof(uint64_t));
+
+    correr("ritmo", 2000);     // Un bloque de 32 bytes cada 2 us (~16 MB/s)
+    correr("maximo", 0);
+
+    free(llegada);
+    free(latencia);
+    free((void *)flujo);
+    return 0;
+}
@@ -0,0 +1,250 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Benchmark del registro histórico (registro.h) en el computador: codifica y
+decodifica series sintéticas del caudalímetro y mide:
+  compresion  Bytes por lectura del registro contra texto ("NN\n", sin
+              tiempo), CSV con tiempo ("t_ms,NN\n") y un struct de 8 bytes.
+  velocidad   ns por lectura al codificar y al decodificar.
+  rango       Lecturas de un rango de 1 h sobre un archivo: búsqueda binaria
+              por cabeceras contra recorrer el archivo desde el inicio.
+Las series son: envío periódico (1 s con ±3 ms de variación), envío
+irregular (0,2 a 30 s) y ráfagas (cada 1-2 ms, el ritmo a 115200 baudios).
+El registro recibe el reloj de 32 bits; la serie irregular dura ~173 días y
+lo hace dar la vuelta más de una vez.
+
+Verifica que la decodificación devuelva exactamente lo codificado, que los
+dos métodos de rango coincidan, que el submuestreo no pierda lecturas y que
+una página con cabecera válida y cuerpo dañado no se lea fuera de la página.
+Cada resultado es una línea JSON; devuelve 1 si alguna verificación falla.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_registro bench_registro.c
+  ./bench_registro*/
+
+#include "bench_comun.h"
+#include "registro.h"
+
+#define LECTURAS 1000000
+#define CONSULTAS 200
+#define RANGO_MS (3600u * 1000u)
+
+typedef enum { PERIODICO, IRREGULAR, RAFAGAS } serie_t;
+static const char *const nombres[] = {"periodico", "irregular", "rafagas"};
+
+static registro_muestra_t *serie;
+static registro_muestra_t *decodificadas;
+static uint8_t *paginas;       // Páginas "guardadas", seguidas
+static registro_t registro;
+
+// ----------------------------------------------------
+// Serie sintética: el caudal hace un paseo al azar dentro de 0..99
+// ----------------------------------------------------
+static void generar_serie(serie_t tipo, uint32_t semilla) {
+    uint64_t t = 1000;
+    int valor = 50;
+    for (size_t i = 0; i < LECTURAS; i++) {
+        uint32_t r = aleatorio(&semilla);
+        switch (tipo) {
+        case PERIODICO: t += 997 + r % 7; break;
+        case IRREGULAR: t += 200 + r % 29800; break;
+        case RAFAGAS:   t += 1 + (r & 1); break;
+        }
+        valor += (int)((r >> 8) % 5) - 2;
+        if (valor < 0) valor = 0;
+        if (valor > 99) valor = 99;
+        serie[i].t = t;
+        serie[i].valor = (uint8_t)valor;
+    }
+}
+
+// ----------------------------------------------------
+// Codifica la serie; cada página cerrada se copia como si fuera a la flash
+// ----------------------------------------------------
+static size_t codificar(void) {
+    size_t n_paginas = 0;
+    registro_init(&registro, 0);
+    for (size_t i = 0; i < LECTURAS; i++) {
+        registro_agregar(&registro, (uint32_t)serie[i].t, serie[i].valor);
+        const uint8_t *p = registro_pagina_lista(&registro);
+        if (p != NULL) {
+            memcpy(&paginas[n_paginas++ * REGISTRO_PAGINA], p, REGISTRO_PAGINA);
+            registro_pagina_guardada(&registro);
+        }
+    }
+    if (registro.n > 0) {
+        registro_cerrar_pagina(&registro);
+        memcpy(&paginas[n_paginas++ * REGISTRO_PAGINA], registro_pagina_lista(&registro), REGISTRO_PAGINA);
+        registro_pagina_guardada(&registro);
+    }
+    return n_paginas;
+}
+
+static size_t decodificar(size_t n_paginas) {
+    size_t n = 0;
+    registro_cursor_t c;
+    for (size_t p = 0; p < n_paginas; p++) {
+        if (!registro_cursor_iniciar(&c, &paginas[p * REGISTRO_PAGINA])) continue;
+        while (registro_cursor_siguiente(&c, &decodificadas[n])) n++;
+    }
+    return n;
+}
+
+// Tamaño de la serie como CSV con tiempo
+static size_t largo_csv(void) {
+    size_t total = 0;
+    char linea[32];
+    for (size_t i = 0; i < LECTURAS; i++) {
+        total += (size_t)snprintf(linea, sizeof(linea), "%llu,%02u\n", (unsigned long long)serie[i].t, serie[i].valor);
+    }
+    return total;
+}
+
+// ----------------------------------------------------
+// Lee [desde, desde + RANGO_MS] y devuelve cuántas lecturas hubo. Con
+// 'buscar' falso recorre el archivo desde la primera página.
+// ----------------------------------------------------
+static size_t leer_rango(FILE *f, uint64_t desde, bool buscar, uint32_t *suma) {
+    static registro_lector_t lector;
+    registro_muestra_t m;
+    size_t n = 0;
+
+    registro_lector_abrir(&lector, f, buscar ? desde : 0);
+    lector.desde = desde;   // Sin búsqueda: igual filtra, pero decodificando todo lo anterior
+    *suma = 0;
+    while (registro_lector_siguiente(&lector, &m) && m.t <= desde + RANGO_MS) {
+        n++;
+        *suma += m.valor;
+    }
+    return n;
+}
+
+static void bench_serie(serie_t tipo) {
+    const char *caso = nombres[tipo];
+    generar_serie(tipo, 7 + (uint32_t)tipo);
+
+    // Codificar
+    uint64_t t0 = tiempo_ns();
+    size_t n_paginas = codificar();
+    double ns_codificar = (double)(tiempo_ns() - t0) / LECTURAS;
+    verificar(registro.perdidas == 0, "codificar: sin lecturas perdidas");
+    if (tipo == IRREGULAR) verificar(serie[LECTURAS - 1].t > UINT32_MAX, "serie: cruza la vuelta del reloj de 32 bits");
+
+    // Decodificar y comparar
+    t0 = tiempo_ns();
+    size_t n = decodificar(n_paginas);
+    double ns_decodificar = (double)(tiempo_ns() - t0) / LECTURAS;
+    verificar(n == LECTURAS, "decodificar: misma cantidad de lecturas");
+    verificar(memcmp(serie, decodificadas, LECTURAS * sizeof(*serie)) == 0,
+              "decodificar: mismas lecturas y tiempos");
+
+    double bytes = (double)n_paginas * REGISTRO_PAGINA;
+    reportar("registro", caso, "bytes_por_lectura", bytes / LECTURAS, "B");
+    reportar("registro", caso, "texto_sin_tiempo", 3.0, "B");
+    reportar("registro", caso, "csv_con_tiempo", (double)largo_csv() / LECTURAS, "B");
+    reportar("registro", caso, "struct", 8.0, "B");
+    reportar("registro", caso, "compresion_vs_csv", (double)largo_csv() / bytes, "x");
+    reportar("registro", caso, "paginas", (double)n_paginas, "paginas");
+    reportar("registro", caso, "codificar", ns_codificar, "ns/lectura");
+    reportar("registro", caso, "decodificar", ns_decodificar, "ns/lectura");
+
+    // Rangos sobre un archivo
+    FILE *f = tmpfile();
+    for (size_t p = 0; p < n_paginas; p++) registro_guardar(f, &paginas[p * REGISTRO_PAGINA]);
+
+    uint64_t inicio = serie[0].t, fin = serie[LECTURAS - 1].t;
+    uint32_t semilla = 99;
+    uint64_t ns_buscar = 0, ns_recorrer = 0;
+    size_t leidas = 0;
+    for (int q = 0; q < CONSULTAS; q++) {
+        uint64_t azar = (uint64_t)aleatorio(&semilla) << 32 | aleatorio(&semilla);
+        uint64_t desde = inicio + azar % (fin - inicio);
+        uint32_t suma_b, suma_r;
+
+        t0 = tiempo_ns();
+        size_t nb = leer_rango(f, desde, true, &suma_b);
+        ns_buscar += tiempo_ns() - t0;
+
+        t0 = tiempo_ns();
+        size_t nr = leer_rango(f, desde, false, &suma_r);
+        ns_recorrer += tiempo_ns() - t0;
+
+        verificar(nb == nr && suma_b == suma_r, "rango: búsqueda y recorrido coinciden");
+        leidas += nb;
+    }
+    reportar("registro", caso, "rango_1h_busqueda", (double)ns_buscar / CONSULTAS / 1000, "us/consulta");
+    reportar("registro", caso, "rango_1h_recorrido", (double)ns_recorrer / CONSULTAS / 1000, "us/consulta");
+    reportar("registro", caso, "rango_1h_lecturas", (double)leidas / CONSULTAS, "lecturas");
+
+    // Submuestreo de todo el archivo en intervalos de 10 min
+    static registro_lector_t lector;
+    registro_submuestreo_t sub;
+    registro_intervalo_t iv;
+    registro_muestra_t m;
+    size_t intervalos = 0, cuenta = 0;
+    registro_submuestreo_init(&sub, 600u * 1000u);
+    registro_lector_abrir(&lector, f, 0);
+    while (registro_lector_siguiente(&lector, &m)) {
+        if (registro_submuestreo_agregar(&sub, &m, &iv)) {
+            intervalos++;
+            cuenta += iv.cuenta;
+        }
+    }
+    if (registro_submuestreo_terminar(&sub, &iv)) {
+        intervalos++;
+        cuenta += iv.cuenta;
+    }
+    verificar(cuenta == LECTURAS, "submuestreo: todas las lecturas en algún intervalo");
+    reportar("registro", caso, "intervalos_10min", (double)intervalos, "intervalos");
+    fclose(f);
+}
+
+// ----------------------------------------------------
+// Páginas con cabecera válida y cuerpo borrado (0xFF) o en cero, con más
+// lecturas declaradas de las que caben: el cursor corta en los bits de la
+// cabecera. Compilado con -fsanitize=address, un acceso afuera se detiene.
+// ----------------------------------------------------
+static void bench_danadas(void) {
+    static const uint8_t cuerpos[] = {0xFF, 0x00};
+    static const char *const casos[] = {"danada_ff", "danada_00"};
+    uint8_t *pagina = malloc(REGISTRO_PAGINA);   // Justa: sin margen para leer de más
+
+    for (int i = 0; i < 2; i++) {
+        registro_cabecera_t cab = {0, 60000, REGISTRO_PAGINA * 8, 1000, 2000};
+        registro_cursor_t c;
+        registro_muestra_t m;
+        size_t n = 0;
+
+        memset(pagina, cuerpos[i], REGISTRO_PAGINA);
+        registro_escribir_cabecera(pagina, &cab);
+        verificar(registro_cursor_iniciar(&c, pagina), "dañada: cabecera válida");
+        while (registro_cursor_siguiente(&c, &m)) n++;
+        verificar(c.pos <= c.cab.bits && !registro_cursor_siguiente(&c, &m),
+                  "dañada: el cursor no sale de la página");
+        if (cuerpos[i] == 0x00) {
+            // Cada lectura en cero ocupa 1 + 7 bits: se leen todas las que caben
+            verificar(n == (REGISTRO_PAGINA - REGISTRO_CABECERA), "dañada: lecturas completas en cero");
+        }
+        reportar("registro", casos[i], "lecturas_leidas", (double)n, "lecturas");
+    }
+    free(pagina);
+}
+
+int main(void) {
+    serie = calloc(LECTURAS, sizeof(*serie));   // En cero: memcmp también compara el relleno
+    decodificadas = calloc(LECTURAS, sizeof(*decodificadas));
+    paginas = malloc((size_t)LECTURAS * 8 + 2 * REGISTRO_PAGINA);   // Peor caso: 43 bits por lectura
+
+    bench_serie(PERIODICO);
+    bench_serie(IRREGULAR);
+    bench_serie(RAFAGAS);
+    bench_danadas();
+
+    free(serie);
+    free(decodificadas);
+    free(paginas);
+    if (fallas) fprintf(stderr, "%d verificaciones fallaron\n", fallas);
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,277 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Benchmark de las sesiones de autenticación (sesiones.h) con 1 a 5 estaciones
+usadas a la vez, en tiempo virtual (DURACION_MS).
+
+Cada estación tiene su propio patrón y su propio guion de intentos, el mismo
+sin importar cuántas estaciones haya: correctos (APROBADO), con el último
+toque cambiado (NO APROBADO en ese toque), abandonados a medias (vence el
+tiempo entre toques) y completos sin validar (vence el de validación). Los
+flancos de todas las estaciones se mezclan en orden de tiempo y pasan por un
+solo despachador con el modelo de detección del Ejercicio 3 en modo
+interrupción: con todos los pads sueltos un toque llega en una medición del
+sensor (MEDICION_US); con algún pad tocado los flancos se ven en la próxima
+lectura (cada ESCANEO_US). Con una sola estación también la suelta llega por
+interrupción, en una medición.
+
+Mide, por número de estaciones:
+  despacho     ns por flanco de sesiones_flanco (tiempo real del computador).
+  veredicto    Del flanco físico que decide (toque de validación o toque que
+               no coincide) al evento: detección + despacho. p50/p99/max.
+  despertares  Despertares por segundo del despachador (interrupciones,
+               lecturas con pads tocados y tiempos límite), frente a una
+               tarea de sondeo cada SONDEO_US por estación.
+  sondeo       Latencia al veredicto si cada estación tuviera su tarea de
+               sondeo (fases repartidas), con el mismo despacho.
+Los guiones tienen cada estación en uso todo el tiempo: es el peor caso para
+las lecturas con pads tocados; con estaciones ociosas el despachador solo
+despierta con toques y tiempos límite, y el sondeo sigue igual.
+Verifica que cada estación cuente exactamente los veredictos y vencimientos
+de su guion (las demás estaciones no la afectan) y que no haya otros eventos.
+No cuenta la muestra de seguimiento de la línea base (igual en ambos casos).
+
+Cada resultado es una línea JSON (reportar() en bench_comun.h). Devuelve 1 si
+alguna verificación falla.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_sesiones bench_sesiones.c
+  ./bench_sesiones*/
+
+#include "bench_comun.h"
+#include "instrumentacion.h"
+#include "sesiones.h"
+
+#define DURACION_MS (8u * 3600u * 1000u)   // 8 h de uso
+#define MEDICION_US 200                    // Toque -> interrupción (una medición)
+#define ESCANEO_US 10000                   // TOUCH_SCAN_MS del Ejercicio 3
+#define SONDEO_US 50000                    // Una tarea de sondeo por estación
+#define LARGO_MIN_MS 3000
+#define ENTRE_MS 10000
+#define VALIDAR_MS 15000
+#define MAX_FLANCOS 400000
+
+typedef enum { CORRECTO = 0, ERRONEO, ABANDONO, SIN_VALIDAR, INTENTOS } intento_t;
+static const char *const nombres_intento[INTENTOS] = {"aprobados", "rechazados", "vencidos_entre", "vencidos_validar"};
+
+typedef struct {
+    uint64_t t_us;
+    uint8_t pad;
+    uint8_t tocado;
+    uint8_t decide;                // El flanco da el veredicto de su intento
+} flanco_t;
+
+static flanco_t flancos[MAX_FLANCOS];
+static size_t num_flancos;
+static uint32_t esperados[SESIONES_MAX][INTENTOS];
+static uint32_t obtenidos[SESIONES_MAX][INTENTOS];
+static uint32_t otros;             // Eventos que ningún guion produce
+
+static patron_t patrones[SESIONES_MAX];
+static sesion_config_t configs[SESIONES_MAX];
+
+static void agregar_flanco(uint64_t t_us, uint8_t pad, bool tocado, bool decide) {
+    verificar(num_flancos < MAX_FLANCOS, "espacio para los flancos");
+    if (num_flancos >= MAX_FLANCOS) return;
+    flancos[num_flancos++] = (flanco_t){t_us, pad, tocado, decide};
+}
+
+// Un toque de 'dur_ms' en 'pad' desde 't_us'; devuelve el momento en que se suelta
+static uint64_t tocar(uint64_t t_us, uint8_t pad, uint32_t dur_ms, bool decide_al_soltar) {
+    uint64_t fin = t_us + (uint64_t)dur_ms * 1000;
+    agregar_flanco(t_us, pad, true, false);
+    agregar_flanco(fin, pad, false, decide_al_soltar);
+    return fin;
+}
+
+// ----------------------------------------------------
+// Guion de una estación: intentos separados por pausas mayores que ambos
+// tiempos límite. La semilla depende solo de la estación.
+// ----------------------------------------------------
+static void generar_estacion(uint8_t id) {
+    const sesion_config_t *cfg = &configs[id];
+    const patron_t *p = &patrones[id];
+    uint32_t semilla = 100 + id;
+    uint64_t t = (uint64_t)(aleatorio(&semilla) % 20000) * 1000 + aleatorio(&semilla) % 1000;
+
+    while (t < (uint64_t)(DURACION_MS - 60000) * 1000) {
+        intento_t intento = (intento_t)(aleatorio(&semilla) % 10 < 6 ? CORRECTO : 1 + aleatorio(&semilla) % 3);
+        uint8_t toques = intento == ABANDONO ? (uint8_t)(1 + aleatorio(&semilla) % (p->largo - 1)) : p->largo;
+        uint32_t simbolos = intento == ERRONEO ? p->simbolos ^ (1u << (p->largo - 1)) : p->simbolos;
+
+        for (uint8_t i = 0; i < toques; i++) {
+            uint32_t dur = ((simbolos >> i) & 1) ? LARGO_MIN_MS + 200 + aleatorio(&semilla) % 1300
+                                                 : 200 + aleatorio(&semilla) % 1300;
+            bool ultimo = i + 1 == toques;
+            t = tocar(t, cfg->pad_ingreso, dur, ultimo && intento == ERRONEO);
+            t += (300 + aleatorio(&semilla) % 1700) * 1000ull + aleatorio(&semilla) % 1000;
+        }
+        if (intento == CORRECTO || intento == ERRONEO) {
+            // Tras un rechazo la validación ya no cuenta: no debe dar otro veredicto
+            t = tocar(t, cfg->pad_validar, 300 + aleatorio(&semilla) % 300, false);
+            flancos[num_flancos - 2].decide = intento == CORRECTO;
+        }
+        esperados[id][intento]++;
+        t += (VALIDAR_MS + 1000 + aleatorio(&semilla) % 5000) * 1000ull;
+    }
+}
+
+static int por_tiempo(const void *a, const void *b) {
+    const flanco_t *x = a, *y = b;
+    return x->t_us < y->t_us ? -1 : x->t_us > y->t_us;
+}
+
+static void contar(const sesion_evento_t *ev) {
+    switch (ev->tipo) {
+    case SESION_APROBADO:        obtenidos[ev->sesion][CORRECTO] += ev->patron == 0; break;
+    case SESION_RECHAZADO:       obtenidos[ev->sesion][ERRONEO]++; break;
+    case SESION_VENCIDO_ENTRE:   obtenidos[ev->sesion][ABANDONO]++; break;
+    case SESION_VENCIDO_VALIDAR: obtenidos[ev->sesion][SIN_VALIDAR]++; break;
+    case SESION_TOQUE:
+    case SESION_COMPLETA:        break;
+    default:                     otros++; break;
+    }
+}
+
+// Despierta al despachador en cada tiempo límite vencido antes de 'hasta_us'
+static uint32_t vencer_hasta(sesiones_t *s, uint64_t *ahora_us, uint64_t hasta_us) {
+    uint32_t despertares = 0;
+    while (1) {
+        uint32_t ahora_ms = (uint32_t)(*ahora_us / 1000);
+        uint32_t resta = sesiones_proximo_limite(s, ahora_ms);
+        if (resta == UINT32_MAX || (uint64_t)(ahora_ms + resta) * 1000 > hasta_us) return despertares;
+        *ahora_us = (uint64_t)(ahora_ms + resta) * 1000;
+
+        sesion_evento_t eventos[SESIONES_MAX];
+        int n = sesiones_vencer(s, ahora_ms + resta, eventos);
+        for (int i = 0; i < n; i++) contar(&eventos[i]);
+        despertares++;
+    }
+}
+
+static void correr(uint8_t n) {
+    static sesiones_t s;
+    char caso[16];
+    snprintf(caso, sizeof(caso), "%u_estaciones", n);
+
+    memset(esperados, 0, sizeof(esperados));
+    memset(obtenidos, 0, sizeof(obtenidos));
+    otros = 0;
+    num_flancos = 0;
+    sesiones_init(&s);
+    for (uint8_t id = 0; id < n; id++) {
+        verificar(sesiones_agregar(&s, &configs[id]) == id, "estación agregada");
+        generar_estacion(id);
+    }
+    qsort(flancos, num_flancos, sizeof(flanco_t), por_tiempo);
+
+    instr_hist_t despacho = INSTR_HIST("despacho");
+    instr_hist_t veredicto = INSTR_HIST("veredicto");
+    instr_hist_t sondeo = INSTR_HIST("sondeo");
+    uint32_t tocados = 0;          // Pads tocados según el despachador
+    bool escaneando = false;
+    uint64_t ancla = 0;            // Primera lectura del escaneo en curso
+    uint64_t libre = 0;            // Lectura que vio todos los pads sueltos
+    uint64_t ahora = 0;
+    uint32_t interrupciones = 0, lecturas = 0, vencimientos = 0;
+
+    for (size_t i = 0; i < num_flancos; i++) {
+        const flanco_t *f = &flancos[i];
+
+        // Momento en que el despachador ve el flanco
+        uint64_t visto;
+        if (n == 1) {
+            // Una estación: toque y suelta por interrupción (TOUCH_RELEASE_ISR)
+            verificar(tocados == (f->tocado ? 0 : 1u << f->pad), "una estación: un pad a la vez");
+            visto = f->t_us + MEDICION_US;
+            interrupciones++;
+            tocados ^= 1u << f->pad;
+        } else {
+            if (!escaneando && f->t_us < libre) {
+                escaneando = true;     // La lectura que vio la última suelta ya lo veía tocado
+                visto = libre;
+            } else if (!escaneando) {
+                escaneando = true;
+                visto = ancla = f->t_us + MEDICION_US;
+                interrupciones++;
+            } else {
+                visto = ancla + (f->t_us - ancla + ESCANEO_US - 1) / ESCANEO_US * ESCANEO_US;
+            }
+            tocados ^= 1u << f->pad;
+            if (tocados == 0) {
+                escaneando = false;
+                libre = visto;
+                lecturas += (uint32_t)((visto - ancla) / ESCANEO_US);
+            }
+        }
+
+        vencimientos += vencer_hasta(&s, &ahora, visto);
+        ahora = visto;
+
+        sesion_evento_t ev;
+        uint64_t t0 = tiempo_ns();
+        bool hay = sesiones_flanco(&s, f->pad, f->tocado, (uint32_t)(visto / 1000), &ev);
+        uint32_t ns = (uint32_t)(tiempo_ns() - t0);
+        instr_registrar(&despacho, ns);
+        if (hay) contar(&ev);
+
+        if (f->decide) {
+            verificar(hay && sesion_es_veredicto(ev.tipo), "veredicto en el flanco que decide");
+            instr_registrar(&veredicto, (uint32_t)((visto - f->t_us) * 1000) + ns);
+
+            // Con una tarea de sondeo por estación, desfasadas entre sí
+            uint64_t fase = (uint64_t)(f->pad / 2) * SONDEO_US / n;
+            uint64_t lectura = f->t_us < fase ? fase
+                             : fase + (f->t_us - fase + SONDEO_US - 1) / SONDEO_US * SONDEO_US;
+            instr_registrar(&sondeo, (uint32_t)((lectura - f->t_us) * 1000) + ns);
+        }
+    }
+    vencimientos += vencer_hasta(&s, &ahora, (uint64_t)DURACION_MS * 1000 + 60000000ull);
+
+    double segundos = DURACION_MS / 1000.0;
+    reportar(caso, "despacho", "p50", instr_percentil(&despacho, 50), "ns");
+    reportar(caso, "despacho", "p99", instr_percentil(&despacho, 99), "ns");
+    reportar(caso, "veredicto", "p50", instr_percentil(&veredicto, 50) / 1000.0, "us");
+    reportar(caso, "veredicto", "p99", instr_percentil(&veredicto, 99) / 1000.0, "us");
+    reportar(caso, "veredicto", "max", veredicto.max / 1000.0, "us");
+    reportar(caso, "sondeo", "p50", instr_percentil(&sondeo, 50) / 1000.0, "us");
+    reportar(caso, "sondeo", "p99", instr_percentil(&sondeo, 99) / 1000.0, "us");
+    reportar(caso, "despertares", "despachador", (interrupciones + lecturas + vencimientos) / segundos, "por_s");
+    reportar(caso, "despertares", "sondeo", n * (1000000.0 / SONDEO_US), "por_s");
+    reportar(caso, "despertares", "interrupciones", interrupciones, "despertares");
+    reportar(caso, "despertares", "lecturas", lecturas, "despertares");
+    reportar(caso, "flancos", "total", (double)num_flancos, "flancos");
+
+    for (uint8_t id = 0; id < n; id++) {
+        for (int k = 0; k < INTENTOS; k++) {
+            verificar(obtenidos[id][k] == esperados[id][k], "cada estación cuenta exactamente su guion");
+        }
+    }
+    for (int k = 0; k < INTENTOS; k++) {
+        uint32_t total = 0;
+        for (uint8_t id = 0; id < n; id++) total += obtenidos[id][k];
+        reportar(caso, "intentos", nombres_intento[k], total, "intentos");
+    }
+    verificar(otros == 0, "sin eventos fuera del guion");
+    verificar(tocados == 0, "todos los pads sueltos al final");
+}
+
+int main(void) {
+    uint32_t semilla = 7;
+    for (uint8_t id = 0; id < SESIONES_MAX; id++) {
+        uint8_t largo = (uint8_t)(5 + id);
+        patrones[id] = (patron_t)PATRON("estacion", largo, aleatorio(&semilla) & ((1u << largo) - 1));
+        configs[id] = (sesion_config_t){
+            .nombre = "estacion", .pad_ingreso = (uint8_t)(2 * id), .pad_validar = (uint8_t)(2 * id + 1),
+            .largo_min_ms = LARGO_MIN_MS, .entre_toques_ms = ENTRE_MS, .validar_ms = VALIDAR_MS,
+            .patrones = &patrones[id], .num_patrones = 1,
+        };
+    }
+
+    reportar("sesiones", "estado", "bytes_por_sesion", sizeof(sesion_t), "bytes");
+    reportar("sesiones", "estado", "bytes_estado_total", sizeof(((sesiones_t *)0)->sesion), "bytes");
+    for (uint8_t n = 1; n <= SESIONES_MAX; n++) correr(n);
+    return fallas ? 1 : 0;
+}
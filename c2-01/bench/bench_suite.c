@@ -0,0 +1,365 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Suite de benchmarks de los tres ejercicios sobre la capa hal.h. En el
+computador, hal.h reproduce guiones: bytes que llegan por el UART a un
+baudaje dado y trazas de valores de los pads táctiles. Se usan las mismas
+funciones de lectura y los mismos módulos que el firmware.
+
+Mide:
+  ingesta    Ejercicio 1: UART -> anillo -> validación -> estadísticas, a
+             distintos baudajes (ns por byte y bytes por lectura).
+  costo      Costo por muestra de validate_number, estadisticas_agregar y
+             cuadrados_procesar.
+  servicio   Ejercicio 2: pedidos por segundo de punta a punta (lectura,
+             cuadrados y escritura).
+  tactil     Ejercicio 3 en modo sondeo: la misma lectura de pads y línea
+             base, los mismos flancos hacia sesiones.h y los mismos tiempos
+             de la estación "Puerta". Latencia desde el toque de validación
+             (o el toque equivocado) hasta el veredicto, con sondeo cada
+             50 ms (el del firmware) y cada 10 ms (la lectura del modo por
+             interrupciones con pads tocados), y ns por muestra. El modo por
+             interrupciones con varias estaciones está en bench_sesiones.
+
+Cada resultado es una línea JSON en la salida estándar; guardarla permite
+comparar corridas y detectar regresiones. Devuelve 1 si alguna verificación
+falla.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_suite bench_suite.c
+  ./bench_suite > resultados.jsonl*/
+
+#include "bench_comun.h"
+#include "hal.h"
+#include "canal.h"
+#include "cuadrados.h"
+#include "patrones.h"
+#include "linea_base.h"
+#include "sesiones.h"
+
+#define LINEAS 300000
+#define PEDIDOS 200000
+#define SESIONES 200
+#define READ_TIMEOUT_MS 20     // Igual que el Ejercicio 1
+
+// ====================================================
+// Ejercicio 1: ingesta
+// ====================================================
+static void bench_ingesta(void) {
+    size_t largo;
+    uint8_t *flujo = generar_flujo_caudal(LINEAS, 1, &largo);
+    static const uint32_t baudajes[] = {0, 921600, 115200};
+    static canal_t canal;
+
+    for (size_t b = 0; b < sizeof(baudajes) / sizeof(baudajes[0]); b++) {
+        char caso[32];
+        snprintf(caso, sizeof(caso), baudajes[b] ? "uart_%u" : "uart_sin_limite", baudajes[b]);
+
+        hal_linux_reiniciar();
+        hal_linux_guion_uart(0, flujo, largo, baudajes[b]);
+        canal_init(&canal, 0);
+
+        uint64_t lecturas = 0;
+        uint64_t inicio = tiempo_ns();
+        while (!hal_linux_uart_terminado(0)) {
+            uint8_t *destino;
+            size_t espacio = ingesta_espacio(&canal.ingesta, &destino);
+            size_t n = hal_uart_leer_bloque(0, destino, espacio, READ_TIMEOUT_MS);
+            if (n == 0) continue;
+            ingesta_confirmar(&canal.ingesta, n);
+            canal_procesar_lineas(&canal, hal_ms());
+            lecturas++;
+        }
+        uint64_t ns = tiempo_ns() - inicio;
+
+        const telemetry_t *t = &canal.telemetry;
+        uint64_t lineas = t->stats.cuenta + t->err_longitud + t->err_no_digito + t->err_rango;
+        verificar(lineas == LINEAS, "ingesta: todas las líneas contadas");
+
+        reportar("ingesta", caso, "ns_por_byte", (double)ns / largo, "ns");
+        reportar("ingesta", caso, "bytes_por_s_cpu", largo / (ns / 1e9), "B/s");
+        reportar("ingesta", caso, "bytes_por_lectura", (double)largo / lecturas, "B");
+        reportar("ingesta", caso, "duracion_virtual", hal_ms() / 1000.0, "s");
+    }
+    free(flujo);
+}
+
+// ====================================================
+// Costo por muestra de cada etapa
+// ====================================================
+static void bench_costo(void) {
+    static canal_t canal;
+    canal_init(&canal, 0);
+
+    // validate_number sobre líneas ya separadas
+    static const char *lineas[] = {"7", "42", "99", "00", "100", "a", "5x", ""};
+    static const size_t largos[] = {1, 2, 2, 2, 3, 1, 2, 0};
+    int n_lineas = (int)(sizeof(lineas) / sizeof(lineas[0]));
+    volatile int suma = 0;
+    uint64_t inicio = tiempo_ns();
+    for (int i = 0; i < 4000000; i++) {
+        suma += validate_number(&canal, lineas[i % n_lineas], largos[i % n_lineas]);
+    }
+    reportar("costo", "validate_number", "ns_por_linea", (tiempo_ns() - inicio) / 4e6, "ns");
+
+    // estadisticas_agregar con el reloj avanzando 1 ms por muestra
+    estadisticas_t e;
+    estadisticas_init(&e);
+    uint32_t semilla = 3;
+    inicio = tiempo_ns();
+    for (uint32_t i = 0; i < 10000000; i++) estadisticas_agregar(&e, aleatorio(&semilla) % 100, i);
+    reportar("costo", "estadisticas_agregar", "ns_por_muestra", (tiempo_ns() - inicio) / 1e7, "ns");
+
+    // cuadrados_procesar sobre pedidos de 1 a 10 dígitos
+    char *texto = malloc(PEDIDOS * 12);
+    size_t largo = 0;
+    for (int i = 0; i < PEDIDOS; i++) largo += (size_t)sprintf(texto + largo, "%u\n", 1 + aleatorio(&semilla));
+    char *salida = malloc(CUADRADOS_SALIDA_MAX(largo));
+    cuadrados_t c;
+    cuadrados_init(&c);
+    inicio = tiempo_ns();
+    cuadrados_procesar(&c, (const uint8_t *)texto, largo, salida, CUADRADOS_SALIDA_MAX(largo));
+    reportar("costo", "cuadrados_procesar", "ns_por_pedido", (double)(tiempo_ns() - inicio) / PEDIDOS, "ns");
+    verificar(c.respondidos == PEDIDOS, "costo: todos los pedidos respondidos");
+    free(texto);
+    free(salida);
+}
+
+// ====================================================
+// Ejercicio 2: servicio de punta a punta (modo sondeo)
+// ====================================================
+static void bench_servicio(void) {
+    uint32_t semilla = 5;
+    char *texto = malloc(PEDIDOS * 12);
+    size_t largo = 0;
+    for (int i = 0; i < PEDIDOS; i++) largo += (size_t)sprintf(texto + largo, "%u\n", 1 + aleatorio(&semilla) % 100000);
+
+    static const uint32_t baudajes[] = {0, 921600};
+    for (size_t b = 0; b < sizeof(baudajes) / sizeof(baudajes[0]); b++) {
+        char caso[32];
+        snprintf(caso, sizeof(caso), baudajes[b] ? "uart_%u" : "uart_sin_limite", baudajes[b]);
+
+        static uint8_t entrada[1024];
+        static char salida[CUADRADOS_SALIDA_MAX(1024)];
+        cuadrados_t c;
+        cuadrados_init(&c);
+        hal_linux_reiniciar();
+        hal_linux_guion_uart(0, (const uint8_t *)texto, largo, baudajes[b]);
+
+        uint64_t inicio = tiempo_ns();
+        while (!hal_linux_uart_terminado(0)) {
+            int len = hal_uart_leer(0, entrada, sizeof(entrada), 20);
+            size_t n = len > 0 ? cuadrados_procesar(&c, entrada, (size_t)len, salida, sizeof(salida))
+                               : cuadrados_terminar(&c, salida, sizeof(salida));
+            if (n > 0) hal_uart_escribir(0, salida, n);
+        }
+        double seg = (tiempo_ns() - inicio) / 1e9;
+
+        verificar(c.respondidos == PEDIDOS, "servicio: todos los pedidos respondidos");
+        reportar("servicio", caso, "pedidos_por_s_cpu", PEDIDOS / seg, "1/s");
+        reportar("servicio", caso, "bytes_respuesta", (double)hal_linux.uart[0].escritos, "B");
+    }
+    free(texto);
+}
+
+// ====================================================
+// Ejercicio 3: latencia del toque al veredicto
+// ====================================================
+#define PAD_INGRESO 8
+#define PAD_VALIDAR 7
+#define REPOSO 1000            // Valor sin tocar al comienzo
+#define DERIVA 300             // Subida total del reposo a lo largo de la traza
+#define TOCADO 400             // Valor con el dedo encima
+#define LARGO_MIN_MS 3000      // Igual que LONG_TOUCH_MIN
+#define ENTRE_TOQUES_MS 10000  // Igual que MAX_BETWEEN_TOUCHES
+#define VALIDAR_MS 15000       // Igual que VALIDATION_TIMEOUT
+#define CAL_MUESTRAS 32        // Igual que TOUCH_CAL_SAMPLES
+#define CAL_PERIODO_MS 10      // Igual que TOUCH_CAL_PERIOD_MS
+#define ATASCADO_MS 60000      // Igual que TOUCH_STUCK_MS
+
+typedef struct {
+    uint64_t t_us;
+    uint8_t pad;
+    bool tocar;
+} evento_t;
+
+typedef struct {
+    bool correcta;             // Se ingresó el patrón y se validó
+    uint64_t t_ref_us;         // Toque de validación o suelta del toque equivocado
+} intento_t;
+
+static evento_t eventos[SESIONES * 24];
+static size_t n_eventos;
+static intento_t intentos[SESIONES];
+static hal_punto_touch_t *puntos;
+static size_t n_puntos;
+
+static void agregar_toque(uint64_t *t_us, uint8_t pad, uint64_t duracion_us) {
+    eventos[n_eventos++] = (evento_t){*t_us, pad, true};
+    eventos[n_eventos++] = (evento_t){*t_us + duracion_us, pad, false};
+    *t_us += duracion_us;
+}
+
+// ----------------------------------------------------
+// Sesiones alternadas: patrón correcto + validación, o el patrón con un toque
+// cambiado (el usuario se detiene en el toque equivocado). El reposo sube
+// DERIVA a lo largo de la traza para ejercitar la línea base. Los tiempos
+// tienen resolución de microsegundos, sin alinearse con el sondeo.
+// ----------------------------------------------------
+static uint64_t generar_traza(const patron_t *patron, uint32_t semilla) {
+    uint64_t t = 2000000;      // Deja lugar para la calibración
+    n_eventos = 0;
+
+    for (int s = 0; s < SESIONES; s++) {
+        bool correcta = (s & 1) == 0;
+        int equivocado = correcta ? -1 : (int)(aleatorio(&semilla) % patron->largo);
+
+        for (int i = 0; i < patron->largo; i++) {
+            t += 500000 + aleatorio(&semilla) % 1000000;
+            bool largo = (patron->simbolos >> i) & 1;
+            if (i == equivocado) largo = !largo;
+            uint64_t d = largo ? 3200000 + aleatorio(&semilla) % 800000 : 300000 + aleatorio(&semilla) % 1200000;
+            agregar_toque(&t, PAD_INGRESO, d);
+            if (i == equivocado) {
+                intentos[s] = (intento_t){false, t};
+                break;
+            }
+        }
+        if (correcta) {
+            t += 800000 + aleatorio(&semilla) % 1000;
+            intentos[s] = (intento_t){true, t};
+            agregar_toque(&t, PAD_VALIDAR, 300000);
+        }
+        t += 2000000;
+    }
+    uint64_t fin = t + 1000000;
+
+    // Puntos de la traza: el reposo de cada pad cada 100 ms (con deriva) y los eventos
+    puntos = malloc((fin / 100000 * 2 + n_eventos + 2) * sizeof(*puntos));
+    n_puntos = 0;
+    bool tocado[HAL_PADS] = {false};
+    size_t e = 0;
+    for (uint64_t t0 = 0; t0 < fin; t0 += 100000) {
+        uint16_t reposo = (uint16_t)(REPOSO + DERIVA * t0 / fin);
+        if (!tocado[PAD_INGRESO]) puntos[n_puntos++] = (hal_punto_touch_t){t0, PAD_INGRESO, reposo};
+        if (!tocado[PAD_VALIDAR]) puntos[n_puntos++] = (hal_punto_touch_t){t0, PAD_VALIDAR, reposo};
+        for (; e < n_eventos && eventos[e].t_us < t0 + 100000; e++) {
+            tocado[eventos[e].pad] = eventos[e].tocar;
+            puntos[n_puntos++] = (hal_punto_touch_t){eventos[e].t_us, eventos[e].pad,
+                                                     eventos[e].tocar ? TOCADO : reposo};
+        }
+    }
+    return fin;
+}
+
+static void bench_tactil(void) {
+    static const patron_t patron = PATRON("3 largos, 3 cortos, 3 largos", 9, 0x1C7);
+    static const sesion_config_t puerta = {
+        .nombre = "Puerta", .pad_ingreso = PAD_INGRESO, .pad_validar = PAD_VALIDAR,
+        .largo_min_ms = LARGO_MIN_MS, .entre_toques_ms = ENTRE_TOQUES_MS, .validar_ms = VALIDAR_MS,
+        .patrones = &patron, .num_patrones = 1,
+    };
+    static const uint8_t pads[] = {PAD_INGRESO, PAD_VALIDAR};
+    uint64_t fin = generar_traza(&patron, 7);
+
+    static const uint32_t periodos[] = {50, 10};
+    for (size_t p = 0; p < sizeof(periodos) / sizeof(periodos[0]); p++) {
+        char caso[32];
+        snprintf(caso, sizeof(caso), "sondeo_%ums", periodos[p]);
+
+        hal_linux_reiniciar();
+        hal_linux_guion_touch(puntos, n_puntos, REPOSO);
+
+        // Calibración como en el firmware (calibrate_touch_pads)
+        linea_base_t base[HAL_PADS];
+        for (int i = 0; i < 2; i++) {
+            linea_base_init(&base[pads[i]], LINEA_BASE_TOCAR_256, LINEA_BASE_SOLTAR_256,
+                            LINEA_BASE_DESPLAZAMIENTO, ATASCADO_MS / periodos[p]);
+            linea_base_calibrar(&base[pads[i]], CAL_MUESTRAS);
+        }
+        for (int k = 0; k < CAL_MUESTRAS; k++) {
+            for (int i = 0; i < 2; i++) {
+                uint16_t v;
+                hal_touch_leer(pads[i], &v);
+                linea_base_muestra(&base[pads[i]], v);
+            }
+            hal_esperar_ms(CAL_PERIODO_MS);
+        }
+
+        static sesiones_t estaciones;
+        sesiones_init(&estaciones);
+        verificar(sesiones_agregar(&estaciones, &puerta) == 0, "tactil: estación agregada");
+        uint32_t tocados = 0;
+        int s = 0, otros = 0;
+        double suma_ok = 0, suma_rechazo = 0;
+        uint64_t max_ok = 0, max_rechazo = 0;
+        int n_ok = 0, n_rechazo = 0;
+        uint64_t muestras = 0;
+
+        uint64_t inicio = tiempo_ns();
+        while (hal_us() < fin && s < SESIONES) {
+            // sample_touch_pads + dispatch_touch_pads + check_timeouts del Ejercicio 3
+            uint32_t tocado = 0;
+            for (int i = 0; i < 2; i++) {
+                uint16_t v;
+                hal_touch_leer_filtrado(pads[i], &v);
+                if (linea_base_muestra(&base[pads[i]], v)) tocado |= 1u << pads[i];
+            }
+            uint32_t ahora_ms = hal_ms();
+            uint32_t soltados = tocados & ~tocado, nuevos = tocado & ~tocados;
+            tocados = tocado;
+            muestras++;
+
+            sesion_evento_t ev[2 + SESIONES_MAX];
+            int n = 0;
+            for (int i = 0; i < 2; i++) {
+                if ((soltados >> pads[i]) & 1) n += sesiones_flanco(&estaciones, pads[i], false, ahora_ms, &ev[n]);
+            }
+            for (int i = 0; i < 2; i++) {
+                if ((nuevos >> pads[i]) & 1) n += sesiones_flanco(&estaciones, pads[i], true, ahora_ms, &ev[n]);
+            }
+            n += sesiones_vencer(&estaciones, ahora_ms, &ev[n]);
+
+            for (int k = 0; k < n; k++) {
+                if (!sesion_es_veredicto(ev[k].tipo)) {
+                    otros += ev[k].tipo != SESION_TOQUE && ev[k].tipo != SESION_COMPLETA;
+                    continue;
+                }
+                bool aprobado = ev[k].tipo == SESION_APROBADO;
+                uint64_t latencia = hal_us() - intentos[s].t_ref_us;
+                verificar(aprobado == intentos[s].correcta, "tactil: veredicto esperado");
+                if (aprobado) {
+                    suma_ok += latencia;
+                    n_ok++;
+                    if (latencia > max_ok) max_ok = latencia;
+                } else {
+                    suma_rechazo += latencia;
+                    n_rechazo++;
+                    if (latencia > max_rechazo) max_rechazo = latencia;
+                }
+                s++;
+            }
+            hal_esperar_ms(periodos[p]);
+        }
+        uint64_t ns = tiempo_ns() - inicio;
+
+        verificar(s == SESIONES, "tactil: un veredicto por sesión");
+        verificar(otros == 0, "tactil: sin vencimientos ni errores de validación");
+        reportar("tactil", caso, "latencia_aprobado_prom", n_ok ? suma_ok / n_ok / 1000 : 0, "ms");
+        reportar("tactil", caso, "latencia_aprobado_max", max_ok / 1000.0, "ms");
+        reportar("tactil", caso, "latencia_rechazo_prom", n_rechazo ? suma_rechazo / n_rechazo / 1000 : 0, "ms");
+        reportar("tactil", caso, "latencia_rechazo_max", max_rechazo / 1000.0, "ms");
+        reportar("tactil", caso, "ns_por_muestra", (double)ns / muestras, "ns");
+    }
+    free(puntos);
+}
+
+int main(void) {
+    bench_ingesta();
+    bench_costo();
+    bench_servicio();
+    bench_tactil();
+    return fallas ? 1 : 0;
+}
@@ -0,0 +1,343 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Benchmark del protocolo binario (trama.h) contra el texto, en el computador.
+
+Mide, para las mismas lecturas y los mismos pedidos:
+  lecturas   Ejercicio 1: líneas "NN\n" por la ingesta contra tramas
+             TRAMA_LECTURAS de 1, 16 y 64 lecturas (canal.h).
+  cuadrados  Ejercicio 2: pedidos en texto contra tramas TRAMA_PEDIDOS de
+             1, 16 y 64 enteros (cuadrados.h).
+Para cada modo: bytes por mensaje en el cable, mensajes por segundo que
+admite el UART a 9600 y 115200 baudios y ns de CPU por mensaje. Comprueba
+que los dos modos dan las mismas estadísticas y los mismos cuadrados.
+
+  daños      Tramas con bytes cambiados, perdidos o basura intercalada: toda
+             trama entregada debe ser idéntica a una enviada, y las dañadas
+             se cuentan como error en vez de entregarse.
+  respuesta  Una respuesta de texto de METRICAS_MAX - 1 bytes (Ejercicio 2)
+             repartida en tramas TRAMA_TEXTO llega completa; en una sola
+             trama el receptor la descarta por largo.
+
+Cada resultado es una línea JSON (reportar() en bench_comun.h). Devuelve 1 si
+alguna verificación falla.
+
+Compilar y ejecutar:
+  gcc -O2 -I.. -o bench_tramas bench_tramas.c
+  ./bench_tramas*/
+
+#include "bench_comun.h"
+#define CANAL_BINARIO 1
+#include "canal.h"
+#include "cuadrados.h"
+#include "trama.h"
+
+#define LECTURAS 1000000
+#define PEDIDOS 500000
+#define BLOQUE 128             // Bytes por lectura del driver (BUF_SIZE del Ejercicio 1)
+#define BLOQUE_CUADRADOS 1024  // BUF_SIZE del Ejercicio 2
+#define TRAMAS_DANADAS 100000
+
+// Mensajes por segundo que admite un UART de 'baudios' (10 bits por byte)
+static double por_uart(double bytes_por_mensaje, double baudios) {
+    return baudios / 10.0 / bytes_por_mensaje;
+}
+
+static void reportar_modo(const char *bench, const char *caso, double bytes, size_t mensajes, uint64_t ns) {
+    reportar(bench, caso, "bytes_por_mensaje", bytes / mensajes, "B");
+    reportar(bench, caso, "mensajes_por_s_9600", por_uart(bytes / mensajes, 9600), "1/s");
+    reportar(bench, caso, "mensajes_por_s_115200", por_uart(bytes / mensajes, 115200), "1/s");
+    reportar(bench, caso, "ns_por_mensaje", (double)ns / mensajes, "ns");
+    reportar(bench, caso, "mensajes_por_s_cpu", mensajes / (ns / 1e9), "1/s");
+}
+
+// ----------------------------------------------------
+// Agrupa 'n' valores de 'ancho' bytes en tramas de 'por_trama' valores
+// ----------------------------------------------------
+static uint8_t *armar_tramas(uint8_t tipo, const uint8_t *valores, size_t n, size_t ancho,
+                             size_t por_trama, size_t *largo) {
+    size_t tramas = (n + por_trama - 1) / por_trama;
+    uint8_t *datos = malloc(tramas * TRAMA_CODIFICADA_MAX(por_trama * ancho));
+    size_t total = 0;
+    for (size_t i = 0; i < n; i += por_trama) {
+        size_t k = n - i < por_trama ? n - i : por_trama;
+        total += trama_codificar(tipo, valores + i * ancho, k * ancho, datos + total);
+    }
+    *largo = total;
+    return datos;
+}
+
+// ====================================================
+// Ejercicio 1: lecturas del caudalímetro
+// ====================================================
+static void bench_lecturas(void) {
+    static canal_t canal;
+    uint8_t *valores = malloc(LECTURAS);
+    char *texto = malloc(LECTURAS * 4);
+    size_t largo_texto = 0;
+    uint32_t semilla = 11;
+
+    for (size_t i = 0; i < LECTURAS; i++) {
+        valores[i] = (uint8_t)(aleatorio(&semilla) % 100);
+        largo_texto += (size_t)sprintf(texto + largo_texto, "%02u\n", valores[i]);
+    }
+
+    // Texto: ingesta, separación de líneas y validate_number
+    canal_init(&canal, 0);
+    uint64_t inicio = tiempo_ns();
+    for (size_t pos = 0; pos < largo_texto;) {
+        uint8_t *destino;
+        size_t n = ingesta_espacio(&canal.ingesta, &destino);
+        if (n > BLOQUE) n = BLOQUE;
+        if (n > largo_texto - pos) n = largo_texto - pos;
+        memcpy(destino, texto + pos, n);
+        ingesta_confirmar(&canal.ingesta, n);
+        canal_procesar_lineas(&canal, 0);
+        pos += n;
+    }
+    uint64_t ns = tiempo_ns() - inicio;
+    estadisticas_t referencia = canal.telemetry.stats;
+    verificar(referencia.cuenta == LECTURAS, "lecturas: texto completo");
+    reportar_modo("lecturas", "texto", (double)largo_texto, LECTURAS, ns);
+
+    static const size_t por_trama[] = {1, 16, 64};
+    for (size_t t = 0; t < sizeof(por_trama) / sizeof(por_trama[0]); t++) {
+        char caso[32];
+        snprintf(caso, sizeof(caso), "binario_%zu", por_trama[t]);
+        size_t largo;
+        uint8_t *tramas = armar_tramas(TRAMA_LECTURAS, valores, LECTURAS, 1, por_trama[t], &largo);
+
+        canal_init(&canal, 0);
+        inicio = tiempo_ns();
+        for (size_t pos = 0; pos < largo; pos += BLOQUE) {
+            size_t n = largo - pos < BLOQUE ? largo - pos : BLOQUE;
+            canal_procesar_tramas(&canal, tramas + pos, n, 0);
+        }
+        ns = tiempo_ns() - inicio;
+
+        const estadisticas_t *e = &canal.telemetry.stats;
+        verificar(e->cuenta == referencia.cuenta && e->suma == referencia.suma &&
+                  memcmp(e->histograma, referencia.histograma, sizeof(e->histograma)) == 0,
+                  "lecturas: mismas estadísticas que el texto");
+        verificar(trama_rx_errores(&canal.tramas) == 0, "lecturas: sin tramas dañadas");
+        reportar_modo("lecturas", caso, (double)largo, LECTURAS, ns);
+        free(tramas);
+    }
+    free(valores);
+    free(texto);
+}
+
+// ====================================================
+// Ejercicio 2: servicio de cuadrados
+// ====================================================
+static void bench_cuadrados(void) {
+    uint8_t *valores = malloc(PEDIDOS * 4);
+    char *texto = malloc(PEDIDOS * 12);
+    size_t largo_texto = 0;
+    uint32_t semilla = 13;
+
+    for (size_t i = 0; i < PEDIDOS; i++) {
+        uint32_t v = 1 + aleatorio(&semilla) % 100000;
+        for (int b = 0; b < 4; b++) valores[4 * i + b] = (uint8_t)(v >> (8 * b));
+        largo_texto += (size_t)sprintf(texto + largo_texto, "%u\n", v);
+    }
+
+    static char salida[CUADRADOS_SALIDA_MAX(BLOQUE_CUADRADOS) + CUADRADOS_TRAMA_SALIDA_MAX];
+    uint64_t *esperados = malloc(PEDIDOS * sizeof(uint64_t));
+    size_t n_esperados = 0;
+    cuadrados_t c;
+
+    // Texto: se guardan los cuadrados como referencia
+    cuadrados_init(&c);
+    size_t salida_texto = 0;
+    uint64_t inicio, ns = 0;
+    for (size_t pos = 0; pos < largo_texto; pos += BLOQUE_CUADRADOS) {
+        size_t n = largo_texto - pos < BLOQUE_CUADRADOS ? largo_texto - pos : BLOQUE_CUADRADOS;
+        inicio = tiempo_ns();
+        size_t escritos = cuadrados_procesar(&c, (const uint8_t *)texto + pos, n, salida, sizeof(salida));
+        ns += tiempo_ns() - inicio;
+        salida_texto += escritos;
+        for (char *p = salida; p < salida + escritos; p++) {
+            uint64_t v = 0;
+            while (*p != '\n') v = v * 10 + (uint64_t)(*p++ - '0');
+            esperados[n_esperados++] = v;
+        }
+    }
+    verificar(c.respondidos == PEDIDOS && n_esperados == PEDIDOS, "cuadrados: texto completo");
+    // El cable es full dúplex: limita el sentido con más bytes
+    reportar_modo("cuadrados", "texto", (double)(largo_texto > salida_texto ? largo_texto : salida_texto),
+                  PEDIDOS, ns);
+
+    static const size_t por_trama[] = {1, 16, 64};
+    for (size_t t = 0; t < sizeof(por_trama) / sizeof(por_trama[0]); t++) {
+        char caso[32];
+        snprintf(caso, sizeof(caso), "binario_%zu", por_trama[t]);
+        size_t largo;
+        uint8_t *tramas = armar_tramas(TRAMA_PEDIDOS, valores, PEDIDOS, 4, por_trama[t], &largo);
+
+        trama_rx_t rx, rx_respuestas;
+        trama_rx_init(&rx);
+        trama_rx_init(&rx_respuestas);
+        cuadrados_init(&c);
+        size_t salida_binaria = 0, recibidos = 0;
+        bool iguales = true;
+        ns = 0;
+
+        for (size_t pos = 0; pos < largo; pos += BLOQUE_CUADRADOS) {
+            size_t n = largo - pos < BLOQUE_CUADRADOS ? largo - pos : BLOQUE_CUADRADOS;
+            inicio = tiempo_ns();
+            size_t escritos = cuadrados_procesar_tramas(&c, &rx, tramas + pos, n, (uint8_t *)salida,
+                                                        sizeof(salida));
+            ns += tiempo_ns() - inicio;
+            salida_binaria += escritos;
+
+            // Decodificar las respuestas como lo haría el cliente (fuera de la medición)
+            const uint8_t *p = (const uint8_t *)salida;
+            const uint8_t *carga;
+            size_t resto = escritos, k;
+            uint8_t tipo;
+            while ((carga = trama_rx_siguiente(&rx_respuestas, &p, &resto, &tipo, &k)) != NULL) {
+                for (size_t j = 0; j + 8 <= k; j += 8) {
+                    uint64_t v = 0;
+                    for (int b = 7; b >= 0; b--) v = v << 8 | carga[j + b];
+                    if (recibidos >= PEDIDOS || v != esperados[recibidos]) iguales = false;
+                    recibidos++;
+                }
+            }
+        }
+
+        verificar(c.respondidos == PEDIDOS && recibidos == PEDIDOS && iguales,
+                  "cuadrados: mismas respuestas que el texto");
+        verificar(trama_rx_errores(&rx) == 0 && trama_rx_errores(&rx_respuestas) == 0,
+                  "cuadrados: sin tramas dañadas");
+        reportar_modo("cuadrados", caso, (double)(largo > salida_binaria ? largo : salida_binaria),
+                      PEDIDOS, ns);
+        free(tramas);
+    }
+    free(valores);
+    free(texto);
+    free(esperados);
+}
+
+// ====================================================
+// Robustez: tramas dañadas
+// ====================================================
+#define LECTURAS_POR_TRAMA 16
+
+static void bench_danos(void) {
+    // Trama i: LECTURAS_POR_TRAMA lecturas iguales a i % 100. Una trama
+    // entregada con otro largo o con lecturas distintas estaría mal armada.
+    uint8_t *limpio = malloc(TRAMAS_DANADAS * TRAMA_CODIFICADA_MAX(LECTURAS_POR_TRAMA));
+    size_t largo = 0;
+    for (size_t i = 0; i < TRAMAS_DANADAS; i++) {
+        uint8_t lecturas[LECTURAS_POR_TRAMA];
+        memset(lecturas, (int)(i % 100), sizeof(lecturas));
+        largo += trama_codificar(TRAMA_LECTURAS, lecturas, sizeof(lecturas), limpio + largo);
+    }
+
+    // Daños: 1 de cada 500 bytes cambiado, perdido o seguido de basura
+    uint8_t *sucio = malloc(largo * 2);
+    size_t n = 0, danos = 0;
+    uint32_t semilla = 17;
+    for (size_t i = 0; i < largo; i++) {
+        uint32_t r = aleatorio(&semilla);
+        if (r % 500 != 0) {
+            sucio[n++] = limpio[i];
+            continue;
+        }
+        danos++;
+        switch ((r >> 16) % 3) {
+            case 0: sucio[n++] = (uint8_t)(limpio[i] ^ (1u << ((r >> 8) % 8))); break;
+            case 1: break;
+            default:
+                sucio[n++] = limpio[i];
+                for (uint32_t k = 0; k < 1 + (r >> 8) % 40; k++) sucio[n++] = (uint8_t)aleatorio(&semilla);
+                break;
+        }
+    }
+
+    trama_rx_t rx;
+    trama_rx_init(&rx);
+    size_t entregadas = 0, mal_armadas = 0;
+    const uint8_t *p = sucio;
+    size_t resto = n;
+    const uint8_t *carga;
+    size_t k;
+    uint8_t tipo;
+
+    uint64_t inicio = tiempo_ns();
+    while ((carga = trama_rx_siguiente(&rx, &p, &resto, &tipo, &k)) != NULL) {
+        entregadas++;
+        bool ok = tipo == TRAMA_LECTURAS && k == LECTURAS_POR_TRAMA;
+        for (size_t j = 1; ok && j < k; j++) ok = carga[j] == carga[0];
+        if (!ok) mal_armadas++;
+    }
+    uint64_t ns = tiempo_ns() - inicio;
+
+    verificar(mal_armadas == 0, "danos: ninguna trama mal armada entregada");
+    verificar(entregadas < TRAMAS_DANADAS && trama_rx_errores(&rx) > 0, "danos: tramas dañadas contadas");
+    reportar("danos", "1_de_500", "tramas_enviadas", TRAMAS_DANADAS, "");
+    reportar("danos", "1_de_500", "bytes_danados", (double)danos, "");
+    reportar("danos", "1_de_500", "tramas_entregadas", (double)entregadas, "");
+    reportar("danos", "1_de_500", "tramas_mal_armadas", (double)mal_armadas, "");
+    reportar("danos", "1_de_500", "err_cobs", rx.err_cobs, "");
+    reportar("danos", "1_de_500", "err_crc", rx.err_crc, "");
+    reportar("danos", "1_de_500", "err_largo", rx.err_largo, "");
+    reportar("danos", "1_de_500", "ns_por_byte", (double)ns / n, "ns");
+    free(limpio);
+    free(sucio);
+}
+
+// ====================================================
+// Respuesta larga a un comando ("!perf", "?") en modo binario
+// ====================================================
+#define RESPUESTA_LARGO 511    // METRICAS_MAX - 1 del Ejercicio 2
+
+// Decodifica 'largo' bytes y junta los datos de las tramas TRAMA_TEXTO
+static size_t recibir_texto(trama_rx_t *rx, const uint8_t *cable, size_t largo, uint8_t *texto,
+                            size_t *tramas) {
+    const uint8_t *carga;
+    size_t recibido = 0, k;
+    uint8_t tipo;
+    *tramas = 0;
+    while ((carga = trama_rx_siguiente(rx, &cable, &largo, &tipo, &k)) != NULL) {
+        if (tipo != TRAMA_TEXTO || recibido + k > RESPUESTA_LARGO) continue;
+        memcpy(texto + recibido, carga, k);
+        recibido += k;
+        (*tramas)++;
+    }
+    return recibido;
+}
+
+static void bench_respuesta_larga(void) {
+    static uint8_t texto[RESPUESTA_LARGO], recibido[RESPUESTA_LARGO];
+    static uint8_t cable[TRAMA_VARIAS_MAX(RESPUESTA_LARGO)];
+    for (size_t i = 0; i < RESPUESTA_LARGO; i++) texto[i] = (i % 64 == 63) ? '\n' : (uint8_t)('a' + i % 26);
+
+    trama_rx_t rx;
+    size_t tramas;
+    trama_rx_init(&rx);
+    size_t largo = trama_codificar_varias(TRAMA_TEXTO, texto, RESPUESTA_LARGO, cable);
+    size_t n = recibir_texto(&rx, cable, largo, recibido, &tramas);
+    verificar(n == RESPUESTA_LARGO && memcmp(texto, recibido, n) == 0 && trama_rx_errores(&rx) == 0,
+              "respuesta: texto largo completo en varias tramas");
+    reportar("respuesta", "varias_tramas", "tramas", (double)tramas, "tramas");
+    reportar("respuesta", "varias_tramas", "bytes_en_cable", (double)largo, "B");
+
+    // Todo en una trama: más que TRAMA_MAX_DATOS, el receptor la descarta
+    trama_rx_init(&rx);
+    largo = trama_codificar(TRAMA_TEXTO, texto, RESPUESTA_LARGO, cable);
+    n = recibir_texto(&rx, cable, largo, recibido, &tramas);
+    verificar(n == 0 && rx.err_largo == 1, "respuesta: una sola trama larga se descarta");
+    reportar("respuesta", "una_trama", "err_largo", rx.err_largo, "");
+}
+
+int main(void) {
+    bench_lecturas();
+    bench_cuadrados();
+    bench_danos();
+    bench_respuesta_larga();
+    return fallas ? 1 : 0;
+}
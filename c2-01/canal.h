@@ -0,0 +1,333 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Canal de adquisición: un caudalímetro conectado a un UART. Cada canal tiene
+su propia ingesta, sus estadísticas y sus contadores de error, de modo que
+varios lectores pueden trabajar en paralelo sin compartir estado.
+
+El canal se puede usar en una sola etapa (canal_procesar_lineas) o en dos:
+la etapa 1 separa y valida líneas y encola lecturas de 8 bits
+(canal_encolar_lineas); la etapa 2, en otro núcleo, las saca por lotes y
+actualiza las estadísticas (canal_drenar). Las estadísticas tienen un solo
+escritor y se publican con un seqlock; los errores los escribe solo quien
+valida. El agregador únicamente copia.
+
+Con CANAL_REGISTRO 1 quien actualiza las estadísticas también agrega cada
+lectura al registro histórico del canal (registro.h). Las líneas que empiezan
+con '!' no son lecturas: se guardan como comando para quien lee el canal.
+
+Con CANAL_BINARIO 1 el lector también puede recibir tramas (trama.h) en vez
+de líneas: cada trama TRAMA_LECTURAS trae muchas lecturas de un byte, que se
+validan y procesan igual que las de texto; las tramas dañadas se cuentan en
+'err_trama'. Las tramas TRAMA_COMANDO llevan el texto de un comando ('!...').
+
+No depende de ESP-IDF (el lector y el reloj los pone quien lo usa).*/
+
+#ifndef CANAL_H
+#define CANAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "ingesta_uart.h"
+#include "estadisticas.h"
+#include "seqlock.h"
+#include "spsc.h"
+
+#ifndef CANAL_REGISTRO
+#define CANAL_REGISTRO 0
+#endif
+#if CANAL_REGISTRO
+#include "registro.h"
+#endif
+
+#ifndef CANAL_BINARIO
+#define CANAL_BINARIO 0
+#endif
+#if CANAL_BINARIO
+#include "trama.h"
+#endif
+
+#ifndef MAX_NUM
+#define MAX_NUM 99             // Máximo valor permitido
+#endif
+#ifndef MIN_NUM
+#define MIN_NUM 0              // Mínimo valor permitido
+#endif
+
+#define CANAL_LOTE 64          // Lecturas que la etapa 2 saca de la cola por vez
+#define CANAL_COMANDO_MAX 32   // Largo máximo de un comando ('!...'), con el '\0'
+
+// ----------------------------------------------------
+// Estado publicado por el lector de un canal
+// ----------------------------------------------------
+typedef struct {
+    estadisticas_t stats;      // Lecturas válidas (histograma + ventanas de tiempo)
+    uint32_t err_longitud;     // Líneas con 0 o más de 2 caracteres
+    uint32_t err_no_digito;    // Líneas con caracteres que no son dígitos
+    uint32_t err_rango;        // Números fuera de MIN_NUM..MAX_NUM
+    uint32_t descartadas;      // Lecturas perdidas por cola llena (modo de dos etapas)
+    uint32_t err_trama;        // Tramas dañadas o desconocidas (modo binario)
+} telemetry_t;
+
+typedef struct {
+    int id;                    // Número de canal (para los reportes)
+    ingesta_t ingesta;         // Anillo de recepción (solo lo toca el lector)
+    spsc_t cola;               // Lecturas validadas, de la etapa 1 a la etapa 2
+    telemetry_t telemetry;     // 'stats' la escribe quien procesa; los errores, quien valida
+    seqlock_t lock;            // Protege 'telemetry.stats' para las instantáneas
+    char comando[CANAL_COMANDO_MAX]; // Último comando recibido (solo lo toca el lector)
+    bool comando_listo;
+#if CANAL_REGISTRO
+    registro_t registro;       // Lo escribe quien procesa; las páginas llenas las guarda otra tarea
+#endif
+#if CANAL_BINARIO
+    trama_rx_t tramas;         // Receptor de tramas (solo lo toca el lector)
+#endif
+} canal_t;
+
+static inline void canal_init(canal_t *canal, int id) {
+    memset(canal, 0, sizeof(*canal));
+    canal->id = id;
+    ingesta_init(&canal->ingesta);
+    spsc_init(&canal->cola);
+    estadisticas_init(&canal->telemetry.stats);
+#if CANAL_REGISTRO
+    registro_init(&canal->registro, (uint8_t)id);
+#endif
+#if CANAL_BINARIO
+    trama_rx_init(&canal->tramas);
+#endif
+}
+
+// ----------------------------------------------------
+// Función que actualiza estadísticas con el nuevo número recibido
+// ----------------------------------------------------
+static inline void process_number(canal_t *canal, int num, uint32_t ahora_ms) {
+    seqlock_escribir_inicio(&canal->lock);
+    estadisticas_agregar(&canal->telemetry.stats, (uint8_t)num, ahora_ms);
+    seqlock_escribir_fin(&canal->lock);
+#if CANAL_REGISTRO
+    registro_agregar(&canal->registro, ahora_ms, (uint8_t)num);
+#endif
+}
+
+// ----------------------------------------------------
+// Suma un error al contador indicado (sin imprimir en la ruta de recepción).
+// Cada contador tiene un solo escritor, así que basta un store atómico.
+// ----------------------------------------------------
+static inline void canal_contar_error(uint32_t *contador) {
+    __atomic_store_n(contador, *contador + 1, __ATOMIC_RELAXED);
+}
+
+// ----------------------------------------------------
+// Función que valida si la línea ingresada ('len' bytes) es un número válido.
+// Se usa el largo de la línea y no strlen: un byte 0 en medio de la basura
+// cortaría la línea y dejaría pasar, p. ej., "5\0xyz" como un 5.
+// ----------------------------------------------------
+static inline int validate_number(canal_t *canal, const char *str, size_t len) {
+    // Verificar longitud (debe tener 1 o 2 caracteres)
+    if (len == 0 || len > 2) {
+        canal_contar_error(&canal->telemetry.err_longitud);
+        return -1;
+    }
+
+    // Verificar que todos los caracteres sean dígitos
+    for (size_t i = 0; i < len; i++) {
+        if (!isdigit((unsigned char)str[i])) {
+            canal_contar_error(&canal->telemetry.err_no_digito);
+            return -1;
+        }
+    }
+
+    // Convertir a entero y validar rango
+    int num = atoi(str);
+    if (num < MIN_NUM || num > MAX_NUM) {
+        canal_contar_error(&canal->telemetry.err_rango);
+        return -1;
+    }
+
+    return num;
+}
+
+// ----------------------------------------------------
+// Si la línea es un comando ('!...') la guarda para el lector y devuelve true
+// ----------------------------------------------------
+static inline bool canal_tomar_comando(canal_t *canal, const char *line, size_t line_len) {
+    if (line[0] != '!') return false;
+    if (line_len >= CANAL_COMANDO_MAX) line_len = CANAL_COMANDO_MAX - 1;
+    memcpy(canal->comando, line, line_len);
+    canal->comando[line_len] = '\0';
+    canal->comando_listo = true;
+    return true;
+}
+
+// ----------------------------------------------------
+// Valida y procesa todas las líneas completas que hay en la ingesta.
+// Devuelve cuántas lecturas válidas se procesaron.
+// ----------------------------------------------------
+static inline int canal_procesar_lineas(canal_t *canal, uint32_t ahora_ms) {
+    const char *line;
+    size_t line_len;
+    int aceptadas = 0;
+
+    while ((line = ingesta_siguiente_linea(&canal->ingesta, &line_len)) != NULL) {
+        if (canal_tomar_comando(canal, line, line_len)) continue;
+        int num = validate_number(canal, line, line_len);  // Validar el número
+        if (num != -1) {
+            process_number(canal, num, ahora_ms); // Si es válido, procesarlo
+            aceptadas++;
+        }
+    }
+    return aceptadas;
+}
+
+// ----------------------------------------------------
+// Etapa 1 (modo de dos etapas): valida las líneas completas y encola las
+// lecturas válidas. Devuelve cuántas se encolaron.
+// ----------------------------------------------------
+static inline int canal_encolar_lineas(canal_t *canal) {
+    const char *line;
+    size_t line_len;
+    int encoladas = 0;
+
+    while ((line = ingesta_siguiente_linea(&canal->ingesta, &line_len)) != NULL) {
+        if (canal_tomar_comando(canal, line, line_len)) continue;
+        int num = validate_number(canal, line, line_len);
+        if (num != -1 && spsc_push(&canal->cola, (uint8_t)num)) {
+            encoladas++;
+        }
+    }
+    return encoladas;
+}
+
+// ----------------------------------------------------
+// Etapa 2 (modo de dos etapas): saca las lecturas encoladas por lotes y
+// actualiza las estadísticas con una sola publicación por lote.
+// Devuelve cuántas lecturas se procesaron.
+// ----------------------------------------------------
+static inline int canal_drenar(canal_t *canal, uint32_t ahora_ms) {
+    uint8_t lote[CANAL_LOTE];
+    size_t n;
+    int procesadas = 0;
+
+    while ((n = spsc_pop_lote(&canal->cola, lote, CANAL_LOTE)) > 0) {
+        seqlock_escribir_inicio(&canal->lock);
+        for (size_t i = 0; i < n; i++) {
+            estadisticas_agregar(&canal->telemetry.stats, lote[i], ahora_ms);
+        }
+        seqlock_escribir_fin(&canal->lock);
+#if CANAL_REGISTRO
+        for (size_t i = 0; i < n; i++) {
+            registro_agregar(&canal->registro, ahora_ms, lote[i]);
+        }
+#endif
+        procesadas += (int)n;
+    }
+    return procesadas;
+}
+
+#if CANAL_BINARIO
+// ----------------------------------------------------
+// Modo binario: busca en el bloque recibido la siguiente trama de lecturas.
+// Las tramas de comando se guardan para el lector y las de otro tipo se
+// cuentan como error. Devuelve las lecturas (sin validar) o NULL si el bloque
+// se terminó.
+// ----------------------------------------------------
+static inline const uint8_t *canal_siguiente_trama(canal_t *canal, const uint8_t **datos, size_t *n,
+                                                   size_t *largo) {
+    const uint8_t *carga;
+    uint8_t tipo;
+
+    while ((carga = trama_rx_siguiente(&canal->tramas, datos, n, &tipo, largo)) != NULL) {
+        if (tipo == TRAMA_LECTURAS) return carga;
+        if (tipo == TRAMA_COMANDO && *largo > 0 &&
+            canal_tomar_comando(canal, (const char *)carga, *largo)) continue;
+        trama_rx_contar(&canal->tramas.err_tipo);
+    }
+    return NULL;
+}
+
+// ----------------------------------------------------
+// Modo binario en una sola etapa: valida y procesa las lecturas de todas las
+// tramas completas del bloque, con una publicación por trama.
+// Devuelve cuántas lecturas válidas se procesaron.
+// ----------------------------------------------------
+static inline int canal_procesar_tramas(canal_t *canal, const uint8_t *datos, size_t n, uint32_t ahora_ms) {
+    const uint8_t *lecturas;
+    size_t largo;
+    int aceptadas = 0;
+
+    while ((lecturas = canal_siguiente_trama(canal, &datos, &n, &largo)) != NULL) {
+        seqlock_escribir_inicio(&canal->lock);
+        for (size_t i = 0; i < largo; i++) {
+            if (lecturas[i] > MAX_NUM) {
+                canal_contar_error(&canal->telemetry.err_rango);
+                continue;
+            }
+            estadisticas_agregar(&canal->telemetry.stats, lecturas[i], ahora_ms);
+#if CANAL_REGISTRO
+            registro_agregar(&canal->registro, ahora_ms, lecturas[i]);
+#endif
+            aceptadas++;
+        }
+        seqlock_escribir_fin(&canal->lock);
+    }
+    return aceptadas;
+}
+
+// ----------------------------------------------------
+// Modo binario, etapa 1: valida las lecturas de las tramas completas y las
+// encola. Devuelve cuántas se encolaron.
+// ----------------------------------------------------
+static inline int canal_encolar_tramas(canal_t *canal, const uint8_t *datos, size_t n) {
+    const uint8_t *lecturas;
+    size_t largo;
+    int encoladas = 0;
+
+    while ((lecturas = canal_siguiente_trama(canal, &datos, &n, &largo)) != NULL) {
+        for (size_t i = 0; i < largo; i++) {
+            if (lecturas[i] > MAX_NUM) {
+                canal_contar_error(&canal->telemetry.err_rango);
+            } else if (spsc_push(&canal->cola, lecturas[i])) {
+                encoladas++;
+            }
+        }
+    }
+    return encoladas;
+}
+#endif
+
+// ----------------------------------------------------
+// Copia consistente del estado del canal (desde cualquier tarea)
+// ----------------------------------------------------
+static inline void canal_instantanea(const canal_t *canal, telemetry_t *destino) {
+    seqlock_leer(&canal->lock, &destino->stats, &canal->telemetry.stats, sizeof(destino->stats));
+    destino->err_longitud = __atomic_load_n(&canal->telemetry.err_longitud, __ATOMIC_RELAXED);
+    destino->err_no_digito = __atomic_load_n(&canal->telemetry.err_no_digito, __ATOMIC_RELAXED);
+    destino->err_rango = __atomic_load_n(&canal->telemetry.err_rango, __ATOMIC_RELAXED);
+    destino->descartadas = __atomic_load_n(&canal->cola.descartados, __ATOMIC_RELAXED);
+#if CANAL_BINARIO
+    destino->err_trama = trama_rx_errores(&canal->tramas);
+#else
+    destino->err_trama = 0;
+#endif
+}
+
+// ----------------------------------------------------
+// Agrega la telemetría de un canal a un total
+// ----------------------------------------------------
+static inline void telemetry_fusionar(telemetry_t *total, const telemetry_t *canal) {
+    estadisticas_fusionar(&total->stats, &canal->stats);
+    total->err_longitud += canal->err_longitud;
+    total->err_no_digito += canal->err_no_digito;
+    total->err_rango += canal->err_rango;
+    total->descartadas += canal->descartadas;
+    total->err_trama += canal->err_trama;
+}
+
+#endif // CANAL_H
@@ -0,0 +1,272 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Servicio de cuadrados por lotes. Recorre cada bloque recibido byte a byte
+(sin sscanf) y responde el cuadrado de cada entero positivo que encuentra,
+incluso si el número quedó partido entre dos lecturas.
+
+Reglas de los pedidos:
+- Los números se separan con espacios, tabulaciones, saltos de línea, ',' o ';'.
+- Un pedido válido es un '+' opcional seguido de 1 a 10 dígitos, con valor
+  entre 1 y 4294967295. El cuadrado se calcula en 64 bits (n * n, sin ciclos).
+- Cualquier otra cosa (letras, negativos, cero, números más grandes) se ignora.
+
+Cada respuesta es el cuadrado en decimal seguido de '\n'.
+
+Un pedido que empieza con '?' o '!' es un comando para el propio servicio
+(p. ej. "?" pide las métricas). El texto queda en 'comando' y se marca
+'comando_listo'; quien usa el módulo lo atiende después del bloque.
+
+Modo binario (trama.h): cuadrados_procesar_tramas recibe tramas
+TRAMA_PEDIDOS con enteros de 32 bits y responde tramas TRAMA_CUADRADOS con
+un cuadrado de 64 bits por pedido, en el mismo orden (el 0 responde 0 y se
+cuenta como ignorado, para que las respuestas no se desalineen). Las tramas
+TRAMA_COMANDO llevan el texto de un comando.
+
+No depende de ESP-IDF, por lo que también compila en el computador (bench/).*/
+
+#ifndef CUADRADOS_H
+#define CUADRADOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include "trama.h"
+
+#define CUADRADOS_MAX_DIGITOS 10          // 4294967295 tiene 10 dígitos
+#define CUADRADOS_MAX_RESPUESTA 21        // 20 dígitos de un uint64 + '\n'
+#define CUADRADOS_MAX_COMANDO 16          // Caracteres guardados de un comando
+
+// Espacio de salida que garantiza responder un bloque de 'n' bytes
+// (cada pedido de k bytes + separador produce como máximo 2k + 1 bytes)
+#define CUADRADOS_SALIDA_MAX(n) (2 * (n) + CUADRADOS_MAX_RESPUESTA)
+
+// Modo binario: cuadrados por trama de respuesta y espacio extra para
+// responder una trama de pedidos que empezó en un bloque anterior (con
+// CUADRADOS_SALIDA_MAX(n) + CUADRADOS_TRAMA_SALIDA_MAX nunca falta espacio)
+#define CUADRADOS_TRAMA_RESPUESTAS (TRAMA_MAX_DATOS / 8)
+#define CUADRADOS_TRAMA_SALIDA_MAX \
+    (((TRAMA_MAX_DATOS / 4 + CUADRADOS_TRAMA_RESPUESTAS - 1) / CUADRADOS_TRAMA_RESPUESTAS) * \
+     TRAMA_CODIFICADA_MAX(TRAMA_MAX_DATOS))
+
+// ----------------------
+// Estado del analizador entre bloques
+// ----------------------
+typedef enum {
+    CUADRADOS_SEPARADOR = 0,   // Entre pedidos
+    CUADRADOS_SIGNO,           // Se leyó '+', falta al menos un dígito
+    CUADRADOS_NUMERO,          // Acumulando dígitos
+    CUADRADOS_INVALIDO,        // Pedido inválido: se ignora hasta el próximo separador
+    CUADRADOS_COMANDO,         // Acumulando un comando ('?' o '!')
+} cuadrados_estado_t;
+
+typedef struct {
+    uint64_t valor;            // Valor acumulado del pedido en curso
+    uint8_t  digitos;          // Dígitos leídos del pedido en curso
+    uint8_t  estado;           // cuadrados_estado_t
+
+    char     comando[CUADRADOS_MAX_COMANDO + 1]; // Último comando recibido
+    uint8_t  comando_largo;
+    bool     comando_listo;    // Hay un comando completo sin atender
+
+    // Contadores
+    uint32_t respondidos;      // Pedidos válidos respondidos
+    uint32_t ignorados;        // Pedidos inválidos
+    uint32_t sin_espacio;      // Respuestas perdidas por falta de espacio de salida
+    uint32_t descartados;      // Pedidos perdidos al descartar la entrada (desbordes)
+} cuadrados_t;
+
+static inline void cuadrados_init(cuadrados_t *c) {
+    memset(c, 0, sizeof(*c));
+}
+
+static inline bool cuadrados_es_separador(uint8_t b) {
+    return b == ' ' || b == '\n' || b == '\r' || b == '\t' || b == ',' || b == ';';
+}
+
+// ----------------------------------------------------
+// Escribe 'v' en decimal seguido de '\n' si cabe en 'capacidad'.
+// Devuelve los bytes escritos (0 si no cupo).
+// ----------------------------------------------------
+static inline size_t cuadrados_u64_a_texto(uint64_t v, char *destino, size_t capacidad) {
+    char tmp[20];
+    size_t n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+
+    if (n + 1 > capacidad) return 0;
+    for (size_t i = 0; i < n; i++) destino[i] = tmp[n - 1 - i];
+    destino[n] = '\n';
+    return n + 1;
+}
+
+// ----------------------------------------------------
+// Cierra el pedido en curso: si es válido escribe su cuadrado en 'salida'.
+// Devuelve los bytes escritos.
+// ----------------------------------------------------
+static inline size_t cuadrados_cerrar(cuadrados_t *c, char *salida, size_t capacidad) {
+    size_t escritos = 0;
+
+    if (c->estado == CUADRADOS_COMANDO) {
+        c->comando[c->comando_largo] = '\0';
+        c->comando_listo = true;
+    } else if (c->estado == CUADRADOS_NUMERO && c->valor > 0) {
+        escritos = cuadrados_u64_a_texto(c->valor * c->valor, salida, capacidad);
+        if (escritos > 0) {
+            c->respondidos++;
+        } else {
+            c->sin_espacio++;
+        }
+    } else if (c->estado != CUADRADOS_SEPARADOR) {
+        c->ignorados++;
+    }
+
+    c->estado = CUADRADOS_SEPARADOR;
+    c->valor = 0;
+    c->digitos = 0;
+    c->comando_largo = 0;
+    return escritos;
+}
+
+// ----------------------------------------------------
+// Procesa un bloque recibido y deja todas las respuestas en 'salida'.
+// Un pedido que queda abierto al final del bloque continúa en el siguiente.
+// Devuelve los bytes escritos (con capacidad CUADRADOS_SALIDA_MAX(n) nunca
+// falta espacio).
+// ----------------------------------------------------
+static inline size_t cuadrados_procesar(cuadrados_t *c, const uint8_t *datos, size_t n,
+                                        char *salida, size_t capacidad) {
+    size_t escritos = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        uint8_t b = datos[i];
+
+        if (cuadrados_es_separador(b)) {
+            if (c->estado != CUADRADOS_SEPARADOR) {
+                escritos += cuadrados_cerrar(c, salida + escritos, capacidad - escritos);
+            }
+            continue;
+        }
+
+        if (c->estado == CUADRADOS_INVALIDO) continue;  // Esperar el separador
+
+        if (c->estado == CUADRADOS_COMANDO) {
+            if (c->comando_largo < CUADRADOS_MAX_COMANDO) c->comando[c->comando_largo++] = (char)b;
+            continue;
+        }
+
+        if (c->estado == CUADRADOS_SEPARADOR && (b == '?' || b == '!')) {
+            c->estado = CUADRADOS_COMANDO;
+            c->comando[0] = (char)b;
+            c->comando_largo = 1;
+            continue;
+        }
+
+        if (c->estado == CUADRADOS_SEPARADOR && b == '+') {
+            c->estado = CUADRADOS_SIGNO;
+            continue;
+        }
+
+        if (b >= '0' && b <= '9' && c->digitos < CUADRADOS_MAX_DIGITOS) {
+            c->valor = c->valor * 10 + (b - '0');
+            c->digitos++;
+            c->estado = CUADRADOS_NUMERO;
+        } else {
+            c->estado = CUADRADOS_INVALIDO;
+        }
+
+        // Más de 4294967295 no cabe en el cuadrado de 64 bits
+        if (c->valor > UINT32_MAX) c->estado = CUADRADOS_INVALIDO;
+    }
+    return escritos;
+}
+
+// ----------------------------------------------------
+// Cierra un pedido que quedó sin separador (p. ej. al vencer el tiempo de
+// espera sin más datos). Devuelve los bytes escritos en 'salida'.
+// ----------------------------------------------------
+static inline size_t cuadrados_terminar(cuadrados_t *c, char *salida, size_t capacidad) {
+    if (c->estado == CUADRADOS_SEPARADOR) return 0;
+    return cuadrados_cerrar(c, salida, capacidad);
+}
+
+// ----------------------------------------------------
+// Descarta el pedido en curso (p. ej. después de vaciar la entrada del UART
+// por un desborde, cuando lo que sigue ya no es su continuación)
+// ----------------------------------------------------
+static inline void cuadrados_descartar(cuadrados_t *c) {
+    if (c->estado != CUADRADOS_SEPARADOR) c->descartados++;
+    c->estado = CUADRADOS_SEPARADOR;
+    c->valor = 0;
+    c->digitos = 0;
+    c->comando_largo = 0;
+}
+
+// ----------------------------------------------------
+// Modo binario: responde los pedidos de una trama TRAMA_PEDIDOS con tramas
+// TRAMA_CUADRADOS de hasta CUADRADOS_TRAMA_RESPUESTAS cuadrados.
+// Devuelve los bytes escritos en 'salida'.
+// ----------------------------------------------------
+static inline size_t cuadrados_responder_trama(cuadrados_t *c, const uint8_t *datos, size_t n,
+                                               uint8_t *salida, size_t capacidad) {
+    size_t pedidos = n / 4;
+    size_t escritos = 0;
+
+    if (n % 4 != 0) c->ignorados++;   // Bytes sobrantes: pedido incompleto
+
+    for (size_t i = 0; i < pedidos; i += CUADRADOS_TRAMA_RESPUESTAS) {
+        size_t k = pedidos - i < CUADRADOS_TRAMA_RESPUESTAS ? pedidos - i : CUADRADOS_TRAMA_RESPUESTAS;
+        if (TRAMA_CODIFICADA_MAX(8 * k) > capacidad - escritos) {
+            c->sin_espacio += (uint32_t)k;
+            continue;
+        }
+
+        trama_tx_t tx;
+        trama_tx_iniciar(&tx, salida + escritos, TRAMA_CUADRADOS);
+        for (size_t j = i; j < i + k; j++) {
+            const uint8_t *p = &datos[4 * j];
+            uint64_t v = (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24;
+            trama_tx_u64(&tx, v * v);
+            if (v > 0) {
+                c->respondidos++;
+            } else {
+                c->ignorados++;
+            }
+        }
+        escritos += trama_tx_terminar(&tx);
+    }
+    return escritos;
+}
+
+// ----------------------------------------------------
+// Modo binario: recibe un bloque, atiende todas las tramas completas y deja
+// las respuestas en 'salida'. Una trama que queda abierta al final del bloque
+// continúa en el siguiente. Devuelve los bytes escritos.
+// ----------------------------------------------------
+static inline size_t cuadrados_procesar_tramas(cuadrados_t *c, trama_rx_t *rx, const uint8_t *datos,
+                                               size_t n, uint8_t *salida, size_t capacidad) {
+    const uint8_t *carga;
+    size_t largo, escritos = 0;
+    uint8_t tipo;
+
+    while ((carga = trama_rx_siguiente(rx, &datos, &n, &tipo, &largo)) != NULL) {
+        if (tipo == TRAMA_PEDIDOS) {
+            escritos += cuadrados_responder_trama(c, carga, largo, salida + escritos, capacidad - escritos);
+        } else if (tipo == TRAMA_COMANDO && largo > 0) {
+            if (largo > CUADRADOS_MAX_COMANDO) largo = CUADRADOS_MAX_COMANDO;
+            memcpy(c->comando, carga, largo);
+            c->comando[largo] = '\0';
+            c->comando_listo = true;
+        } else {
+            trama_rx_contar(&rx->err_tipo);
+        }
+    }
+    return escritos;
+}
+
+#endif // CUADRADOS_H
@@ -0,0 +1,251 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Bajo consumo: sueño ligero automático entre eventos y reporte de energía.
+
+Con el modo de bajo consumo, el administrador de energía de ESP-IDF baja la
+frecuencia cuando no hay trabajo y duerme el chip (sueño ligero) cuando
+todas las tareas están bloqueadas. Lo despiertan los temporizadores de
+FreeRTOS, un toque (pads táctiles) o actividad en el UART (solo UART0 y
+UART1 en el ESP32). Requiere en menuconfig:
+  CONFIG_PM_ENABLE, CONFIG_FREERTOS_USE_TICKLESS_IDLE y, para el reporte,
+  CONFIG_PM_LIGHT_SLEEP_CALLBACKS.
+
+Los bytes que despiertan al UART se pierden (el reloj del UART se apaga
+durante el sueño): quien transmite debe empezar cada ráfaga después de un
+silencio con un preámbulo que el receptor ignore, como "\n" en texto o 0x00
+en tramas, de al menos ENERGIA_PREAMBULO_MIN(baudios) bytes.
+
+Cada lector usa energia_rx_t: en reposo espera sin límite (el chip duerme)
+y, desde el primer byte, toma un bloqueo que impide el sueño hasta
+ENERGIA_SILENCIO_MS sin recibir, para no perder bytes a mitad de una ráfaga.
+
+Reporte (energia_texto): porcentaje de tiempo despierto, despertares por
+segundo y corriente promedio estimada con las corrientes típicas de
+ENERGIA_MA_*; para valores reales hay que medir con un amperímetro.
+La latencia del despertar al primer byte (o al primer flanco táctil) se
+guarda en un histograma de instrumentacion.h.
+
+El modelo y el reporte no dependen de ESP-IDF (bench/ usa el sueño simulado
+de hal.h).*/
+
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include "hal.h"
+#include "instrumentacion.h"
+
+// Frecuencias del administrador de energía (MHz)
+#ifndef ENERGIA_MHZ_MAX
+#define ENERGIA_MHZ_MAX 240
+#endif
+#ifndef ENERGIA_MHZ_MIN
+#define ENERGIA_MHZ_MIN 40     // Frecuencia del cristal: lo mínimo con el CPU despierto
+#endif
+
+// Corrientes típicas del ESP32 sin radio, en décimas de mA (hoja de datos)
+#ifndef ENERGIA_MA_ACTIVO_X10
+#define ENERGIA_MA_ACTIVO_X10 250   // Despierto, mayormente en espera a frecuencia baja
+#endif
+#ifndef ENERGIA_MA_SUENO_X10
+#define ENERGIA_MA_SUENO_X10 8      // Sueño ligero
+#endif
+
+// Tiempo típico para salir del sueño ligero y dejar el UART recibiendo
+#define ENERGIA_DESPERTAR_US 1000
+
+// Bytes de preámbulo que cubren el despertar a 'baudios' (10 bits por byte)
+#define ENERGIA_PREAMBULO_MIN(baudios) \
+    (1 + (ENERGIA_DESPERTAR_US * (uint64_t)(baudios) / 10 + 999999) / 1000000)
+
+// Un evento más de ENERGIA_VENTANA_US después del despertar no fue quien lo causó
+#define ENERGIA_VENTANA_US 100000
+
+// Flancos del RX que despiertan al UART
+#define ENERGIA_UART_UMBRAL 3
+
+// Silencio tras el cual un lector deja dormir al chip otra vez
+#ifndef ENERGIA_SILENCIO_MS
+#define ENERGIA_SILENCIO_MS 20
+#endif
+
+typedef struct {
+    // Los escribe el aviso de salida del sueño (un solo escritor)
+    uint64_t dormido_us;       // Tiempo total en sueño ligero
+    uint32_t despertares;
+    uint32_t despertar_us;     // Último despertar (32 bits bajos del reloj en us)
+
+    // Los escribe solo quien pide el reporte
+    int64_t anterior_us;       // Fin de la ventana del reporte anterior
+    uint64_t anterior_dormido_us;
+    uint32_t anterior_despertares;
+} energia_t;
+
+static inline void energia_init(energia_t *e, int64_t ahora_us) {
+    memset(e, 0, sizeof(*e));
+    e->anterior_us = ahora_us;
+}
+
+// ----------------------------------------------------
+// Suma un período de sueño que terminó en 'ahora_us'
+// ----------------------------------------------------
+static inline void energia_desperto(energia_t *e, int64_t dormido_us, int64_t ahora_us) {
+    e->dormido_us += (uint64_t)(dormido_us > 0 ? dormido_us : 0);
+    __atomic_store_n(&e->despertares, e->despertares + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->despertar_us, (uint32_t)ahora_us, __ATOMIC_RELAXED);
+}
+
+// ----------------------------------------------------
+// Registra en 'h' la latencia del último despertar al primer evento que
+// atiende quien llama ('visto' guarda el último despertar ya medido). Los
+// eventos fuera de ENERGIA_VENTANA_US no cuentan: los despertó otra cosa.
+// ----------------------------------------------------
+static inline void energia_medir_despertar(const energia_t *e, uint32_t *visto, instr_hist_t *h,
+                                           int64_t ahora_us) {
+    uint32_t despertar = __atomic_load_n(&e->despertar_us, __ATOMIC_RELAXED);
+    if (despertar == *visto) return;
+    *visto = despertar;
+    uint32_t latencia = (uint32_t)ahora_us - despertar;
+    if (latencia <= ENERGIA_VENTANA_US) instr_registrar_us(h, latencia);
+}
+
+// ----------------------------------------------------
+// Recepción de un lector: desde el primer byte mantiene el chip despierto
+// (el UART no recibe dormido) y tras ENERGIA_SILENCIO_MS sin bytes lo deja
+// dormir de nuevo. Solo lo toca su lector.
+// ----------------------------------------------------
+typedef struct {
+    bool recibiendo;
+    uint32_t visto;            // Último despertar ya medido
+} energia_rx_t;
+
+// Espera de la próxima lectura: corta mientras se recibe, sin límite en reposo
+static inline uint32_t energia_rx_espera(const energia_rx_t *rx) {
+    return rx->recibiendo ? ENERGIA_SILENCIO_MS : HAL_ESPERA_SIEMPRE;
+}
+
+// Después de cada lectura de 'n' bytes (0 = venció la espera)
+static inline void energia_rx_leido(const energia_t *e, energia_rx_t *rx, size_t n,
+                                    instr_hist_t *h, int64_t ahora_us) {
+    if (n > 0 && !rx->recibiendo) {
+        hal_sueno_bloquear();
+        rx->recibiendo = true;
+        energia_medir_despertar(e, &rx->visto, h, ahora_us);
+    } else if (n == 0 && rx->recibiendo) {
+        hal_sueno_liberar();
+        rx->recibiendo = false;
+    }
+}
+
+// ----------------------------------------------------
+// Una línea con el ciclo de trabajo y la corriente estimada desde el reporte
+// anterior. Devuelve los bytes escritos (sin pasar de 'capacidad').
+// ----------------------------------------------------
+static inline size_t energia_texto(energia_t *e, int64_t ahora_us, char *destino, size_t capacidad) {
+    uint64_t dormido_total = e->dormido_us;
+    uint32_t despertares_total = __atomic_load_n(&e->despertares, __ATOMIC_RELAXED);
+
+    uint64_t ventana = (uint64_t)(ahora_us - e->anterior_us);
+    uint64_t dormido = dormido_total - e->anterior_dormido_us;
+    uint32_t despertares = despertares_total - e->anterior_despertares;
+    if (dormido > ventana) dormido = ventana;
+    e->anterior_us = ahora_us;
+    e->anterior_dormido_us = dormido_total;
+    e->anterior_despertares = despertares_total;
+
+    uint64_t activo = ventana - dormido;
+    unsigned long activo_x10 = ventana ? (unsigned long)(activo * 1000 / ventana) : 0;
+    unsigned long por_s_x10 = ventana ? (unsigned long)((uint64_t)despertares * 10000000 / ventana) : 0;
+    unsigned long ma_x100 = ventana ? (unsigned long)((activo * ENERGIA_MA_ACTIVO_X10 +
+                                                       dormido * ENERGIA_MA_SUENO_X10) * 10 / ventana) : 0;
+    unsigned long mah_dia = ma_x100 * 24 / 100;
+
+    int n = snprintf(destino, capacidad,
+                     "energia despierto=%lu.%lu%% despertares=%lu (%lu.%lu/s) "
+                     "corriente~%lu.%02lu mA (%lu mAh/dia) ventana=%lu s\n",
+                     activo_x10 / 10, activo_x10 % 10, (unsigned long)despertares,
+                     por_s_x10 / 10, por_s_x10 % 10, ma_x100 / 100, ma_x100 % 100, mah_dia,
+                     (unsigned long)(ventana / 1000000));
+    if (n < 0) return 0;
+    return (size_t)n < capacidad ? (size_t)n : capacidad - 1;
+}
+
+#ifdef ESP_PLATFORM
+
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+// Aviso de salida del sueño ligero: corre con el planificador detenido, solo suma
+static IRAM_ATTR esp_err_t energia_al_despertar(int64_t dormido_us, void *arg) {
+    energia_desperto((energia_t *)arg, dormido_us, esp_timer_get_time());
+    return ESP_OK;
+}
+#endif
+
+// ----------------------------------------------------
+// Activa la frecuencia dinámica y el sueño ligero automático, y el aviso de
+// salida del sueño que alimenta el reporte
+// ----------------------------------------------------
+static inline esp_err_t energia_iniciar(energia_t *e) {
+    energia_init(e, esp_timer_get_time());
+    hal_sueno_iniciar();
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t pm = {
+        .max_freq_mhz = ENERGIA_MHZ_MAX,
+        .min_freq_mhz = ENERGIA_MHZ_MIN,
+        .light_sleep_enable = true,
+    };
+    esp_err_t err = esp_pm_configure(&pm);
+    if (err != ESP_OK) return err;
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_sleep_cbs_register_config_t avisos = {
+        .exit_cb = energia_al_despertar,
+        .exit_cb_user_arg = e,
+    };
+    return esp_pm_light_sleep_register_cbs(&avisos);
+#else
+    return ESP_OK;
+#endif
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+// ----------------------------------------------------
+// Permite que actividad en el RX de 'puerto' despierte al chip (UART0/UART1)
+// ----------------------------------------------------
+static inline esp_err_t energia_despertar_con_uart(int puerto) {
+    esp_err_t err = uart_set_wakeup_threshold(puerto, ENERGIA_UART_UMBRAL);
+    if (err != ESP_OK) return err;
+    return esp_sleep_enable_uart_wakeup(puerto);
+}
+
+// Permite que un toque despierte al chip (pads con umbral e interrupción)
+static inline esp_err_t energia_despertar_con_touch(void) {
+    return esp_sleep_enable_touchpad_wakeup();
+}
+
+#else // Computador
+
+// El sueño lo simula hal.h (hal_linux_sueno): copia sus totales
+static inline void energia_linux_actualizar(energia_t *e) {
+    e->dormido_us = hal_linux.dormido_us;
+    e->despertares = hal_linux.despertares;
+    e->despertar_us = (uint32_t)hal_linux.ultimo_despertar_us;
+}
+
+#endif // ESP_PLATFORM
+
+#endif // ENERGIA_H
@@ -0,0 +1,265 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Motor de estadísticas en tiempo constante para lecturas entre 0 y 99.
+Cada muestra actualiza un histograma de 100 casillas, totales de 64 bits y
+las cubetas de tres ventanas de tiempo (último minuto, 10 minutos y 1 hora).
+No reserva memoria ni recorre muestras anteriores; las consultas recorren
+como máximo las 100 casillas o las cubetas de una ventana.
+
+No depende de ESP-IDF: el tiempo se recibe en milisegundos como argumento.*/
+
+#ifndef ESTADISTICAS_H
+#define ESTADISTICAS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define ESTAD_VALOR_MAX 99                   // Mayor lectura admitida
+#define ESTAD_CASILLAS (ESTAD_VALOR_MAX + 1) // Una casilla por valor posible
+
+// ----------------------
+// Ventanas de tiempo: número de cubetas y ancho de cada una
+// ----------------------
+#define ESTAD_VENTANA_1MIN   0
+#define ESTAD_VENTANA_10MIN  1
+#define ESTAD_VENTANA_1H     2
+#define ESTAD_NUM_VENTANAS   3
+#define ESTAD_MAX_CUBETAS    12
+
+// ----------------------------------------------------
+// Resumen agregado de un intervalo (una cubeta o una ventana completa)
+// ----------------------------------------------------
+typedef struct {
+    uint64_t cuenta;
+    uint64_t suma;
+    uint64_t suma_cuad;
+    uint8_t  min;
+    uint8_t  max;
+} estad_cubeta_t;
+
+// ----------------------------------------------------
+// Ventana deslizante formada por cubetas pre-agregadas. La ventana cubre la
+// cubeta actual más las (n - 1) anteriores, así que su resolución es de una
+// cubeta.
+// ----------------------------------------------------
+typedef struct {
+    estad_cubeta_t cubetas[ESTAD_MAX_CUBETAS];
+    uint32_t ancho_ms;   // Duración de cada cubeta
+    uint32_t fin_ms;     // Fin de la cubeta actual
+    uint8_t  n;          // Cubetas en uso
+    uint8_t  actual;     // Índice de la cubeta actual
+} estad_ventana_t;
+
+typedef struct {
+    uint64_t histograma[ESTAD_CASILLAS];
+    uint64_t cuenta;
+    uint64_t suma;
+    uint8_t  min;
+    uint8_t  max;
+    uint8_t  ultimo;
+    estad_ventana_t ventanas[ESTAD_NUM_VENTANAS];
+} estadisticas_t;
+
+// ----------------------------------------------------
+// Reinicia una cubeta (min queda por encima de cualquier lectura válida)
+// ----------------------------------------------------
+static inline void estad_cubeta_limpiar(estad_cubeta_t *c) {
+    c->cuenta = 0;
+    c->suma = 0;
+    c->suma_cuad = 0;
+    c->min = ESTAD_VALOR_MAX;
+    c->max = 0;
+}
+
+static inline void estad_ventana_init(estad_ventana_t *v, uint8_t n, uint32_t ancho_ms) {
+    memset(v, 0, sizeof(*v));
+    v->n = n;
+    v->ancho_ms = ancho_ms;
+    for (uint8_t i = 0; i < n; i++) estad_cubeta_limpiar(&v->cubetas[i]);
+}
+
+static inline void estadisticas_init(estadisticas_t *e) {
+    memset(e, 0, sizeof(*e));
+    e->min = ESTAD_VALOR_MAX;
+    e->max = 0;
+    estad_ventana_init(&e->ventanas[ESTAD_VENTANA_1MIN], 12, 5000);     // 12 x 5 s
+    estad_ventana_init(&e->ventanas[ESTAD_VENTANA_10MIN], 10, 60000);   // 10 x 1 min
+    estad_ventana_init(&e->ventanas[ESTAD_VENTANA_1H], 12, 300000);     // 12 x 5 min
+}
+
+// ----------------------------------------------------
+// Avanza la ventana hasta la cubeta que contiene 'ahora_ms', limpiando las
+// cubetas que quedaron atrás. Como máximo recorre n cubetas; si el salto es
+// mayor que la ventana se realinea con una sola división.
+// ----------------------------------------------------
+static inline void estad_ventana_avanzar(estad_ventana_t *v, uint32_t ahora_ms) {
+    for (uint8_t i = 0; i < v->n && (int32_t)(ahora_ms - v->fin_ms) >= 0; i++) {
+        v->actual = (uint8_t)((v->actual + 1) % v->n);
+        estad_cubeta_limpiar(&v->cubetas[v->actual]);
+        v->fin_ms += v->ancho_ms;
+    }
+    if ((int32_t)(ahora_ms - v->fin_ms) >= 0) {
+        v->fin_ms = (ahora_ms / v->ancho_ms + 1) * v->ancho_ms;
+    }
+}
+
+static inline void estad_ventana_agregar(estad_ventana_t *v, uint32_t ahora_ms, uint8_t valor) {
+    if ((int32_t)(ahora_ms - v->fin_ms) >= 0) estad_ventana_avanzar(v, ahora_ms);
+
+    estad_cubeta_t *c = &v->cubetas[v->actual];
+    c->cuenta++;
+    c->suma += valor;
+    c->suma_cuad += (uint32_t)valor * valor;
+    if (valor < c->min) c->min = valor;
+    if (valor > c->max) c->max = valor;
+}
+
+// ----------------------------------------------------
+// Agrega una muestra. Costo constante: una casilla del histograma, los
+// totales y la cubeta actual de cada ventana.
+// ----------------------------------------------------
+static inline void estadisticas_agregar(estadisticas_t *e, uint8_t valor, uint32_t ahora_ms) {
+    if (valor > ESTAD_VALOR_MAX) return;
+
+    e->histograma[valor]++;
+    e->cuenta++;
+    e->suma += valor;
+    e->ultimo = valor;
+    if (valor < e->min) e->min = valor;
+    if (valor > e->max) e->max = valor;
+
+    for (int i = 0; i < ESTAD_NUM_VENTANAS; i++) {
+        estad_ventana_agregar(&e->ventanas[i], ahora_ms, valor);
+    }
+}
+
+// ----------------------------------------------------
+// Promedio en centésimas, redondeado (entero: sin división flotante)
+// ----------------------------------------------------
+static inline uint32_t estadisticas_promedio_x100(const estadisticas_t *e) {
+    if (e->cuenta == 0) return 0;
+    return (uint32_t)((e->suma * 100 + e->cuenta / 2) / e->cuenta);
+}
+
+// ----------------------------------------------------
+// Varianza muestral exacta calculada en dos pasadas sobre el histograma:
+// primero la media y luego la suma de desviaciones al cuadrado. Da el mismo
+// resultado que Welford sin pagar una división por muestra.
+// ----------------------------------------------------
+static inline double estadisticas_varianza(const estadisticas_t *e) {
+    if (e->cuenta < 2) return 0.0;
+
+    double media = (double)e->suma / (double)e->cuenta;
+    double m2 = 0.0;
+    for (int v = e->min; v <= e->max; v++) {
+        double d = v - media;
+        m2 += d * d * e->histograma[v];
+    }
+    return m2 / (double)(e->cuenta - 1);
+}
+
+// ----------------------------------------------------
+// Percentiles exactos (rango más cercano) en una sola pasada por el histograma.
+// 'pct' debe estar en orden creciente; el resultado se deja en 'salida'.
+// ----------------------------------------------------
+static inline void estadisticas_percentiles(const estadisticas_t *e, const uint8_t *pct,
+                                            uint8_t *salida, int n) {
+    uint64_t acumulado = 0;
+    int k = 0;
+
+    for (int v = 0; v < ESTAD_CASILLAS && k < n; v++) {
+        acumulado += e->histograma[v];
+        // rango = ceil(pct * cuenta / 100), mínimo 1
+        while (k < n && acumulado * 100 >= (uint64_t)pct[k] * e->cuenta && acumulado > 0) {
+            salida[k++] = (uint8_t)v;
+        }
+    }
+    while (k < n) salida[k++] = 0;  // Sin muestras
+}
+
+// ----------------------------------------------------
+// Resume una ventana de tiempo hasta 'ahora_ms'. Avanza la ventana para que
+// las cubetas viejas no se cuenten aunque no hayan llegado muestras nuevas.
+// ----------------------------------------------------
+static inline estad_cubeta_t estadisticas_ventana(estadisticas_t *e, int ventana, uint32_t ahora_ms) {
+    estad_ventana_t *v = &e->ventanas[ventana];
+    if ((int32_t)(ahora_ms - v->fin_ms) >= 0) estad_ventana_avanzar(v, ahora_ms);
+
+    estad_cubeta_t r;
+    estad_cubeta_limpiar(&r);
+    for (uint8_t i = 0; i < v->n; i++) {
+        const estad_cubeta_t *c = &v->cubetas[i];
+        if (c->cuenta == 0) continue;
+        r.cuenta += c->cuenta;
+        r.suma += c->suma;
+        r.suma_cuad += c->suma_cuad;
+        if (c->min < r.min) r.min = c->min;
+        if (c->max > r.max) r.max = c->max;
+    }
+    return r;
+}
+
+static inline uint32_t estad_cubeta_promedio_x100(const estad_cubeta_t *c) {
+    if (c->cuenta == 0) return 0;
+    return (uint32_t)((c->suma * 100 + c->cuenta / 2) / c->cuenta);
+}
+
+static inline double estad_cubeta_varianza(const estad_cubeta_t *c) {
+    if (c->cuenta < 2) return 0.0;
+    double n = (double)c->cuenta;
+    double m2 = (double)c->suma_cuad - (double)c->suma * (double)c->suma / n;
+    return m2 > 0.0 ? m2 / (n - 1.0) : 0.0;
+}
+
+// ----------------------------------------------------
+// Suma una ventana a otra. Las cubetas de ambas están alineadas a múltiplos
+// de ancho_ms, así que cada cubeta de 'src' cae en una cubeta de 'dst'.
+// ----------------------------------------------------
+static inline void estad_ventana_fusionar(estad_ventana_t *dst, const estad_ventana_t *src) {
+    if (src->fin_ms == 0) return;  // 'src' nunca recibió muestras
+
+    // Llevar 'dst' hasta la cubeta más reciente de 'src'
+    if (dst->fin_ms == 0 || (int32_t)(src->fin_ms - dst->fin_ms) > 0) {
+        estad_ventana_avanzar(dst, src->fin_ms - 1);
+    }
+
+    for (uint8_t k = 0; k < src->n; k++) {
+        const estad_cubeta_t *c = &src->cubetas[(src->actual + src->n - k) % src->n];
+        if (c->cuenta == 0) continue;
+
+        uint32_t kd = (dst->fin_ms - (src->fin_ms - k * src->ancho_ms)) / dst->ancho_ms;
+        if (kd >= dst->n) continue;  // Más vieja que la ventana de 'dst'
+
+        estad_cubeta_t *d = &dst->cubetas[(dst->actual + dst->n - kd) % dst->n];
+        d->cuenta += c->cuenta;
+        d->suma += c->suma;
+        d->suma_cuad += c->suma_cuad;
+        if (c->min < d->min) d->min = c->min;
+        if (c->max > d->max) d->max = c->max;
+    }
+}
+
+// ----------------------------------------------------
+// Suma las estadísticas de 'src' en 'dst' (p. ej. para agregar varios canales).
+// 'ultimo' queda como el de 'src'.
+// ----------------------------------------------------
+static inline void estadisticas_fusionar(estadisticas_t *dst, const estadisticas_t *src) {
+    if (src->cuenta == 0) return;
+
+    for (int v = 0; v < ESTAD_CASILLAS; v++) dst->histograma[v] += src->histograma[v];
+    dst->cuenta += src->cuenta;
+    dst->suma += src->suma;
+    dst->ultimo = src->ultimo;
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+
+    for (int i = 0; i < ESTAD_NUM_VENTANAS; i++) {
+        estad_ventana_fusionar(&dst->ventanas[i], &src->ventanas[i]);
+    }
+}
+
+#endif // ESTADISTICAS_H
@@ -0,0 +1,357 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Capa mínima sobre las llamadas al hardware que usan los tres ejercicios:
+lectura y escritura del UART, lectura de los pads táctiles y el reloj.
+
+- En el ESP32 (ESP_PLATFORM) cada función es una llamada directa al driver
+  (uart_read_bytes, uart_write_bytes, touch_pad_read_filtered,
+  xTaskGetTickCount...), sin costo extra.
+- En el computador se reproducen guiones: bytes que llegan por cada puerto
+  a un baudaje dado y trazas de valores de los pads en el tiempo. El reloj es
+  virtual: avanza con las esperas, no con el tiempo de CPU, así que las
+  latencias medidas son las del protocolo y se repiten exactamente.
+
+Así el mismo código de lectura corre en la placa y en los benchmarks (bench/).
+
+Sueño ligero (energia.h): hal_sueno_bloquear/hal_sueno_liberar mantienen el
+chip despierto mientras hay una recepción en curso. En el computador,
+hal_linux_sueno simula el sueño: una espera sin bloqueos duerme el chip, y
+los bytes que llegan antes de terminar de despertar se pierden, como en el
+UART real.*/
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define HAL_ESPERA_SIEMPRE UINT32_MAX   // Esperar sin límite
+
+#ifdef ESP_PLATFORM
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "driver/touch_pad.h"
+
+static inline TickType_t hal_ticks(uint32_t espera_ms) {
+    return espera_ms == HAL_ESPERA_SIEMPRE ? portMAX_DELAY : pdMS_TO_TICKS(espera_ms);
+}
+
+static inline int hal_uart_leer(int puerto, uint8_t *destino, size_t max, uint32_t espera_ms) {
+    return uart_read_bytes(puerto, destino, max, hal_ticks(espera_ms));
+}
+
+static inline size_t hal_uart_pendientes(int puerto) {
+    size_t pendientes = 0;
+    uart_get_buffered_data_len(puerto, &pendientes);
+    return pendientes;
+}
+
+static inline int hal_uart_escribir(int puerto, const void *datos, size_t largo) {
+    return uart_write_bytes(puerto, datos, largo);
+}
+
+static inline void hal_touch_leer(int pad, uint16_t *valor) {
+    touch_pad_read(pad, valor);
+}
+
+static inline void hal_touch_leer_filtrado(int pad, uint16_t *valor) {
+    touch_pad_read_filtered(pad, valor);
+}
+
+static inline uint32_t hal_ms(void) {
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+static inline void hal_esperar_ms(uint32_t ms) {
+    vTaskDelay(hal_ticks(ms));
+}
+
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+
+static esp_pm_lock_handle_t hal_sin_sueno = NULL;   // Lo crea hal_sueno_iniciar
+
+static inline void hal_sueno_iniciar(void) {
+    if (hal_sin_sueno == NULL) esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "rx", &hal_sin_sueno);
+}
+
+static inline void hal_sueno_bloquear(void) {
+    if (hal_sin_sueno != NULL) esp_pm_lock_acquire(hal_sin_sueno);
+}
+
+static inline void hal_sueno_liberar(void) {
+    if (hal_sin_sueno != NULL) esp_pm_lock_release(hal_sin_sueno);
+}
+#else
+static inline void hal_sueno_iniciar(void) {}
+static inline void hal_sueno_bloquear(void) {}
+static inline void hal_sueno_liberar(void) {}
+#endif
+
+#else // Computador: reproducción de guiones
+
+#include <string.h>
+
+#define HAL_PUERTOS 3
+#define HAL_PADS 10
+#define HAL_FIFO_UMBRAL 120      // El driver recibe de la FIFO de a 120 bytes...
+#define HAL_FIFO_TIMEOUT 10      // ...o lo que haya tras 10 bytes de silencio
+
+// ----------------------------------------------------
+// Guion de un puerto: 'datos' empieza a llegar en 'inicio_us' al ritmo de
+// 'baudios' (10 bits por byte; 0 = todo disponible de inmediato). Como en el
+// driver, los bytes quedan disponibles de a HAL_FIFO_UMBRAL y el resto al
+// terminar el guion más HAL_FIFO_TIMEOUT bytes de silencio. Lo que el
+// programa escribe se cuenta y, si hay 'captura', se copia.
+// ----------------------------------------------------
+typedef struct {
+    const uint8_t *datos;
+    size_t largo;
+    size_t pos;               // Siguiente byte a entregar
+    uint32_t baudios;
+    uint64_t inicio_us;
+    uint64_t escritos;
+    char *captura;
+    size_t captura_cap;
+    size_t captura_largo;
+} hal_guion_uart_t;
+
+// ----------------------------------------------------
+// Punto de una traza táctil: desde 't_us', 'pad' lee 'valor'. Los puntos van
+// en orden de tiempo.
+// ----------------------------------------------------
+typedef struct {
+    uint64_t t_us;
+    uint8_t pad;
+    uint16_t valor;
+} hal_punto_touch_t;
+
+static struct {
+    uint64_t reloj_us;
+    hal_guion_uart_t uart[HAL_PUERTOS];
+    const hal_punto_touch_t *touch;
+    size_t touch_n;
+    size_t touch_pos;
+    uint16_t pad_valor[HAL_PADS];
+
+    // Sueño ligero simulado (hal_linux_sueno)
+    uint32_t despertar_us;    // Lo que tarda en despertar; 0 = sin sueño
+    int bloqueos;             // hal_sueno_bloquear sin su hal_sueno_liberar
+    uint64_t dormido_us;      // Tiempo total dormido
+    uint32_t despertares;
+    uint64_t ultimo_despertar_us;
+    uint64_t bytes_perdidos;  // Llegaron mientras el UART despertaba
+} hal_linux;
+
+static inline void hal_linux_reiniciar(void) {
+    memset(&hal_linux, 0, sizeof(hal_linux));
+}
+
+static inline void hal_linux_guion_uart(int puerto, const uint8_t *datos, size_t largo, uint32_t baudios) {
+    hal_guion_uart_t *g = &hal_linux.uart[puerto];
+    memset(g, 0, sizeof(*g));
+    g->datos = datos;
+    g->largo = largo;
+    g->baudios = baudios;
+    g->inicio_us = hal_linux.reloj_us;
+}
+
+static inline void hal_linux_capturar(int puerto, char *destino, size_t capacidad) {
+    hal_linux.uart[puerto].captura = destino;
+    hal_linux.uart[puerto].captura_cap = capacidad;
+    hal_linux.uart[puerto].captura_largo = 0;
+}
+
+static inline void hal_linux_guion_touch(const hal_punto_touch_t *puntos, size_t n, uint16_t reposo) {
+    hal_linux.touch = puntos;
+    hal_linux.touch_n = n;
+    hal_linux.touch_pos = 0;
+    for (int i = 0; i < HAL_PADS; i++) hal_linux.pad_valor[i] = reposo;
+}
+
+// Activa el sueño simulado: despertar tarda 'despertar_us' (0 lo desactiva)
+static inline void hal_linux_sueno(uint32_t despertar_us) {
+    hal_linux.despertar_us = despertar_us;
+}
+
+static inline void hal_sueno_iniciar(void) {}
+
+static inline void hal_sueno_bloquear(void) {
+    hal_linux.bloqueos++;
+}
+
+static inline void hal_sueno_liberar(void) {
+    hal_linux.bloqueos--;
+}
+
+static inline bool hal_linux_puede_dormir(void) {
+    return hal_linux.despertar_us > 0 && hal_linux.bloqueos == 0;
+}
+
+// Duerme desde ahora hasta 'hasta_us'; luego tarda lo que tarda en despertar
+static inline void hal_linux_dormir(uint64_t hasta_us) {
+    hal_linux.dormido_us += hasta_us - hal_linux.reloj_us;
+    hal_linux.despertares++;
+    hal_linux.reloj_us = hasta_us + hal_linux.despertar_us;
+    hal_linux.ultimo_despertar_us = hal_linux.reloj_us;
+}
+
+static inline bool hal_linux_uart_terminado(int puerto) {
+    return hal_linux.uart[puerto].pos >= hal_linux.uart[puerto].largo;
+}
+
+static inline uint64_t hal_us(void) {
+    return hal_linux.reloj_us;
+}
+
+static inline uint32_t hal_ms(void) {
+    return (uint32_t)(hal_linux.reloj_us / 1000);
+}
+
+static inline void hal_esperar_ms(uint32_t ms) {
+    if (hal_linux_puede_dormir() && (uint64_t)ms * 1000 > hal_linux.despertar_us) {
+        // El temporizador despierta al chip a tiempo: el despertar no se suma
+        uint64_t fin = hal_linux.reloj_us + (uint64_t)ms * 1000;
+        hal_linux_dormir(fin - hal_linux.despertar_us);
+        return;
+    }
+    hal_linux.reloj_us += (uint64_t)ms * 1000;
+}
+
+// Momento en que termina de llegar el byte número 'n' (contando desde 1)
+static inline uint64_t hal_linux_llegada(const hal_guion_uart_t *g, size_t n) {
+    return g->inicio_us + ((uint64_t)n * 10000000u + g->baudios - 1) / g->baudios;
+}
+
+// Bytes del guion que el driver ya tiene en 't_us'
+static inline size_t hal_linux_visibles(const hal_guion_uart_t *g, uint64_t t_us) {
+    if (g->baudios == 0) return g->largo;
+    if (t_us >= hal_linux_llegada(g, g->largo + HAL_FIFO_TIMEOUT)) return g->largo;
+
+    uint64_t llegados = (t_us - g->inicio_us) * g->baudios / 10000000u;
+    if (llegados > g->largo) llegados = g->largo;
+    size_t visibles = (size_t)(llegados / HAL_FIFO_UMBRAL * HAL_FIFO_UMBRAL);
+    return visibles > g->pos ? visibles : g->pos;
+}
+
+// Bytes que ya llegaron al driver y no se han leído
+static inline size_t hal_uart_pendientes(int puerto) {
+    const hal_guion_uart_t *g = &hal_linux.uart[puerto];
+    return hal_linux_visibles(g, hal_linux.reloj_us) - g->pos;
+}
+
+// ----------------------------------------------------
+// Con el sueño simulado, una espera que empieza antes de que llegue el
+// próximo byte duerme el chip hasta ese byte (o hasta el fin de la espera).
+// Los bytes que empiezan a llegar antes de terminar de despertar se pierden.
+// Devuelve false si la espera venció dormida.
+// ----------------------------------------------------
+static inline bool hal_linux_dormir_uart(hal_guion_uart_t *g, uint64_t limite) {
+    uint64_t inicio = g->pos == 0 ? g->inicio_us : hal_linux_llegada(g, g->pos);
+    if (!hal_linux_puede_dormir() || g->baudios == 0 || inicio <= hal_linux.reloj_us) return true;
+
+    if (inicio > limite) {
+        // Una espera más corta que el despertar no alcanza a dormir
+        if (limite - hal_linux.reloj_us <= hal_linux.despertar_us) return true;
+        hal_linux_dormir(limite - hal_linux.despertar_us);
+        return false;
+    }
+    hal_linux_dormir(inicio);
+    while (g->pos < g->largo && hal_linux_llegada(g, g->pos) < hal_linux.reloj_us) {
+        g->pos++;
+        hal_linux.bytes_perdidos++;
+    }
+    return true;
+}
+
+// ----------------------------------------------------
+// Como uart_read_bytes: espera hasta 'espera_ms' a que llegue al menos un
+// byte. Con el guion terminado no espera (devuelve 0).
+// ----------------------------------------------------
+static inline int hal_uart_leer(int puerto, uint8_t *destino, size_t max, uint32_t espera_ms) {
+    hal_guion_uart_t *g = &hal_linux.uart[puerto];
+    uint64_t limite = espera_ms == HAL_ESPERA_SIEMPRE ? UINT64_MAX
+                    : hal_linux.reloj_us + (uint64_t)espera_ms * 1000;
+
+    if (hal_uart_pendientes(puerto) == 0) {
+        if (g->pos >= g->largo) return 0;
+        if (!hal_linux_dormir_uart(g, limite) || g->pos >= g->largo) return 0;
+    }
+
+    if (hal_uart_pendientes(puerto) == 0) {
+        // Adelantar el reloj hasta el próximo bloque que entrega el driver, o
+        // hasta el fin de la espera
+        size_t proximo = (g->pos / HAL_FIFO_UMBRAL + 1) * HAL_FIFO_UMBRAL;
+        uint64_t llegada = proximo <= g->largo ? hal_linux_llegada(g, proximo)
+                                               : hal_linux_llegada(g, g->largo + HAL_FIFO_TIMEOUT);
+        if (llegada > limite) {
+            if (limite > hal_linux.reloj_us) hal_linux.reloj_us = limite;
+            return 0;
+        }
+        hal_linux.reloj_us = llegada;
+    }
+
+    size_t n = hal_uart_pendientes(puerto);
+    if (n > max) n = max;
+    memcpy(destino, g->datos + g->pos, n);
+    g->pos += n;
+    return (int)n;
+}
+
+static inline int hal_uart_escribir(int puerto, const void *datos, size_t largo) {
+    hal_guion_uart_t *g = &hal_linux.uart[puerto];
+    g->escritos += largo;
+    if (g->captura != NULL) {
+        size_t n = g->captura_cap - g->captura_largo;
+        if (n > largo) n = largo;
+        memcpy(g->captura + g->captura_largo, datos, n);
+        g->captura_largo += n;
+    }
+    return (int)largo;
+}
+
+// Valor del pad según la traza en el instante actual del reloj virtual
+static inline void hal_touch_leer(int pad, uint16_t *valor) {
+    uint64_t ahora = hal_linux.reloj_us;
+    while (hal_linux.touch_pos < hal_linux.touch_n && hal_linux.touch[hal_linux.touch_pos].t_us <= ahora) {
+        const hal_punto_touch_t *p = &hal_linux.touch[hal_linux.touch_pos++];
+        hal_linux.pad_valor[p->pad] = p->valor;
+    }
+    *valor = hal_linux.pad_valor[pad];
+}
+
+// La traza ya viene "limpia": el filtrado es el mismo valor
+static inline void hal_touch_leer_filtrado(int pad, uint16_t *valor) {
+    hal_touch_leer(pad, valor);
+}
+
+#endif // ESP_PLATFORM
+
+// ----------------------------------------------------
+// Espera el primer byte (hasta 'espera_ms') y luego drena en una sola
+// llamada lo que el driver ya tenga almacenado, sin pasar de 'espacio'.
+// Devuelve los bytes leídos.
+// ----------------------------------------------------
+static inline size_t hal_uart_leer_bloque(int puerto, uint8_t *destino, size_t espacio, uint32_t espera_ms) {
+    if (espacio == 0) return 0;
+
+    int len = hal_uart_leer(puerto, destino, 1, espera_ms);
+    if (len <= 0) return 0;
+
+    size_t pendientes = hal_uart_pendientes(puerto);
+    if (pendientes > espacio - 1) pendientes = espacio - 1;
+
+    if (pendientes > 0) {
+        int extra = hal_uart_leer(puerto, destino + 1, pendientes, 0);
+        if (extra > 0) len += extra;
+    }
+    return (size_t)len;
+}
+
+#endif // HAL_H
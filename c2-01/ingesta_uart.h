@@ -0,0 +1,161 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Módulo de ingesta por bloques para lecturas seriales terminadas en '\n' o '\r'.
+Los bytes se escriben directamente en un anillo (sin copia intermedia) y el
+separador de líneas las entrega en su sitio: el terminador se reemplaza por
+'\0' y se devuelve un puntero dentro del anillo. Solo las líneas que cruzan el
+final del anillo se copian a un buffer lineal.
+
+No depende de ESP-IDF, por lo que también compila en el computador (bench/).*/
+
+#ifndef INGESTA_UART_H
+#define INGESTA_UART_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Tamaño del anillo (debe ser potencia de 2)
+#ifndef INGESTA_ANILLO_SIZE
+#define INGESTA_ANILLO_SIZE 1024
+#endif
+
+// Máximo de caracteres que se conservan por línea; el resto se descarta
+// (mismo comportamiento que el buffer line[BUF_SIZE] original)
+#ifndef INGESTA_LINEA_MAX
+#define INGESTA_LINEA_MAX 127
+#endif
+
+#define INGESTA_MASCARA (INGESTA_ANILLO_SIZE - 1)
+
+#if (INGESTA_ANILLO_SIZE & INGESTA_MASCARA) != 0
+#error "INGESTA_ANILLO_SIZE debe ser potencia de 2"
+#endif
+
+#if INGESTA_ANILLO_SIZE < 2 * (INGESTA_LINEA_MAX + 1)
+#error "INGESTA_ANILLO_SIZE debe poder contener al menos dos líneas completas"
+#endif
+
+// ----------------------------------------------------
+// Estado de la ingesta. Los índices avanzan libremente (sin módulo) y se
+// reducen con INGESTA_MASCARA solo al acceder a datos[].
+// ----------------------------------------------------
+typedef struct {
+    uint8_t  datos[INGESTA_ANILLO_SIZE];
+    uint32_t cabeza;        // Próxima posición de escritura
+    uint32_t escaneo;       // Próximo byte que revisará el separador
+    uint32_t inicio;        // Inicio de la línea en curso (lo anterior ya se consumió)
+    uint16_t largo;         // Caracteres conservados de la línea en curso
+    bool     desbordada;    // La línea en curso superó INGESTA_LINEA_MAX
+    char     lineal[INGESTA_LINEA_MAX + 1]; // Copia solo para líneas que cruzan el final
+
+    // Contadores
+    uint32_t bytes;         // Bytes recibidos
+    uint32_t bloques;       // Bloques confirmados (≈ llamadas al driver con datos)
+    uint32_t lineas;        // Líneas entregadas
+    uint32_t truncadas;     // Líneas que superaron INGESTA_LINEA_MAX
+    uint32_t copiadas;      // Líneas que se tuvieron que linealizar
+} ingesta_t;
+
+// ----------------------------------------------------
+// Deja la ingesta en estado inicial
+// ----------------------------------------------------
+static inline void ingesta_init(ingesta_t *ing) {
+    memset(ing, 0, sizeof(*ing));
+}
+
+// ----------------------------------------------------
+// Devuelve la región contigua libre donde el driver puede escribir directamente.
+// Las líneas entregadas antes de esta llamada dejan de ser válidas.
+// ----------------------------------------------------
+static inline size_t ingesta_espacio(ingesta_t *ing, uint8_t **destino) {
+    // Sin línea pendiente se vuelve al inicio del anillo para que la próxima
+    // lectura sea lo más larga posible y las líneas no crucen el final
+    if (ing->inicio == ing->cabeza) {
+        ing->inicio = ing->escaneo = ing->cabeza = 0;
+    }
+
+    uint32_t libre = INGESTA_ANILLO_SIZE - (ing->cabeza - ing->inicio);
+    uint32_t pos = ing->cabeza & INGESTA_MASCARA;
+    uint32_t hasta_final = INGESTA_ANILLO_SIZE - pos;
+
+    *destino = &ing->datos[pos];
+    return libre < hasta_final ? libre : hasta_final;
+}
+
+// ----------------------------------------------------
+// Confirma que se escribieron 'n' bytes en la región entregada por ingesta_espacio
+// ----------------------------------------------------
+static inline void ingesta_confirmar(ingesta_t *ing, size_t n) {
+    if (n == 0) return;
+    ing->cabeza += (uint32_t)n;
+    ing->bytes += (uint32_t)n;
+    ing->bloques++;
+}
+
+// ----------------------------------------------------
+// Busca la siguiente línea completa. Devuelve un puntero a la cadena terminada
+// en '\0' (válido hasta la próxima llamada a ingesta_espacio) o NULL si no hay
+// más líneas completas. Las líneas vacías se ignoran, igual que antes.
+// ----------------------------------------------------
+static inline const char *ingesta_siguiente_linea(ingesta_t *ing, size_t *largo) {
+    while (ing->escaneo != ing->cabeza) {
+        uint8_t byte = ing->datos[ing->escaneo & INGESTA_MASCARA];
+
+        if (byte != '\n' && byte != '\r') {
+            ing->escaneo++;
+            if (ing->largo < INGESTA_LINEA_MAX) {
+                ing->largo++;
+            } else {
+                ing->desbordada = true;
+            }
+            continue;
+        }
+
+        // Terminador encontrado: la línea ocupa [inicio, inicio + largo)
+        uint32_t inicio = ing->inicio;
+        uint16_t n = ing->largo;
+        bool truncada = ing->desbordada;
+
+        ing->escaneo++;
+        ing->inicio = ing->escaneo;
+        ing->largo = 0;
+        ing->desbordada = false;
+
+        if (n == 0) continue;  // Línea vacía (p. ej. el '\n' de un "\r\n")
+
+        ing->lineas++;
+        if (truncada) ing->truncadas++;
+        *largo = n;
+
+        uint32_t pos = inicio & INGESTA_MASCARA;
+        if (pos + n < INGESTA_ANILLO_SIZE) {
+            // Caso normal: se termina la cadena en su sitio (sobre el terminador
+            // o sobre el primer byte descartado si la línea se truncó)
+            ing->datos[pos + n] = '\0';
+            return (const char *)&ing->datos[pos];
+        }
+
+        // La línea cruza el final del anillo: se copia a lineal[]
+        uint32_t primera = INGESTA_ANILLO_SIZE - pos;
+        if (primera > n) primera = n;
+        memcpy(ing->lineal, &ing->datos[pos], primera);
+        memcpy(ing->lineal + primera, &ing->datos[0], n - primera);
+        ing->lineal[n] = '\0';
+        ing->copiadas++;
+        return ing->lineal;
+    }
+
+    // Sin más terminadores. Si la línea en curso se desbordó, los bytes
+    // descartados se devuelven al anillo para no llenarlo con basura.
+    if (ing->desbordada) {
+        ing->cabeza = ing->escaneo = ing->inicio + INGESTA_LINEA_MAX;
+    }
+    return NULL;
+}
+
+#endif // INGESTA_UART_H
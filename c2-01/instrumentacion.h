@@ -0,0 +1,267 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Instrumentación liviana para dejar encendida en producción:
+
+- Marcas con el contador de ciclos de la CPU en los puntos calientes (byte
+  recibido, línea separada, muestra procesada, veredicto emitido). Una marca
+  es una lectura de registro; registrar una latencia son unas pocas
+  operaciones enteras, sin divisiones ni flotantes.
+- Histogramas de latencia de memoria fija: 4 casillas por potencia de 2
+  (error menor al 25%) desde 1 ciclo hasta 2^32, con cuenta, suma y máximo.
+  Cada histograma tiene un solo escritor (igual que los contadores de
+  canal.h); quien consulta solo lee.
+- Tareas: porcentaje de CPU desde la consulta anterior (requiere
+  CONFIG_FREERTOS_USE_TRACE_FACILITY y CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  en menuconfig; sin ellas solo se informa la pila) y pila libre mínima
+  (uxTaskGetStackHighWaterMark) de las tareas registradas. Con las mismas
+  opciones, instr_cpu_libre_x10 da la CPU libre (tareas IDLE).
+
+Todo se consulta en texto con instr_hist_texto e instr_tareas_texto (los
+programas lo exponen con el comando "!perf").
+
+Los ciclos de cada núcleo no están sincronizados: una marca solo se compara
+con otra tomada en la misma tarea fija a un núcleo. Para latencias entre
+tareas o desde una ISR se registran microsegundos (instr_registrar_us).
+
+En el computador las marcas son nanosegundos (INSTR_MHZ 1000), así que los
+histogramas también compilan en bench/.*/
+
+#ifndef INSTRUMENTACION_H
+#define INSTRUMENTACION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define INSTR_CASILLAS 128     // 32 potencias de 2 x 4 casillas
+#define INSTR_MAX_TAREAS 12    // Tareas registradas para el reporte
+
+#ifdef ESP_PLATFORM
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+
+#define INSTR_MHZ CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ  // Ciclos por microsegundo
+
+static inline uint32_t instr_marca(void) {
+    return (uint32_t)esp_cpu_get_cycle_count();
+}
+
+#else // Computador
+
+#include <time.h>
+
+#define INSTR_MHZ 1000         // Una "marca" es un nanosegundo
+
+static inline uint32_t instr_marca(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+}
+
+#endif // ESP_PLATFORM
+
+// ----------------------------------------------------
+// Histograma de latencias en ciclos
+// ----------------------------------------------------
+typedef struct {
+    const char *nombre;
+    uint32_t casillas[INSTR_CASILLAS];
+    uint32_t cuenta;
+    uint32_t max;
+    uint64_t suma;
+} instr_hist_t;
+
+#define INSTR_HIST(n) {.nombre = (n)}
+
+// ----------------------------------------------------
+// Casilla de un valor: 0-3 exactos; desde 4, la potencia de 2 y los dos bits
+// que le siguen
+// ----------------------------------------------------
+static inline uint32_t instr_casilla(uint32_t v) {
+    if (v < 4) return v;
+    uint32_t o = 31u - (uint32_t)__builtin_clz(v);
+    return o * 4 + ((v >> (o - 2)) & 3);
+}
+
+// Mayor valor que cae en la casilla 'c'
+static inline uint32_t instr_casilla_techo(uint32_t c) {
+    if (c < 8) return c;
+    uint32_t o = c / 4;
+    uint64_t siguiente = (uint64_t)(4 + c % 4 + 1) << (o - 2);
+    return siguiente > UINT32_MAX ? UINT32_MAX : (uint32_t)(siguiente - 1);
+}
+
+// ----------------------------------------------------
+// Registra una latencia en ciclos (un solo escritor por histograma)
+// ----------------------------------------------------
+static inline void instr_registrar(instr_hist_t *h, uint32_t ciclos) {
+    uint32_t c = instr_casilla(ciclos);
+    __atomic_store_n(&h->casillas[c], h->casillas[c] + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->cuenta, h->cuenta + 1, __ATOMIC_RELAXED);
+    if (ciclos > h->max) __atomic_store_n(&h->max, ciclos, __ATOMIC_RELAXED);
+    h->suma += ciclos;
+}
+
+// Registra el tiempo desde 'marca' (tomada con instr_marca en el mismo núcleo)
+static inline void instr_desde(instr_hist_t *h, uint32_t marca) {
+    instr_registrar(h, instr_marca() - marca);
+}
+
+// Registra una latencia medida en microsegundos (entre tareas o desde una ISR)
+static inline void instr_registrar_us(instr_hist_t *h, int64_t us) {
+    if (us < 0) us = 0;
+    uint64_t ciclos = (uint64_t)us * INSTR_MHZ;
+    instr_registrar(h, ciclos > UINT32_MAX ? UINT32_MAX : (uint32_t)ciclos);
+}
+
+static inline void instr_reiniciar(instr_hist_t *h) {
+    const char *nombre = h->nombre;
+    memset(h, 0, sizeof(*h));
+    h->nombre = nombre;
+}
+
+// ----------------------------------------------------
+// Suma 'h' a 'total' (p. ej. los histogramas de cada canal)
+// ----------------------------------------------------
+static inline void instr_fusionar(instr_hist_t *total, const instr_hist_t *h) {
+    for (int i = 0; i < INSTR_CASILLAS; i++) total->casillas[i] += h->casillas[i];
+    total->cuenta += h->cuenta;
+    total->suma += h->suma;
+    if (h->max > total->max) total->max = h->max;
+}
+
+// ----------------------------------------------------
+// Percentil 'p' (0-100) en ciclos: techo de la casilla donde cae
+// ----------------------------------------------------
+static inline uint32_t instr_percentil(const instr_hist_t *h, uint32_t p) {
+    uint32_t cuenta = __atomic_load_n(&h->cuenta, __ATOMIC_RELAXED);
+    if (cuenta == 0) return 0;
+    uint64_t objetivo = ((uint64_t)cuenta * p + 99) / 100;
+    if (objetivo == 0) objetivo = 1;
+
+    uint64_t acumulado = 0;
+    for (uint32_t c = 0; c < INSTR_CASILLAS; c++) {
+        acumulado += __atomic_load_n(&h->casillas[c], __ATOMIC_RELAXED);
+        if (acumulado >= objetivo) {
+            uint32_t techo = instr_casilla_techo(c);
+            return techo < h->max ? techo : h->max;
+        }
+    }
+    return h->max;
+}
+
+// Ciclos a microsegundos con un decimal, para imprimir "%lu.%lu"
+#define INSTR_US_X10(ciclos) ((unsigned long)((uint64_t)(ciclos) * 10 / INSTR_MHZ))
+
+// ----------------------------------------------------
+// Una línea "nombre n=... prom=... p50=... p99=... max=... us".
+// Devuelve los bytes escritos (sin pasar de 'capacidad').
+// ----------------------------------------------------
+static inline size_t instr_hist_texto(const instr_hist_t *h, char *destino, size_t capacidad) {
+    uint32_t cuenta = __atomic_load_n(&h->cuenta, __ATOMIC_RELAXED);
+    unsigned long prom = cuenta ? INSTR_US_X10(h->suma / cuenta) : 0;
+    unsigned long p50 = INSTR_US_X10(instr_percentil(h, 50));
+    unsigned long p99 = INSTR_US_X10(instr_percentil(h, 99));
+    unsigned long max = INSTR_US_X10(__atomic_load_n(&h->max, __ATOMIC_RELAXED));
+
+    int n = snprintf(destino, capacidad,
+                     "%s n=%lu prom=%lu.%lu p50=%lu.%lu p99=%lu.%lu max=%lu.%lu us\n",
+                     h->nombre, (unsigned long)cuenta, prom / 10, prom % 10,
+                     p50 / 10, p50 % 10, p99 / 10, p99 % 10, max / 10, max % 10);
+    if (n < 0) return 0;
+    return (size_t)n < capacidad ? (size_t)n : capacidad - 1;
+}
+
+#ifdef ESP_PLATFORM
+
+// ----------------------------------------------------
+// Tareas registradas: pila libre y porcentaje de CPU
+// ----------------------------------------------------
+static struct {
+    TaskHandle_t tareas[INSTR_MAX_TAREAS];
+    uint32_t tiempo_anterior[INSTR_MAX_TAREAS];   // Tiempo de CPU en la consulta anterior
+    uint32_t total_anterior;
+    uint32_t libre_anterior;                      // Tiempo de las tareas IDLE (instr_cpu_libre_x10)
+    uint32_t total_libre_anterior;
+    int n;
+} instr_tareas;
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+static TaskStatus_t instr_estado[INSTR_MAX_TAREAS + 16];  // Fuera de la pila de quien consulta
+#endif
+
+static inline void instr_registrar_tarea(TaskHandle_t tarea) {
+    if (tarea != NULL && instr_tareas.n < INSTR_MAX_TAREAS) {
+        instr_tareas.tareas[instr_tareas.n++] = tarea;
+    }
+}
+
+// ----------------------------------------------------
+// Una línea por tarea registrada: "tarea nombre cpu=..% pila_libre=... B".
+// El porcentaje es de un núcleo desde la consulta anterior. Devuelve los
+// bytes escritos. Solo la llama una tarea (la que atiende el comando).
+// ----------------------------------------------------
+static inline size_t instr_tareas_texto(char *destino, size_t capacidad) {
+    size_t escritos = 0;
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    TaskStatus_t *estado = instr_estado;
+    uint32_t total = 0;
+    UBaseType_t n = uxTaskGetSystemState(estado, sizeof(instr_estado) / sizeof(instr_estado[0]), &total);
+    uint32_t delta_total = total - instr_tareas.total_anterior;
+    instr_tareas.total_anterior = total;
+#endif
+
+    for (int i = 0; i < instr_tareas.n && escritos + 1 < capacidad; i++) {
+        TaskHandle_t t = instr_tareas.tareas[i];
+        unsigned long cpu_x10 = 0;
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+        for (UBaseType_t k = 0; k < n; k++) {
+            if (estado[k].xHandle != t) continue;
+            uint32_t delta = estado[k].ulRunTimeCounter - instr_tareas.tiempo_anterior[i];
+            instr_tareas.tiempo_anterior[i] = estado[k].ulRunTimeCounter;
+            cpu_x10 = delta_total ? (unsigned long)((uint64_t)delta * 1000 / delta_total) : 0;
+        }
+#endif
+        int m = snprintf(destino + escritos, capacidad - escritos,
+                         "tarea %s cpu=%lu.%lu%% pila_libre=%u B\n",
+                         pcTaskGetName(t), cpu_x10 / 10, cpu_x10 % 10,
+                         (unsigned)uxTaskGetStackHighWaterMark(t));
+        if (m < 0) break;
+        escritos += (size_t)m < capacidad - escritos ? (size_t)m : capacidad - escritos - 1;
+    }
+    return escritos;
+}
+
+// ----------------------------------------------------
+// CPU libre de todo el chip desde la consulta anterior, en décimas de %: el
+// tiempo de las tareas IDLE de todos los núcleos. -1 si FreeRTOS no lleva
+// tiempos de ejecución (ver arriba). Solo la llama una tarea.
+// ----------------------------------------------------
+static inline int instr_cpu_libre_x10(void) {
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    uint32_t total = 0, libre = 0;
+    UBaseType_t n = uxTaskGetSystemState(instr_estado, sizeof(instr_estado) / sizeof(instr_estado[0]), &total);
+    for (UBaseType_t k = 0; k < n; k++) {
+        if (strncmp(instr_estado[k].pcTaskName, "IDLE", 4) == 0) libre += instr_estado[k].ulRunTimeCounter;
+    }
+    uint64_t delta_total = (uint64_t)(total - instr_tareas.total_libre_anterior) * portNUM_PROCESSORS;
+    uint32_t delta_libre = libre - instr_tareas.libre_anterior;
+    instr_tareas.total_libre_anterior = total;
+    instr_tareas.libre_anterior = libre;
+    return delta_total ? (int)((uint64_t)delta_libre * 1000 / delta_total) : 0;
+#else
+    return -1;
+#endif
+}
+
+#endif // ESP_PLATFORM
+
+#endif // INSTRUMENTACION_H
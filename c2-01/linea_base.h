@@ -0,0 +1,138 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Línea base adaptable para pads táctiles, solo con enteros. Cada pad tiene
+su propio estado, así que se usa uno por canal táctil (hasta los 10 del ESP32).
+
+- Calibración: promedia N muestras sin tocar. Se puede repetir en cualquier
+  momento (linea_base_calibrar) y se repite sola si el pad queda "tocado"
+  demasiado tiempo, que suele ser una línea base vieja y no un dedo.
+- Seguimiento: filtro IIR en punto fijo (base += (valor - base) / 2^k) que
+  solo avanza con el pad suelto, para seguir la deriva por humedad o
+  temperatura sin aprender el toque.
+- Detección con histéresis: el pad pasa a tocado bajo 'umbral_tocar' y vuelve
+  a suelto sobre 'umbral_soltar'. Los umbrales son fracciones de la base en
+  1/256 y se recalculan con una multiplicación cuando la base cambia.
+
+Cada muestra cuesta un número fijo de operaciones enteras (sin flotantes ni
+divisiones salvo la que cierra una calibración).
+
+No depende de ESP-IDF, por lo que también compila en el computador (bench/).*/
+
+#ifndef LINEA_BASE_H
+#define LINEA_BASE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Bits fraccionarios de la base (Q16). Deben ser al menos el desplazamiento
+// del IIR: con menos, una diferencia de pocas cuentas se trunca a 0 y la
+// deriva lenta no se sigue (con Q8 y k = 12, ninguna menor a 16 cuentas).
+// Una lectura de 16 bits en Q16 todavía cabe en 32 bits.
+#define LINEA_BASE_FRAC 16
+#define LINEA_BASE_DESPLAZAMIENTO_MAX LINEA_BASE_FRAC
+
+// Valores por defecto para un pad leído cada pocas decenas de ms (sondeo)
+#define LINEA_BASE_TOCAR_256      128   // Tocado bajo el 50% de la base
+#define LINEA_BASE_SOLTAR_256     166   // Suelto sobre el 65% de la base (histéresis)
+#define LINEA_BASE_DESPLAZAMIENTO 12    // Constante de tiempo de 2^12 muestras (≈3.4 min cada 50 ms)
+
+typedef struct {
+    uint32_t base_q;             // Línea base en Q16 (valor << LINEA_BASE_FRAC)
+    uint16_t umbral_tocar;       // Bajo este valor el pad pasa a tocado
+    uint16_t umbral_soltar;      // Sobre este valor el pad vuelve a suelto
+    uint8_t  tocar_256;          // umbral_tocar = base * tocar_256 / 256
+    uint8_t  soltar_256;         // umbral_soltar = base * soltar_256 / 256 (mayor: histéresis)
+    uint8_t  desplazamiento;     // k del IIR (<= LINEA_BASE_FRAC): cada muestra acerca la base 1/2^k al valor
+    bool     tocado;
+
+    uint16_t calibrando;         // Muestras que faltan para cerrar la calibración (0 = lista)
+    uint16_t cal_muestras;       // Muestras de la calibración en curso
+    uint32_t cal_suma;
+
+    uint32_t seguidas_tocado;    // Muestras seguidas en estado tocado
+    uint32_t max_tocado;         // Tras tantas muestras seguidas tocado se recalibra (0 = nunca)
+    uint32_t recalibraciones;    // Recalibraciones automáticas por pad atascado
+} linea_base_t;
+
+// ----------------------------------------------------
+// Recalcula los umbrales a partir de la base (base_q * fracción en 64 bits)
+// ----------------------------------------------------
+static inline void linea_base_umbrales(linea_base_t *lb) {
+    lb->umbral_tocar = (uint16_t)(((uint64_t)lb->base_q * lb->tocar_256) >> (LINEA_BASE_FRAC + 8));
+    lb->umbral_soltar = (uint16_t)(((uint64_t)lb->base_q * lb->soltar_256) >> (LINEA_BASE_FRAC + 8));
+}
+
+// ----------------------------------------------------
+// Inicia una calibración de 'muestras' lecturas (el pad debe estar suelto).
+// Mientras dura, linea_base_muestra informa el pad como suelto.
+// ----------------------------------------------------
+static inline void linea_base_calibrar(linea_base_t *lb, uint16_t muestras) {
+    lb->calibrando = muestras ? muestras : 1;
+    lb->cal_muestras = lb->calibrando;
+    lb->cal_suma = 0;
+    lb->tocado = false;
+    lb->seguidas_tocado = 0;
+}
+
+static inline void linea_base_init(linea_base_t *lb, uint8_t tocar_256, uint8_t soltar_256,
+                                   uint8_t desplazamiento, uint32_t max_tocado) {
+    memset(lb, 0, sizeof(*lb));
+    lb->tocar_256 = tocar_256;
+    lb->soltar_256 = soltar_256;
+    lb->desplazamiento = desplazamiento < LINEA_BASE_DESPLAZAMIENTO_MAX ? desplazamiento
+                                                                        : LINEA_BASE_DESPLAZAMIENTO_MAX;
+    lb->max_tocado = max_tocado;
+}
+
+static inline bool linea_base_calibrando(const linea_base_t *lb) {
+    return lb->calibrando != 0;
+}
+
+static inline uint16_t linea_base_valor(const linea_base_t *lb) {
+    return (uint16_t)(lb->base_q >> LINEA_BASE_FRAC);
+}
+
+// ----------------------------------------------------
+// Procesa una lectura del pad. Devuelve true si el pad está tocado.
+// ----------------------------------------------------
+static inline bool linea_base_muestra(linea_base_t *lb, uint16_t valor) {
+    if (lb->calibrando) {
+        lb->cal_suma += valor;
+        if (--lb->calibrando == 0) {
+            lb->base_q = (uint32_t)(((uint64_t)lb->cal_suma << LINEA_BASE_FRAC) / lb->cal_muestras);
+            linea_base_umbrales(lb);
+        }
+        return false;
+    }
+
+    // Detección con histéresis
+    if (!lb->tocado && valor < lb->umbral_tocar) {
+        lb->tocado = true;
+    } else if (lb->tocado && valor > lb->umbral_soltar) {
+        lb->tocado = false;
+    }
+
+    if (lb->tocado) {
+        // Tocado por demasiado tiempo: la base quedó vieja, recalibrar
+        if (lb->max_tocado && ++lb->seguidas_tocado >= lb->max_tocado) {
+            lb->recalibraciones++;
+            linea_base_calibrar(lb, lb->cal_muestras);
+        }
+        return lb->tocado;
+    }
+    lb->seguidas_tocado = 0;
+
+    // Seguimiento de la deriva solo con el pad claramente suelto
+    if (valor >= lb->umbral_soltar) {
+        int64_t diferencia = (int64_t)((uint32_t)valor << LINEA_BASE_FRAC) - (int64_t)lb->base_q;
+        lb->base_q = (uint32_t)((int64_t)lb->base_q + diferencia / (1 << lb->desplazamiento));
+        linea_base_umbrales(lb);
+    }
+    return false;
+}
+
+#endif // LINEA_BASE_H
@@ -0,0 +1,134 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Motor de patrones táctiles. Cada patrón es una secuencia de toques cortos (0)
+y largos (1) guardada en bits: el bit i es el toque i. Se pueden registrar
+hasta 32 patrones de 1 a 32 toques, de largos distintos.
+
+Los patrones se compilan una vez en una tabla de transiciones: para cada
+posición y cada tipo de toque, un conjunto de bits con los patrones que
+siguen siendo posibles. El reconocimiento es incremental: cada toque cuesta
+un AND con una entrada de la tabla, sin importar cuántos patrones haya, y si
+ningún patrón empieza como lo ingresado se rechaza en ese mismo toque.
+
+No depende de ESP-IDF, por lo que también compila en el computador (bench/).*/
+
+#ifndef PATRONES_H
+#define PATRONES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define PATRONES_MAX 32          // Un bit por patrón en un uint32_t
+#define PATRONES_MAX_LARGO 32    // Toques por patrón (un bit por toque)
+
+#define PATRONES_CORTO 0
+#define PATRONES_LARGO 1
+
+// ----------------------------------------------------
+// Patrón registrado. 'simbolos' se escribe en binario leído de derecha a
+// izquierda: 3 largos, 3 cortos, 3 largos = 1 1100 0111 = 0x1C7.
+// ----------------------------------------------------
+typedef struct {
+    const char *nombre;
+    uint32_t simbolos;           // Bit i = toque i (1 largo, 0 corto)
+    uint8_t largo;               // Número de toques
+} patron_t;
+
+#define PATRON(nombre, largo, simbolos) { (nombre), (simbolos), (largo) }
+
+// ----------------------------------------------------
+// Tabla compilada (392 bytes para cualquier cantidad de patrones)
+// ----------------------------------------------------
+typedef struct {
+    uint32_t siguen[PATRONES_MAX_LARGO][2];    // Patrones cuyo toque 'pos' es corto / largo
+    uint32_t terminan[PATRONES_MAX_LARGO + 1]; // Patrones de exactamente 'pos' toques
+    uint32_t todos;                            // Un bit por patrón registrado
+} patrones_tabla_t;
+
+// ----------------------------------------------------
+// Estado de una secuencia en curso
+// ----------------------------------------------------
+typedef struct {
+    uint32_t candidatos;         // Patrones que coinciden con todo lo ingresado
+    uint8_t pos;                 // Toques ingresados
+} patrones_motor_t;
+
+typedef enum {
+    PATRONES_EN_CURSO = 0,       // Algún patrón puede continuar
+    PATRONES_COMPLETO,           // Solo quedan patrones terminados: esperar validación
+    PATRONES_RECHAZADO,          // Ningún patrón empieza así
+} patrones_resultado_t;
+
+// ----------------------------------------------------
+// Compila 'n' patrones en 'tabla'. Devuelve false si hay más de
+// PATRONES_MAX o alguno tiene un largo fuera de 1..PATRONES_MAX_LARGO.
+// ----------------------------------------------------
+static inline bool patrones_compilar(patrones_tabla_t *tabla, const patron_t *patrones, int n) {
+    memset(tabla, 0, sizeof(*tabla));
+    if (n > PATRONES_MAX) return false;
+
+    for (int p = 0; p < n; p++) {
+        uint32_t bit = 1u << p;
+        uint8_t largo = patrones[p].largo;
+        if (largo == 0 || largo > PATRONES_MAX_LARGO) return false;
+
+        for (int i = 0; i < largo; i++) {
+            tabla->siguen[i][(patrones[p].simbolos >> i) & 1] |= bit;
+        }
+        tabla->terminan[largo] |= bit;
+        tabla->todos |= bit;
+    }
+    return true;
+}
+
+static inline void patrones_reiniciar(patrones_motor_t *m, const patrones_tabla_t *tabla) {
+    m->candidatos = tabla->todos;
+    m->pos = 0;
+}
+
+// ----------------------------------------------------
+// Agrega un toque (PATRONES_CORTO o PATRONES_LARGO). Costo constante.
+// ----------------------------------------------------
+static inline patrones_resultado_t patrones_avanzar(patrones_motor_t *m, const patrones_tabla_t *tabla,
+                                                    uint8_t simbolo) {
+    if (m->pos >= PATRONES_MAX_LARGO) m->candidatos = 0;
+    if (m->candidatos == 0) return PATRONES_RECHAZADO;
+
+    m->candidatos &= tabla->siguen[m->pos][simbolo & 1];
+    m->pos++;
+
+    if (m->candidatos == 0) return PATRONES_RECHAZADO;
+    if (m->pos == PATRONES_MAX_LARGO) return PATRONES_COMPLETO;
+
+    uint32_t continuan = tabla->siguen[m->pos][0] | tabla->siguen[m->pos][1];
+    return (m->candidatos & continuan) ? PATRONES_EN_CURSO : PATRONES_COMPLETO;
+}
+
+// ----------------------------------------------------
+// Patrones que terminan exactamente en lo ingresado (0 si ninguno)
+// ----------------------------------------------------
+static inline uint32_t patrones_coincidencias(const patrones_motor_t *m, const patrones_tabla_t *tabla) {
+    return m->candidatos & tabla->terminan[m->pos];
+}
+
+// ----------------------------------------------------
+// Índice del primer patrón de un conjunto de coincidencias (-1 si está vacío)
+// ----------------------------------------------------
+static inline int patrones_primero(uint32_t coincidencias) {
+    return coincidencias ? __builtin_ctz(coincidencias) : -1;
+}
+
+// ----------------------------------------------------
+// Escribe los 'largo' toques de 'simbolos' como texto ('L' largo, 'C' corto).
+// 'destino' debe tener espacio para largo + 1 caracteres.
+// ----------------------------------------------------
+static inline void patrones_a_texto(uint32_t simbolos, uint8_t largo, char *destino) {
+    for (uint8_t i = 0; i < largo; i++) destino[i] = ((simbolos >> i) & 1) ? 'L' : 'C';
+    destino[largo] = '\0';
+}
+
+#endif // PATRONES_H
@@ -0,0 +1,510 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Registro histórico compacto de lecturas del caudalímetro (00-99).
+
+Formato: el registro es una sucesión de páginas de REGISTRO_PAGINA bytes. Cada
+página empieza con una cabecera (cuántas lecturas tiene, tiempo de la primera
+y de la última, en ms de 64 bits) y sigue con las lecturas empaquetadas en bits:
+- El tiempo se guarda como diferencia entre deltas consecutivos (delta de
+  delta, en ms). Con un caudalímetro que envía a ritmo fijo casi siempre es 0
+  y ocupa 1 bit; las variaciones pequeñas ocupan 9 o 15 bits.
+- El valor ocupa 7 bits (0-127 alcanza para 00-99).
+Con envío periódico exacto cada lectura ocupa 1 byte y con unos ms de
+variación unos 2, contra 3-4 bytes del texto sin tiempo, ~13 del texto con
+tiempo u 8 de un struct {uint32_t t; uint8_t valor;} alineado.
+
+El tiempo de registro es de 64 bits: sigue creciendo entre reinicios y no da
+la vuelta a los ~49,7 días como el reloj de 32 bits del sistema. Dentro de
+una página solo se guardan deltas de 32 bits; un salto mayor abre otra página.
+
+Escritura: quien procesa las lecturas las agrega a una página en RAM. Hay dos
+páginas: cuando una se llena queda lista para que otra tarea la guarde en la
+flash de una vez (una escritura por página, no una por lectura) y el escritor
+sigue en la otra, así que la recepción nunca espera a la flash. Si las dos
+están llenas las lecturas se cuentan como perdidas.
+
+Lectura: las páginas son de tamaño fijo y están en orden de tiempo, así que
+para leer un rango se busca la primera página con búsqueda binaria leyendo
+solo cabeceras y se decodifica desde ahí. El submuestreo agrupa las lecturas
+en intervalos (cuenta, promedio, mínimo, máximo) para exportarlas por UART.
+
+Los archivos se manejan con stdio (en el ESP32, SPIFFS o LittleFS montados en
+el VFS). No depende de ESP-IDF, por lo que también compila en el computador
+(bench/).*/
+
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef REGISTRO_PAGINA
+#define REGISTRO_PAGINA 512      // Bytes por página (múltiplo de la página de la flash)
+#endif
+
+#if REGISTRO_PAGINA < 64 || REGISTRO_PAGINA > 8191
+#error "REGISTRO_PAGINA debe estar entre 64 y 8191 (los bits usados van en 16 bits)"
+#endif
+
+#define REGISTRO_CABECERA 24
+#define REGISTRO_MAGIA_0 'R'
+#define REGISTRO_MAGIA_1 'G'
+#define REGISTRO_VERSION 2
+#define REGISTRO_BITS_VALOR 7
+#define REGISTRO_BITS_MAX (4 + 32 + REGISTRO_BITS_VALOR)  // Lectura más larga posible
+
+typedef struct {
+    uint64_t t;                  // Tiempo de registro (ms)
+    uint8_t valor;
+} registro_muestra_t;
+
+typedef struct {
+    uint8_t canal;
+    uint16_t n;                  // Lecturas en la página
+    uint16_t bits;               // Bits usados, incluida la cabecera
+    uint64_t t0;                 // Tiempo de la primera lectura
+    uint64_t tfin;               // Tiempo de la última lectura
+} registro_cabecera_t;
+
+// ----------------------------------------------------
+// Escritor: dos páginas en RAM. 'llena' la pone el escritor cuando cierra una
+// página y la borra quien la guarda; es la única sincronización entre ambos.
+// ----------------------------------------------------
+typedef struct {
+    uint8_t paginas[2][REGISTRO_PAGINA];
+    uint8_t llena[2];
+    uint8_t actual;              // Página en la que escribe el escritor
+    uint8_t a_guardar;           // Próxima página que guarda la otra tarea
+    uint8_t canal;
+
+    uint16_t n;                  // Lecturas en la página actual
+    uint32_t bits;               // Bits usados en la página actual
+    uint64_t t0;
+    uint64_t t_ultimo;
+    uint32_t delta_ultimo;
+    uint64_t reloj;              // Tiempo de registro en la última llamada
+    uint32_t reloj_ms;           // Reloj del sistema en la última llamada
+
+    uint32_t muestras;           // Lecturas registradas
+    uint32_t perdidas;           // Lecturas descartadas con las dos páginas llenas
+    uint32_t paginas_cerradas;
+} registro_t;
+
+// ----------------------------------------------------
+// Bits: se escriben de a trozos de hasta 8 (el byte en curso), del más
+// significativo al menos significativo. La página debe empezar en cero.
+// ----------------------------------------------------
+static inline void registro_poner_bits(uint8_t *p, uint32_t *pos, uint32_t valor, int n) {
+    while (n > 0) {
+        int libre = 8 - (int)(*pos & 7);
+        int k = n < libre ? n : libre;
+        uint32_t trozo = (valor >> (n - k)) & ((1u << k) - 1);
+        p[*pos >> 3] |= (uint8_t)(trozo << (libre - k));
+        *pos += (uint32_t)k;
+        n -= k;
+    }
+}
+
+static inline uint32_t registro_tomar_bits(const uint8_t *p, uint32_t *pos, int n) {
+    uint32_t valor = 0;
+    while (n > 0) {
+        int libre = 8 - (int)(*pos & 7);
+        int k = n < libre ? n : libre;
+        uint32_t trozo = ((uint32_t)p[*pos >> 3] >> (libre - k)) & ((1u << k) - 1);
+        valor = (valor << k) | trozo;
+        *pos += (uint32_t)k;
+        n -= k;
+    }
+    return valor;
+}
+
+// ----------------------------------------------------
+// Código del tiempo (delta de delta 'dd'):
+//   0                  dd = 0
+//   10   + 7 bits      -64 <= dd < 64
+//   110  + 12 bits     -2048 <= dd < 2048
+//   1110 + 20 bits     -2^19 <= dd < 2^19
+//   1111 + 32 bits     delta completo
+// ----------------------------------------------------
+static inline int registro_bits_tiempo(int32_t dd) {
+    if (dd == 0) return 1;
+    if (dd >= -64 && dd < 64) return 2 + 7;
+    if (dd >= -2048 && dd < 2048) return 3 + 12;
+    if (dd >= -(1 << 19) && dd < (1 << 19)) return 4 + 20;
+    return 4 + 32;
+}
+
+static inline void registro_poner_tiempo(uint8_t *p, uint32_t *pos, int32_t dd, uint32_t delta) {
+    switch (registro_bits_tiempo(dd)) {
+    case 1:       registro_poner_bits(p, pos, 0x0, 1); break;
+    case 2 + 7:   registro_poner_bits(p, pos, 0x2, 2); registro_poner_bits(p, pos, (uint32_t)dd, 7); break;
+    case 3 + 12:  registro_poner_bits(p, pos, 0x6, 3); registro_poner_bits(p, pos, (uint32_t)dd, 12); break;
+    case 4 + 20:  registro_poner_bits(p, pos, 0xE, 4); registro_poner_bits(p, pos, (uint32_t)dd, 20); break;
+    default:      registro_poner_bits(p, pos, 0xF, 4); registro_poner_bits(p, pos, delta, 32); break;
+    }
+}
+
+// Lee 'n' bits como entero con signo
+static inline int32_t registro_tomar_con_signo(const uint8_t *p, uint32_t *pos, int n) {
+    uint32_t v = registro_tomar_bits(p, pos, n);
+    return (v & (1u << (n - 1))) ? (int32_t)v - (int32_t)(1u << n) : (int32_t)v;
+}
+
+// ----------------------------------------------------
+// Cabecera (little endian, 24 bytes):
+//   'R' 'G' versión canal | n (16) | bits (16) | t0 (64) | tfin (64)
+// ----------------------------------------------------
+static inline void registro_poner_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t registro_tomar_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void registro_poner_u64(uint8_t *p, uint64_t v) {
+    registro_poner_u32(p, (uint32_t)v);
+    registro_poner_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static inline uint64_t registro_tomar_u64(const uint8_t *p) {
+    return (uint64_t)registro_tomar_u32(p) | ((uint64_t)registro_tomar_u32(p + 4) << 32);
+}
+
+static inline void registro_escribir_cabecera(uint8_t *p, const registro_cabecera_t *c) {
+    p[0] = REGISTRO_MAGIA_0;
+    p[1] = REGISTRO_MAGIA_1;
+    p[2] = REGISTRO_VERSION;
+    p[3] = c->canal;
+    p[4] = (uint8_t)c->n;
+    p[5] = (uint8_t)(c->n >> 8);
+    p[6] = (uint8_t)c->bits;
+    p[7] = (uint8_t)(c->bits >> 8);
+    registro_poner_u64(&p[8], c->t0);
+    registro_poner_u64(&p[16], c->tfin);
+}
+
+// ----------------------------------------------------
+// Lee y valida una cabecera. Devuelve false si no es una página del registro.
+// ----------------------------------------------------
+static inline bool registro_leer_cabecera(const uint8_t *p, registro_cabecera_t *c) {
+    if (p[0] != REGISTRO_MAGIA_0 || p[1] != REGISTRO_MAGIA_1 || p[2] != REGISTRO_VERSION) return false;
+    c->canal = p[3];
+    c->n = (uint16_t)(p[4] | (p[5] << 8));
+    c->bits = (uint16_t)(p[6] | (p[7] << 8));
+    c->t0 = registro_tomar_u64(&p[8]);
+    c->tfin = registro_tomar_u64(&p[16]);
+    return c->n > 0 && c->bits >= REGISTRO_CABECERA * 8 && c->bits <= REGISTRO_PAGINA * 8;
+}
+
+// ----------------------------------------------------
+// Escritor
+// ----------------------------------------------------
+static inline void registro_init(registro_t *r, uint8_t canal) {
+    memset(r, 0, sizeof(*r));
+    r->canal = canal;
+}
+
+// Hace que el tiempo registrado continúe desde 'ultimo_ms' (la última lectura
+// guardada antes de reiniciar). Se llama antes de la primera lectura.
+static inline void registro_reanudar(registro_t *r, uint64_t ultimo_ms, uint32_t ahora_ms) {
+    r->reloj = ultimo_ms + 1;
+    r->reloj_ms = ahora_ms;
+}
+
+// Tiempo de registro que corresponde a 'ahora_ms' del reloj del sistema. El
+// reloj de 32 bits puede dar la vuelta entre dos llamadas: solo se usa la
+// diferencia con la anterior.
+static inline uint64_t registro_tiempo(const registro_t *r, uint32_t ahora_ms) {
+    return r->reloj + (uint32_t)(ahora_ms - r->reloj_ms);
+}
+
+// Cierra la página actual y pasa a la otra (solo el escritor)
+static inline void registro_cerrar_pagina(registro_t *r) {
+    registro_cabecera_t c = {r->canal, r->n, (uint16_t)r->bits, r->t0, r->t_ultimo};
+    registro_escribir_cabecera(r->paginas[r->actual], &c);
+    __atomic_store_n(&r->llena[r->actual], 1, __ATOMIC_RELEASE);
+    r->paginas_cerradas++;
+    r->actual ^= 1;
+    r->n = 0;
+}
+
+// ----------------------------------------------------
+// Agrega una lectura. 'ahora_ms' es el reloj del sistema y no retrocede
+// entre llamadas. Devuelve false si se perdió porque las dos páginas esperan
+// ser guardadas.
+// ----------------------------------------------------
+static inline bool registro_agregar(registro_t *r, uint32_t ahora_ms, uint8_t valor) {
+    uint64_t t = registro_tiempo(r, ahora_ms);
+    r->reloj = t;
+    r->reloj_ms = ahora_ms;
+
+    for (;;) {
+        if (__atomic_load_n(&r->llena[r->actual], __ATOMIC_ACQUIRE)) {
+            r->perdidas++;
+            return false;
+        }
+
+        uint8_t *p = r->paginas[r->actual];
+        if (r->n == 0) {
+            memset(p, 0, REGISTRO_PAGINA);
+            r->bits = REGISTRO_CABECERA * 8;
+            r->t0 = t;
+            r->t_ultimo = t;
+            r->delta_ultimo = 0;
+        }
+
+        // Un delta que no entra en 32 bits también abre otra página
+        if (t - r->t_ultimo > UINT32_MAX) {
+            registro_cerrar_pagina(r);
+            continue;
+        }
+        uint32_t delta = (uint32_t)(t - r->t_ultimo);
+        int32_t dd = (int32_t)(delta - r->delta_ultimo);
+        if (r->bits + (uint32_t)(registro_bits_tiempo(dd) + REGISTRO_BITS_VALOR) > REGISTRO_PAGINA * 8) {
+            registro_cerrar_pagina(r);  // La lectura va al inicio de la otra página
+            continue;
+        }
+
+        registro_poner_tiempo(p, &r->bits, dd, delta);
+        registro_poner_bits(p, &r->bits, valor, REGISTRO_BITS_VALOR);
+        r->n++;
+        r->t_ultimo = t;
+        r->delta_ultimo = delta;
+        r->muestras++;
+        return true;
+    }
+}
+
+// ----------------------------------------------------
+// Lado de quien guarda: devuelve la próxima página cerrada (en orden) o NULL.
+// Tras escribirla se llama registro_pagina_guardada.
+// ----------------------------------------------------
+static inline const uint8_t *registro_pagina_lista(registro_t *r) {
+    if (!__atomic_load_n(&r->llena[r->a_guardar], __ATOMIC_ACQUIRE)) return NULL;
+    return r->paginas[r->a_guardar];
+}
+
+static inline void registro_pagina_guardada(registro_t *r) {
+    __atomic_store_n(&r->llena[r->a_guardar], 0, __ATOMIC_RELEASE);
+    r->a_guardar ^= 1;
+}
+
+static inline bool registro_pendiente(registro_t *r) {
+    return __atomic_load_n(&r->llena[r->a_guardar], __ATOMIC_ACQUIRE) != 0;
+}
+
+// ----------------------------------------------------
+// Cursor sobre las lecturas de una página
+// ----------------------------------------------------
+typedef struct {
+    const uint8_t *pagina;
+    registro_cabecera_t cab;
+    uint32_t pos;                // Próximo bit
+    uint16_t leidas;
+    uint64_t t;
+    uint32_t delta;
+} registro_cursor_t;
+
+static inline bool registro_cursor_iniciar(registro_cursor_t *c, const uint8_t *pagina) {
+    c->pagina = pagina;
+    c->pos = REGISTRO_CABECERA * 8;
+    c->leidas = 0;
+    c->delta = 0;
+    if (!registro_leer_cabecera(pagina, &c->cab)) return false;
+    c->t = c->cab.t0;
+    return true;
+}
+
+// Quedan 'n' bits de la página por leer. Una página con cabecera válida y
+// cuerpo dañado (o borrado, 0xFF) se corta aquí en vez de leer fuera de ella.
+static inline bool registro_cursor_quedan(registro_cursor_t *c, int n) {
+    if (c->pos + (uint32_t)n <= c->cab.bits) return true;
+    c->leidas = c->cab.n;        // Fin de la página
+    return false;
+}
+
+static inline bool registro_cursor_siguiente(registro_cursor_t *c, registro_muestra_t *m) {
+    static const int8_t bits_dd[] = {0, 7, 12, 20};
+    if (c->leidas >= c->cab.n) return false;
+
+    // Prefijo del código del tiempo: hasta cuatro 1 terminados en 0
+    const uint8_t *p = c->pagina;
+    int unos = 0;
+    while (unos < 4) {
+        if (!registro_cursor_quedan(c, 1)) return false;
+        if (registro_tomar_bits(p, &c->pos, 1) == 0) break;
+        unos++;
+    }
+
+    if (unos == 4) {
+        if (!registro_cursor_quedan(c, 32 + REGISTRO_BITS_VALOR)) return false;
+        c->delta = registro_tomar_bits(p, &c->pos, 32);
+    } else {
+        if (!registro_cursor_quedan(c, bits_dd[unos] + REGISTRO_BITS_VALOR)) return false;
+        if (unos > 0) c->delta += (uint32_t)registro_tomar_con_signo(p, &c->pos, bits_dd[unos]);
+        // Con 0: mismo delta que la lectura anterior
+    }
+
+    c->t += c->delta;
+    m->t = c->t;
+    m->valor = (uint8_t)registro_tomar_bits(p, &c->pos, REGISTRO_BITS_VALOR);
+    c->leidas++;
+    return true;
+}
+
+// ----------------------------------------------------
+// Guarda una página al final de un archivo abierto en modo "ab"
+// ----------------------------------------------------
+static inline bool registro_guardar(FILE *archivo, const uint8_t *pagina) {
+    if (fwrite(pagina, 1, REGISTRO_PAGINA, archivo) != REGISTRO_PAGINA) return false;
+    return fflush(archivo) == 0;
+}
+
+// ----------------------------------------------------
+// Lector de un rango de tiempo sobre un archivo de páginas
+// ----------------------------------------------------
+typedef struct {
+    FILE *archivo;
+    long paginas;                // Páginas completas en el archivo
+    long siguiente;              // Próxima página a cargar
+    uint64_t desde;
+    bool cargada;
+    registro_cursor_t cursor;
+    uint8_t pagina[REGISTRO_PAGINA];
+} registro_lector_t;
+
+// Cabecera de la página 'i' del archivo (false si no se pudo leer o no es válida)
+static inline bool registro_cabecera_en(FILE *archivo, long i, registro_cabecera_t *c) {
+    uint8_t cabecera[REGISTRO_CABECERA];
+    if (fseek(archivo, i * REGISTRO_PAGINA, SEEK_SET) != 0) return false;
+    if (fread(cabecera, 1, sizeof(cabecera), archivo) != sizeof(cabecera)) return false;
+    return registro_leer_cabecera(cabecera, c);
+}
+
+// ----------------------------------------------------
+// Prepara la lectura desde 'desde_ms': busca por bisección la primera página
+// cuya última lectura no es anterior a 'desde_ms'. Devuelve las páginas del
+// archivo.
+// ----------------------------------------------------
+static inline long registro_lector_abrir(registro_lector_t *l, FILE *archivo, uint64_t desde_ms) {
+    l->archivo = archivo;
+    l->desde = desde_ms;
+    l->cargada = false;
+
+    fseek(archivo, 0, SEEK_END);
+    long largo = ftell(archivo);
+    l->paginas = largo > 0 ? largo / REGISTRO_PAGINA : 0;
+
+    long bajo = 0, alto = l->paginas;
+    while (bajo < alto) {
+        long medio = bajo + (alto - bajo) / 2;
+        registro_cabecera_t c;
+        // Una página dañada se salta hacia adelante
+        if (!registro_cabecera_en(archivo, medio, &c) || c.tfin < desde_ms) {
+            bajo = medio + 1;
+        } else {
+            alto = medio;
+        }
+    }
+    l->siguiente = bajo;
+    return l->paginas;
+}
+
+// ----------------------------------------------------
+// Siguiente lectura con tiempo >= 'desde_ms', en orden. Devuelve false al
+// terminar el archivo (quien lee corta cuando pasa el fin de su rango).
+// ----------------------------------------------------
+static inline bool registro_lector_siguiente(registro_lector_t *l, registro_muestra_t *m) {
+    for (;;) {
+        while (l->cargada && registro_cursor_siguiente(&l->cursor, m)) {
+            if (m->t >= l->desde) return true;
+        }
+
+        if (l->siguiente >= l->paginas) return false;
+        long i = l->siguiente++;
+        l->cargada = fseek(l->archivo, i * REGISTRO_PAGINA, SEEK_SET) == 0 &&
+                     fread(l->pagina, 1, REGISTRO_PAGINA, l->archivo) == REGISTRO_PAGINA &&
+                     registro_cursor_iniciar(&l->cursor, l->pagina);
+    }
+}
+
+// ----------------------------------------------------
+// Tiempo de la última lectura guardada en un archivo (false si no hay)
+// ----------------------------------------------------
+static inline bool registro_ultimo_tiempo(FILE *archivo, uint64_t *t) {
+    fseek(archivo, 0, SEEK_END);
+    long paginas = ftell(archivo) / REGISTRO_PAGINA;
+    registro_cabecera_t c;
+    for (long i = paginas - 1; i >= 0; i--) {
+        if (registro_cabecera_en(archivo, i, &c)) {
+            *t = c.tfin;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ----------------------------------------------------
+// Submuestreo: agrupa lecturas en intervalos de 'paso_ms' alineados a
+// múltiplos de 'paso_ms'. Los intervalos sin lecturas no se emiten.
+// ----------------------------------------------------
+typedef struct {
+    uint64_t inicio;             // Inicio del intervalo (ms)
+    uint32_t cuenta;
+    uint32_t suma;
+    uint8_t min;
+    uint8_t max;
+} registro_intervalo_t;
+
+typedef struct {
+    uint32_t paso_ms;
+    registro_intervalo_t actual;
+} registro_submuestreo_t;
+
+static inline void registro_submuestreo_init(registro_submuestreo_t *s, uint32_t paso_ms) {
+    memset(s, 0, sizeof(*s));
+    s->paso_ms = paso_ms ? paso_ms : 1;
+}
+
+// Devuelve true si la lectura cerró un intervalo (copiado en 'listo')
+static inline bool registro_submuestreo_agregar(registro_submuestreo_t *s, const registro_muestra_t *m,
+                                                registro_intervalo_t *listo) {
+    uint64_t inicio = m->t - m->t % s->paso_ms;
+    bool cerrado = false;
+
+    if (s->actual.cuenta > 0 && inicio != s->actual.inicio) {
+        *listo = s->actual;
+        s->actual.cuenta = 0;
+        cerrado = true;
+    }
+    if (s->actual.cuenta == 0) {
+        s->actual.inicio = inicio;
+        s->actual.suma = 0;
+        s->actual.min = m->valor;
+        s->actual.max = m->valor;
+    }
+    s->actual.cuenta++;
+    s->actual.suma += m->valor;
+    if (m->valor < s->actual.min) s->actual.min = m->valor;
+    if (m->valor > s->actual.max) s->actual.max = m->valor;
+    return cerrado;
+}
+
+// Entrega el último intervalo abierto (false si no hay)
+static inline bool registro_submuestreo_terminar(registro_submuestreo_t *s, registro_intervalo_t *listo) {
+    if (s->actual.cuenta == 0) return false;
+    *listo = s->actual;
+    s->actual.cuenta = 0;
+    return true;
+}
+
+#endif // REGISTRO_H
@@ -0,0 +1,52 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Candado de secuencia (seqlock) para publicar datos desde una sola tarea
+escritora sin bloquearla. El escritor nunca espera; el lector copia los
+datos y repite la copia si el escritor los modificó mientras tanto.*/
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+    volatile uint32_t secuencia;  // Impar mientras el escritor está modificando
+} seqlock_t;
+
+// ----------------------------------------------------
+// Lado escritor (una sola tarea)
+// ----------------------------------------------------
+static inline void seqlock_escribir_inicio(seqlock_t *s) {
+    uint32_t n = __atomic_load_n(&s->secuencia, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->secuencia, n + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void seqlock_escribir_fin(seqlock_t *s) {
+    uint32_t n = __atomic_load_n(&s->secuencia, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->secuencia, n + 1, __ATOMIC_RELEASE);
+}
+
+// ----------------------------------------------------
+// Lado lector: copia 'largo' bytes de 'origen' a 'destino' de forma
+// consistente. Reintenta mientras el escritor esté a mitad de una escritura.
+// ----------------------------------------------------
+static inline void seqlock_leer(const seqlock_t *s, void *destino, const void *origen, size_t largo) {
+    uint32_t antes, despues;
+    do {
+        do {
+            antes = __atomic_load_n(&s->secuencia, __ATOMIC_ACQUIRE);
+        } while (antes & 1);
+
+        memcpy(destino, origen, largo);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        despues = __atomic_load_n(&s->secuencia, __ATOMIC_RELAXED);
+    } while (antes != despues);
+}
+
+#endif // SEQLOCK_H
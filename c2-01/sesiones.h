@@ -0,0 +1,274 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Sesiones de autenticación táctil independientes. Cada estación tiene su
+propio par de pads (ingreso y validación), sus patrones y sus tiempos, y
+varias personas pueden usar estaciones distintas a la vez.
+
+Un solo despachador atiende todas las sesiones: recibe flancos (pad tocado
+o suelto y su momento) y, con una tabla de pad a sesión, actualiza solo la
+sesión dueña del pad. No hay una tarea por estación: sin flancos ni tiempos
+límite pendientes no se hace nada.
+
+El estado que cambia con cada toque (sesion_t, 20 bytes) está junto en un
+arreglo, separado de la configuración y de las tablas de patrones, que solo
+se leen: las 5 estaciones que permiten los 10 pads del ESP32 caben en dos
+líneas de caché de 64 bytes.
+
+Reglas de cada sesión (las del Ejercicio 3):
+- Un toque en el pad de ingreso que dura largo_min_ms o más es largo; si no,
+  corto. Cada toque avanza el motor de patrones (patrones.h); si ningún
+  patrón empieza así la sesión termina NO APROBADO en ese toque.
+- Cuando ningún patrón admite más toques se espera la validación; tocar de
+  nuevo el pad de ingreso es un error que solo se avisa.
+- Un toque en el pad de validación da el veredicto si lo ingresado es un
+  patrón completo (aunque uno más largo empiece igual).
+- Más de entre_toques_ms sin tocar, o más de validar_ms sin validar,
+  reinician la sesión.
+
+No imprime ni depende de ESP-IDF: quien lo usa recibe eventos (sesion_evento_t)
+y decide qué mostrar. También compila en el computador (bench/).*/
+
+#ifndef SESIONES_H
+#define SESIONES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "patrones.h"
+
+#ifndef SESIONES_PADS
+#define SESIONES_PADS 10           // Canales táctiles del ESP32
+#endif
+#define SESIONES_MAX (SESIONES_PADS / 2)
+#define SESIONES_SIN_PAD 0xFF
+
+// Rol de un pad dentro de su sesión (bit en sesion_t.tocados)
+#define SESION_INGRESO 0
+#define SESION_VALIDAR 1
+
+// ----------------------------------------------------
+// Configuración de una estación (constante; se lee solo al atender un evento)
+// ----------------------------------------------------
+typedef struct {
+    const char *nombre;
+    uint8_t pad_ingreso;
+    uint8_t pad_validar;
+    uint16_t largo_min_ms;         // Toques de esta duración o más son largos
+    uint16_t entre_toques_ms;      // Máximo entre toques antes de reiniciar
+    uint16_t validar_ms;           // Máximo para validar una secuencia completa
+    const patron_t *patrones;
+    uint8_t num_patrones;
+} sesion_config_t;
+
+typedef enum {
+    SESION_ESPERANDO = 0,          // Sin toques
+    SESION_INGRESANDO,             // Algún patrón admite más toques
+    SESION_VALIDACION,             // Secuencia completa: se espera el pad de validación
+} sesion_estado_t;
+
+// ----------------------------------------------------
+// Estado de una sesión: lo único que se escribe con cada flanco
+// ----------------------------------------------------
+typedef struct {
+    uint32_t candidatos;           // Patrones aún posibles (patrones_motor_t)
+    uint32_t ingresado;            // Bit i = toque i (1 largo, 0 corto)
+    uint32_t ultimo_ms;            // Fin del último toque registrado
+    uint32_t tocado_ms;            // Inicio del toque en curso en el pad de ingreso
+    uint8_t pos;                   // Toques ingresados (patrones_motor_t)
+    uint8_t estado;                // sesion_estado_t
+    uint8_t tocados;               // Pads tocados ahora (bit SESION_INGRESO / SESION_VALIDAR)
+} sesion_t;
+
+typedef struct {
+    sesion_t sesion[SESIONES_MAX];                 // Estado, junto
+    uint8_t pad_rol[SESIONES_PADS];                // Pad -> sesión << 1 | rol (SESIONES_SIN_PAD: libre)
+    uint8_t n;
+    const sesion_config_t *config[SESIONES_MAX];   // Solo lectura
+    patrones_tabla_t tabla[SESIONES_MAX];          // Patrones compilados de cada sesión
+} sesiones_t;
+
+typedef enum {
+    SESION_TOQUE = 0,              // Toque registrado, la secuencia sigue
+    SESION_COMPLETA,               // Toque registrado, se espera la validación
+    SESION_ERROR_VALIDAR,          // Tocó el pad de ingreso en vez del de validación
+    SESION_APROBADO,               // Veredictos: la sesión vuelve a empezar
+    SESION_NO_APROBADO,
+    SESION_RECHAZADO,              // NO APROBADO en el toque que no coincide con ningún patrón
+    SESION_VENCIDO_ENTRE,          // Pasó entre_toques_ms sin otro toque
+    SESION_VENCIDO_VALIDAR,        // Pasó validar_ms sin validar
+} sesion_evento_tipo_t;
+
+typedef struct {
+    uint8_t tipo;                  // sesion_evento_tipo_t
+    uint8_t sesion;
+    uint8_t toques;                // Toques ingresados (antes de reiniciar)
+    int8_t patron;                 // SESION_APROBADO: índice del patrón; si no, -1
+    uint32_t ingresado;            // Secuencia ingresada (antes de reiniciar)
+    uint32_t duracion_ms;          // SESION_TOQUE / SESION_COMPLETA: duración del toque
+} sesion_evento_t;
+
+// Los veredictos cierran la sesión (la persona ya tiene respuesta)
+static inline bool sesion_es_veredicto(uint8_t tipo) {
+    return tipo == SESION_APROBADO || tipo == SESION_NO_APROBADO || tipo == SESION_RECHAZADO;
+}
+
+static inline void sesiones_init(sesiones_t *s) {
+    memset(s, 0, sizeof(*s));
+    memset(s->pad_rol, SESIONES_SIN_PAD, sizeof(s->pad_rol));
+}
+
+static inline void sesion_reiniciar(sesiones_t *s, uint8_t id) {
+    sesion_t *e = &s->sesion[id];
+    e->candidatos = s->tabla[id].todos;
+    e->pos = 0;
+    e->ingresado = 0;
+    e->ultimo_ms = 0;
+    e->estado = SESION_ESPERANDO;
+}
+
+// ----------------------------------------------------
+// Agrega una estación. Devuelve su índice o -1 si no caben más, un pad ya
+// está en uso o los patrones no se pueden compilar.
+// ----------------------------------------------------
+static inline int sesiones_agregar(sesiones_t *s, const sesion_config_t *cfg) {
+    if (s->n >= SESIONES_MAX || cfg->pad_ingreso == cfg->pad_validar ||
+        cfg->pad_ingreso >= SESIONES_PADS || cfg->pad_validar >= SESIONES_PADS ||
+        s->pad_rol[cfg->pad_ingreso] != SESIONES_SIN_PAD || s->pad_rol[cfg->pad_validar] != SESIONES_SIN_PAD) {
+        return -1;
+    }
+    uint8_t id = s->n;
+    if (!patrones_compilar(&s->tabla[id], cfg->patrones, cfg->num_patrones)) return -1;
+
+    s->config[id] = cfg;
+    s->pad_rol[cfg->pad_ingreso] = (uint8_t)(id << 1 | SESION_INGRESO);
+    s->pad_rol[cfg->pad_validar] = (uint8_t)(id << 1 | SESION_VALIDAR);
+    memset(&s->sesion[id], 0, sizeof(sesion_t));
+    sesion_reiniciar(s, id);
+    s->n++;
+    return id;
+}
+
+// Reinicia todas las sesiones y olvida qué pads estaban tocados (p. ej. tras
+// recalibrar los pads, cuando los flancos pendientes ya no valen)
+static inline void sesiones_reiniciar_todas(sesiones_t *s) {
+    for (uint8_t id = 0; id < s->n; id++) {
+        s->sesion[id].tocados = 0;
+        sesion_reiniciar(s, id);
+    }
+}
+
+// Llena 'ev' con la secuencia de la sesión y, si el evento la cierra (veredicto
+// o tiempo vencido), la reinicia
+static inline void sesion_evento(sesiones_t *s, uint8_t id, uint8_t tipo, sesion_evento_t *ev) {
+    const sesion_t *e = &s->sesion[id];
+    ev->tipo = tipo;
+    ev->sesion = id;
+    ev->toques = e->pos;
+    ev->ingresado = e->ingresado;
+    ev->patron = -1;
+    ev->duracion_ms = 0;
+    if (tipo == SESION_APROBADO) {
+        patrones_motor_t m = {e->candidatos, e->pos};
+        ev->patron = (int8_t)patrones_primero(patrones_coincidencias(&m, &s->tabla[id]));
+    }
+    if (sesion_es_veredicto(tipo) || tipo == SESION_VENCIDO_ENTRE || tipo == SESION_VENCIDO_VALIDAR) {
+        sesion_reiniciar(s, id);
+    }
+}
+
+// ----------------------------------------------------
+// Atiende un flanco de 'pad' (tocado o suelto) en 't_ms'. Devuelve true y
+// llena 'ev' si el flanco produjo un evento.
+// ----------------------------------------------------
+static inline bool sesiones_flanco(sesiones_t *s, uint8_t pad, bool tocado, uint32_t t_ms,
+                                   sesion_evento_t *ev) {
+    if (pad >= SESIONES_PADS || s->pad_rol[pad] == SESIONES_SIN_PAD) return false;
+    uint8_t id = s->pad_rol[pad] >> 1;
+    uint8_t rol = s->pad_rol[pad] & 1;
+    sesion_t *e = &s->sesion[id];
+
+    uint8_t bit = (uint8_t)(1u << rol);
+    if (tocado == ((e->tocados & bit) != 0)) return false;   // Flanco repetido
+    e->tocados ^= bit;
+
+    if (rol == SESION_VALIDAR) {
+        // Solo el toque cuenta, y no mientras se mantiene el pad de ingreso
+        if (!tocado || (e->tocados & (1u << SESION_INGRESO))) return false;
+        patrones_motor_t m = {e->candidatos, e->pos};
+        bool completo = patrones_coincidencias(&m, &s->tabla[id]) != 0;
+        if (e->estado != SESION_VALIDACION && !completo) return false;
+        sesion_evento(s, id, completo ? SESION_APROBADO : SESION_NO_APROBADO, ev);
+        return true;
+    }
+
+    if (tocado) {
+        e->tocado_ms = t_ms;
+        if (e->estado != SESION_VALIDACION) return false;
+        sesion_evento(s, id, SESION_ERROR_VALIDAR, ev);
+        return true;
+    }
+
+    // Se soltó el pad de ingreso: registrar el toque
+    if (e->estado == SESION_VALIDACION) return false;
+    const sesion_config_t *cfg = s->config[id];
+    uint32_t duracion = t_ms - e->tocado_ms;
+    uint8_t simbolo = duracion >= cfg->largo_min_ms ? PATRONES_LARGO : PATRONES_CORTO;
+
+    patrones_motor_t m = {e->candidatos, e->pos};
+    patrones_resultado_t r = patrones_avanzar(&m, &s->tabla[id], simbolo);
+    e->ingresado |= (uint32_t)simbolo << e->pos;
+    e->candidatos = m.candidatos;
+    e->pos = m.pos;
+    e->ultimo_ms = t_ms;
+    e->estado = r == PATRONES_COMPLETO ? SESION_VALIDACION : SESION_INGRESANDO;
+
+    sesion_evento(s, id, r == PATRONES_RECHAZADO ? SESION_RECHAZADO
+                       : r == PATRONES_COMPLETO ? SESION_COMPLETA : SESION_TOQUE, ev);
+    ev->duracion_ms = duracion;
+    return true;
+}
+
+// Límite de tiempo de una sesión en curso (0 si no tiene)
+static inline uint32_t sesion_limite_ms(const sesiones_t *s, uint8_t id) {
+    const sesion_t *e = &s->sesion[id];
+    if (e->estado == SESION_VALIDACION) return s->config[id]->validar_ms;
+    if (e->estado == SESION_INGRESANDO) return s->config[id]->entre_toques_ms;
+    return 0;
+}
+
+// ----------------------------------------------------
+// Reinicia las sesiones cuyo tiempo límite venció en 't_ms'. Deja en
+// 'eventos' (espacio para SESIONES_MAX) un evento por sesión vencida y
+// devuelve cuántos.
+// ----------------------------------------------------
+static inline int sesiones_vencer(sesiones_t *s, uint32_t t_ms, sesion_evento_t *eventos) {
+    int n = 0;
+    for (uint8_t id = 0; id < s->n; id++) {
+        uint32_t limite = sesion_limite_ms(s, id);
+        if (limite == 0 || t_ms - s->sesion[id].ultimo_ms <= limite) continue;
+        uint8_t tipo = s->sesion[id].estado == SESION_VALIDACION ? SESION_VENCIDO_VALIDAR : SESION_VENCIDO_ENTRE;
+        sesion_evento(s, id, tipo, &eventos[n++]);
+    }
+    return n;
+}
+
+// ----------------------------------------------------
+// Milisegundos desde 't_ms' hasta el próximo tiempo límite de cualquier
+// sesión (0 si ya venció; UINT32_MAX si ninguna tiene uno pendiente)
+// ----------------------------------------------------
+static inline uint32_t sesiones_proximo_limite(const sesiones_t *s, uint32_t t_ms) {
+    uint32_t minimo = UINT32_MAX;
+    for (uint8_t id = 0; id < s->n; id++) {
+        uint32_t limite = sesion_limite_ms(s, id);
+        if (limite == 0) continue;
+        uint32_t transcurrido = t_ms - s->sesion[id].ultimo_ms;
+        uint32_t resta = transcurrido > limite ? 0 : limite - transcurrido + 1;  // +1: ya vencido
+        if (resta < minimo) minimo = resta;
+    }
+    return minimo;
+}
+
+#endif // SESIONES_H
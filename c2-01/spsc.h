@@ -0,0 +1,113 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Cola circular sin candados para un solo productor y un solo consumidor
+(SPSC) de lecturas de 8 bits. Ninguna de las dos operaciones espera: si la
+cola está llena el productor descarta la lectura y lo cuenta.
+
+El productor solo escribe 'cabeza' y sus contadores; el consumidor solo
+escribe 'cola'. Cada lado guarda una copia del índice del otro para no leer
+su línea de caché en cada operación.
+
+No depende de ESP-IDF, por lo que también compila en el computador (bench/).*/
+
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Capacidad de la cola (debe ser potencia de 2)
+#ifndef SPSC_CAPACIDAD
+#define SPSC_CAPACIDAD 256
+#endif
+
+#define SPSC_MASCARA (SPSC_CAPACIDAD - 1)
+#define SPSC_LINEA 64          // Separación entre los datos del productor y del consumidor
+
+#if (SPSC_CAPACIDAD & SPSC_MASCARA) != 0
+#error "SPSC_CAPACIDAD debe ser potencia de 2"
+#endif
+
+typedef struct {
+    // Lado productor
+    uint32_t cabeza __attribute__((aligned(SPSC_LINEA)));
+    uint32_t cola_vista;       // Última 'cola' leída por el productor
+    uint32_t empujados;        // Lecturas aceptadas
+    uint32_t descartados;      // Lecturas perdidas por cola llena
+
+    // Lado consumidor
+    uint32_t cola __attribute__((aligned(SPSC_LINEA)));
+    uint32_t cabeza_vista;     // Última 'cabeza' leída por el consumidor
+    uint32_t extraidos;        // Lecturas entregadas al consumidor
+    uint32_t max_ocupacion;    // Mayor ocupación vista por el consumidor
+
+    uint8_t datos[SPSC_CAPACIDAD] __attribute__((aligned(SPSC_LINEA)));
+} spsc_t;
+
+static inline void spsc_init(spsc_t *q) {
+    memset(q, 0, sizeof(*q));
+}
+
+// ----------------------------------------------------
+// Productor: agrega una lectura. Devuelve false (y cuenta el descarte) si la
+// cola está llena.
+// ----------------------------------------------------
+static inline bool spsc_push(spsc_t *q, uint8_t valor) {
+    uint32_t cabeza = q->cabeza;
+
+    if (cabeza - q->cola_vista >= SPSC_CAPACIDAD) {
+        q->cola_vista = __atomic_load_n(&q->cola, __ATOMIC_ACQUIRE);
+        if (cabeza - q->cola_vista >= SPSC_CAPACIDAD) {
+            __atomic_store_n(&q->descartados, q->descartados + 1, __ATOMIC_RELAXED);
+            return false;
+        }
+    }
+
+    q->datos[cabeza & SPSC_MASCARA] = valor;
+    __atomic_store_n(&q->cabeza, cabeza + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&q->empujados, q->empujados + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+// ----------------------------------------------------
+// Consumidor: extrae hasta 'max' lecturas en 'destino'. Devuelve cuántas.
+// ----------------------------------------------------
+static inline size_t spsc_pop_lote(spsc_t *q, uint8_t *destino, size_t max) {
+    uint32_t cola = q->cola;
+
+    if (q->cabeza_vista == cola) {
+        q->cabeza_vista = __atomic_load_n(&q->cabeza, __ATOMIC_ACQUIRE);
+        if (q->cabeza_vista == cola) return 0;
+    }
+
+    size_t n = q->cabeza_vista - cola;
+    if (n > q->max_ocupacion) {
+        __atomic_store_n(&q->max_ocupacion, (uint32_t)n, __ATOMIC_RELAXED);
+    }
+    if (n > max) n = max;
+
+    // Copia en a lo sumo dos tramos (antes y después del final del arreglo)
+    uint32_t pos = cola & SPSC_MASCARA;
+    size_t primera = SPSC_CAPACIDAD - pos;
+    if (primera > n) primera = n;
+    memcpy(destino, &q->datos[pos], primera);
+    memcpy(destino + primera, &q->datos[0], n - primera);
+
+    __atomic_store_n(&q->cola, cola + (uint32_t)n, __ATOMIC_RELEASE);
+    __atomic_store_n(&q->extraidos, q->extraidos + (uint32_t)n, __ATOMIC_RELAXED);
+    return n;
+}
+
+// ----------------------------------------------------
+// Lecturas pendientes (aproximado si se llama desde un tercer hilo)
+// ----------------------------------------------------
+static inline uint32_t spsc_ocupacion(const spsc_t *q) {
+    return __atomic_load_n(&q->cabeza, __ATOMIC_ACQUIRE) - __atomic_load_n(&q->cola, __ATOMIC_ACQUIRE);
+}
+
+#endif // SPSC_H
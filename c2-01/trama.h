@@ -0,0 +1,348 @@
+/*Integrantes:
+  Cely Juliana
+  Jiménez Juliana
+  Mora Zharick
+
+Protocolo binario por tramas, alternativa al texto terminado en '\n'.
+
+Formato de una trama en el cable:
+  COBS(tipo | datos | crc16) 0x00
+- tipo: qué llevan los datos (TRAMA_LECTURAS, TRAMA_PEDIDOS, ...).
+- datos: de 0 a TRAMA_MAX_DATOS bytes; una trama puede llevar muchas lecturas
+  o pedidos.
+- crc16: CRC-16/CCITT-FALSE (polinomio 0x1021, inicio 0xFFFF) de tipo y
+  datos, en big endian: así el CRC de la trama completa (con su CRC) da 0.
+- COBS quita todos los 0x00 del contenido (con 1 byte extra cada 254), así
+  que 0x00 solo aparece como separador: una trama dañada o cortada se pierde
+  sola y el receptor se vuelve a sincronizar en el siguiente 0x00. Quien
+  transmite puede empezar con un 0x00 para cerrar basura anterior.
+
+El receptor decodifica COBS y calcula el CRC a medida que llegan los bytes
+(una sola pasada, sin copiar la trama codificada); al llegar el separador
+solo compara y entrega un puntero a los datos. Las tramas dañadas no se
+entregan: se cuentan por causa (COBS, CRC, largo).
+
+No usa funciones de cadenas. No depende de ESP-IDF, por lo que también
+compila en el computador (bench/).*/
+
+#ifndef TRAMA_H
+#define TRAMA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Máximo de datos por trama (sin tipo ni CRC)
+#ifndef TRAMA_MAX_DATOS
+#define TRAMA_MAX_DATOS 256
+#endif
+
+// Bytes en el cable de una trama con 'n' datos: tipo + CRC, un byte de COBS
+// cada 254 (más el inicial) y el separador
+#define TRAMA_CODIFICADA_MAX(n) ((n) + 3 + ((n) + 3) / 254 + 1 + 1)
+
+// Bytes en el cable de 'n' datos repartidos en tramas de TRAMA_MAX_DATOS
+// (trama_codificar_varias)
+#define TRAMA_VARIAS_MAX(n) (((n) / TRAMA_MAX_DATOS + 1) * TRAMA_CODIFICADA_MAX(TRAMA_MAX_DATOS))
+
+#define TRAMA_SEPARADOR 0x00
+
+// ----------------------
+// Tipos de trama
+// ----------------------
+typedef enum {
+    TRAMA_LECTURAS = 0x01,     // Un byte por lectura del caudalímetro (00-99)
+    TRAMA_PEDIDOS = 0x02,      // Enteros de 32 bits (little endian) a elevar al cuadrado
+    TRAMA_CUADRADOS = 0x03,    // Cuadrados de 64 bits (little endian), en el orden de los pedidos
+    TRAMA_COMANDO = 0x04,      // Texto de un comando ("?", "!baud=...")
+    TRAMA_TEXTO = 0x05,        // Respuesta en texto a un comando
+} trama_tipo_t;
+
+// ----------------------------------------------------
+// CRC-16/CCITT-FALSE por tabla (512 bytes en flash, un acceso por byte)
+// ----------------------------------------------------
+static const uint16_t trama_crc_tabla[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+static inline uint16_t trama_crc_byte(uint16_t crc, uint8_t b) {
+    return (uint16_t)((crc << 8) ^ trama_crc_tabla[(crc >> 8) ^ b]);
+}
+
+static inline uint16_t trama_crc(const uint8_t *datos, size_t n) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < n; i++) crc = trama_crc_byte(crc, datos[i]);
+    return crc;
+}
+
+// ====================================================
+// Transmisión: codifica mientras se escriben los datos, sin buffer intermedio
+// ====================================================
+typedef struct {
+    uint8_t *destino;          // Debe tener TRAMA_CODIFICADA_MAX(datos) bytes
+    size_t n;                  // Bytes escritos en 'destino'
+    size_t pos_codigo;         // Byte de código COBS del bloque en curso
+    uint8_t codigo;            // Distancia hasta el próximo cero (bloque en curso)
+    uint16_t crc;
+} trama_tx_t;
+
+static inline void trama_tx_cobs(trama_tx_t *tx, uint8_t b) {
+    if (b == 0) {
+        tx->destino[tx->pos_codigo] = tx->codigo;
+        tx->pos_codigo = tx->n++;
+        tx->codigo = 1;
+        return;
+    }
+    tx->destino[tx->n++] = b;
+    if (++tx->codigo == 0xFF) {
+        // Bloque de 254 bytes sin ceros: se cierra sin cero implícito
+        tx->destino[tx->pos_codigo] = tx->codigo;
+        tx->pos_codigo = tx->n++;
+        tx->codigo = 1;
+    }
+}
+
+// ----------------------------------------------------
+// Agrega un byte de datos a la trama
+// ----------------------------------------------------
+static inline void trama_tx_byte(trama_tx_t *tx, uint8_t b) {
+    tx->crc = trama_crc_byte(tx->crc, b);
+    trama_tx_cobs(tx, b);
+}
+
+static inline void trama_tx_u32(trama_tx_t *tx, uint32_t v) {
+    for (int i = 0; i < 4; i++) trama_tx_byte(tx, (uint8_t)(v >> (8 * i)));
+}
+
+static inline void trama_tx_u64(trama_tx_t *tx, uint64_t v) {
+    for (int i = 0; i < 8; i++) trama_tx_byte(tx, (uint8_t)(v >> (8 * i)));
+}
+
+// ----------------------------------------------------
+// Empieza una trama de tipo 'tipo' en 'destino'
+// ----------------------------------------------------
+static inline void trama_tx_iniciar(trama_tx_t *tx, uint8_t *destino, uint8_t tipo) {
+    tx->destino = destino;
+    tx->pos_codigo = 0;
+    tx->n = 1;
+    tx->codigo = 1;
+    tx->crc = 0xFFFF;
+    trama_tx_byte(tx, tipo);
+}
+
+// ----------------------------------------------------
+// Agrega el CRC y el separador. Devuelve el largo total de la trama.
+// ----------------------------------------------------
+static inline size_t trama_tx_terminar(trama_tx_t *tx) {
+    uint16_t crc = tx->crc;
+    trama_tx_cobs(tx, (uint8_t)(crc >> 8));
+    trama_tx_cobs(tx, (uint8_t)crc);
+    tx->destino[tx->pos_codigo] = tx->codigo;
+    tx->destino[tx->n++] = TRAMA_SEPARADOR;
+    return tx->n;
+}
+
+// ----------------------------------------------------
+// Codifica una trama completa. 'n' no pasa de TRAMA_MAX_DATOS (el receptor
+// descarta una trama más larga) y 'destino' debe tener
+// TRAMA_CODIFICADA_MAX(n) bytes. Devuelve el largo escrito.
+// ----------------------------------------------------
+static inline size_t trama_codificar(uint8_t tipo, const uint8_t *datos, size_t n, uint8_t *destino) {
+    trama_tx_t tx;
+    trama_tx_iniciar(&tx, destino, tipo);
+    for (size_t i = 0; i < n; i++) trama_tx_byte(&tx, datos[i]);
+    return trama_tx_terminar(&tx);
+}
+
+// ----------------------------------------------------
+// Codifica 'n' datos de cualquier largo (p. ej. la respuesta en texto a un
+// comando) en tramas seguidas de hasta TRAMA_MAX_DATOS, todas de tipo
+// 'tipo'. 'destino' debe tener TRAMA_VARIAS_MAX(n) bytes. Devuelve el largo
+// escrito.
+// ----------------------------------------------------
+static inline size_t trama_codificar_varias(uint8_t tipo, const uint8_t *datos, size_t n, uint8_t *destino) {
+    size_t escritos = 0;
+    do {
+        size_t k = n < TRAMA_MAX_DATOS ? n : TRAMA_MAX_DATOS;
+        escritos += trama_codificar(tipo, datos, k, destino + escritos);
+        datos += k;
+        n -= k;
+    } while (n > 0);
+    return escritos;
+}
+
+// ====================================================
+// Recepción
+// ====================================================
+#define TRAMA_RX_MAX (TRAMA_MAX_DATOS + 3)   // Tipo, datos y CRC ya decodificados
+
+typedef struct {
+    uint8_t buf[TRAMA_RX_MAX]; // Trama en curso, decodificada
+    uint16_t largo;
+    uint16_t crc;              // CRC de lo decodificado hasta ahora
+    uint8_t resto;             // Bytes que faltan del bloque COBS en curso (0: sigue un código)
+    uint8_t codigo;            // Código del bloque anterior (0: todavía ninguno)
+    bool desbordada;           // La trama en curso superó TRAMA_RX_MAX: se descarta
+
+    // Contadores (un solo escritor: el receptor)
+    uint32_t bytes;            // Bytes recibidos
+    uint32_t tramas;           // Tramas válidas entregadas
+    uint32_t err_cobs;         // Codificación inválida (trama cortada o bytes perdidos)
+    uint32_t err_crc;          // CRC distinto
+    uint32_t err_largo;        // Más larga que TRAMA_MAX_DATOS o sin tipo y CRC
+    uint32_t err_tipo;         // Tipo o datos que quien consume no reconoce
+} trama_rx_t;
+
+static inline void trama_rx_reiniciar(trama_rx_t *rx) {
+    rx->largo = 0;
+    rx->crc = 0xFFFF;
+    rx->resto = 0;
+    rx->codigo = 0;
+    rx->desbordada = false;
+}
+
+static inline void trama_rx_init(trama_rx_t *rx) {
+    memset(rx, 0, sizeof(*rx));
+    trama_rx_reiniciar(rx);
+}
+
+static inline void trama_rx_contar(uint32_t *contador) {
+    __atomic_store_n(contador, *contador + 1, __ATOMIC_RELAXED);
+}
+
+static inline void trama_rx_guardar(trama_rx_t *rx, uint8_t b) {
+    if (rx->largo < TRAMA_RX_MAX) {
+        rx->buf[rx->largo++] = b;
+        rx->crc = trama_crc_byte(rx->crc, b);
+    } else {
+        rx->desbordada = true;
+    }
+}
+
+// ----------------------------------------------------
+// Cierra la trama en curso al llegar el separador. Devuelve el largo de tipo
+// + datos si es válida, o -1 (ya contada como error).
+// ----------------------------------------------------
+static inline int trama_rx_cerrar(trama_rx_t *rx) {
+    uint16_t largo = rx->largo;
+    uint16_t crc = rx->crc;
+    bool desbordada = rx->desbordada;
+    bool cortada = rx->resto != 0;
+    trama_rx_reiniciar(rx);
+
+    if (desbordada) {
+        trama_rx_contar(&rx->err_largo);
+        return -1;
+    }
+    if (cortada) {
+        trama_rx_contar(&rx->err_cobs);
+        return -1;
+    }
+    if (largo < 3) {
+        trama_rx_contar(&rx->err_largo);
+        return -1;
+    }
+    if (crc != 0) {
+        trama_rx_contar(&rx->err_crc);
+        return -1;
+    }
+    trama_rx_contar(&rx->tramas);
+    return largo - 2;
+}
+
+// ----------------------------------------------------
+// Consume bytes de '*datos' (avanzando '*datos' y '*n') hasta completar la
+// siguiente trama válida. Devuelve un puntero a sus datos (válido hasta la
+// próxima llamada) con su tipo y largo, o NULL si se acabaron los bytes; la
+// trama en curso continúa con el próximo bloque. Los separadores seguidos
+// (tramas vacías) se ignoran.
+// ----------------------------------------------------
+static inline const uint8_t *trama_rx_siguiente(trama_rx_t *rx, const uint8_t **datos, size_t *n,
+                                                uint8_t *tipo, size_t *largo) {
+    const uint8_t *p = *datos;
+    const uint8_t *fin = p + *n;
+
+    while (p < fin) {
+        uint8_t b = *p++;
+        rx->bytes++;
+
+        if (b != TRAMA_SEPARADOR) {
+            if (rx->resto > 0) {
+                trama_rx_guardar(rx, b);
+                rx->resto--;
+                continue;
+            }
+            // Código COBS: el bloque anterior terminaba en un cero (salvo 0xFF)
+            if (rx->codigo != 0 && rx->codigo < 0xFF) trama_rx_guardar(rx, 0);
+            rx->codigo = b;
+            rx->resto = (uint8_t)(b - 1);
+            continue;
+        }
+
+        if (rx->codigo == 0) continue;      // Separadores seguidos: nada que cerrar
+        int m = trama_rx_cerrar(rx);
+        if (m < 0) continue;
+
+        *datos = p;
+        *n = (size_t)(fin - p);
+        *tipo = rx->buf[0];
+        *largo = (size_t)m - 1;
+        return &rx->buf[1];
+    }
+
+    *datos = p;
+    *n = 0;
+    return NULL;
+}
+
+// ----------------------------------------------------
+// Descarta la trama en curso (p. ej. tras vaciar la entrada por un desborde)
+// ----------------------------------------------------
+static inline void trama_rx_descartar(trama_rx_t *rx) {
+    if (rx->codigo != 0) trama_rx_contar(&rx->err_largo);
+    trama_rx_reiniciar(rx);
+}
+
+// ----------------------------------------------------
+// Total de tramas descartadas (para los reportes, desde cualquier tarea)
+// ----------------------------------------------------
+static inline uint32_t trama_rx_errores(const trama_rx_t *rx) {
+    return __atomic_load_n(&rx->err_cobs, __ATOMIC_RELAXED) +
+           __atomic_load_n(&rx->err_crc, __ATOMIC_RELAXED) +
+           __atomic_load_n(&rx->err_largo, __ATOMIC_RELAXED) +
+           __atomic_load_n(&rx->err_tipo, __ATOMIC_RELAXED);
+}
+
+#endif // TRAMA_H